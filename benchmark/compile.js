@@ -0,0 +1,30 @@
+#!/usr/bin/env node
+'use strict';
+const benchmark = require('nodemark');
+const Database = require('../.');
+
+/*
+	Compares the per-call overhead of stmt.get() and stmt.run() with compiled
+	statements (stmt.compile()), using statements that do almost no work of
+	their own.
+ */
+
+const db = new Database(':memory:');
+db.exec('CREATE TABLE entries (x INTEGER); INSERT INTO entries VALUES (1)');
+const select = db.prepare('SELECT 1').pluck();
+const update = db.prepare('UPDATE entries SET x = 1');
+const get = select.compile();
+const run = update.compile();
+
+const trials = [
+	['stmt.get()', () => select.get()],
+	['compiled get', () => get()],
+	['stmt.run()', () => update.run()],
+	['compiled run', () => run()],
+];
+
+const nameLength = trials.reduce((m, [name]) => Math.max(m, name.length), 0);
+for (const [name, fn] of trials) {
+	console.log(`${name.padEnd(nameLength)} x ${String(benchmark(fn)).replace(/ \(.*/, '')}`);
+}
+db.close();
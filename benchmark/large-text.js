@@ -0,0 +1,34 @@
+#!/usr/bin/env node
+'use strict';
+const benchmark = require('nodemark');
+const Database = require('../.');
+
+/*
+	Reads the same rows as the large_text trials (32 KiB of ASCII text each),
+	and rows of the same size that contain a non-ASCII character. ASCII text is
+	copied directly into one-byte strings, while other text must be decoded as
+	UTF-8, so the difference between the two shows what the fast path saves.
+ */
+
+const db = new Database(':memory:');
+db.exec('CREATE TABLE large_text (ascii TEXT, other TEXT)');
+db.prepare('INSERT INTO large_text VALUES (?, ?)').run('this is the text'.repeat(2048), 'this is the tëxt'.repeat(2048));
+for (let i = 0; i < 6; ++i) db.exec('INSERT INTO large_text SELECT * FROM large_text');
+
+const ascii = db.prepare('SELECT ascii FROM large_text WHERE rowid = 1').pluck();
+const other = db.prepare('SELECT other FROM large_text WHERE rowid = 1').pluck();
+const allAscii = db.prepare('SELECT ascii FROM large_text').pluck();
+const allOther = db.prepare('SELECT other FROM large_text').pluck();
+
+const trials = [
+	['ASCII text', () => ascii.get()],
+	['non-ASCII text', () => other.get()],
+	['ASCII text (64 rows)', () => allAscii.all()],
+	['non-ASCII text (64 rows)', () => allOther.all()],
+];
+
+const nameLength = trials.reduce((m, [name]) => Math.max(m, name.length), 0);
+for (const [name, fn] of trials) {
+	console.log(`${name.padEnd(nameLength)} x ${String(benchmark(fn)).replace(/ \(.*/, '')}`);
+}
+db.close();
@@ -0,0 +1,8 @@
+{
+  'targets': [
+    {
+      'target_name': 'materialize',
+      'sources': ['materialize.c'],
+    },
+  ],
+}
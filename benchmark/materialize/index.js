@@ -0,0 +1,48 @@
+#!/usr/bin/env node
+'use strict';
+const addon = require('./build/Release/materialize.node');
+
+/*
+	Measures how long it takes to build rows (and arrays of rows) by calling
+	JavaScript factories, compared to building them through Node-API. Build it
+	first with "npx node-gyp rebuild -C benchmark/materialize".
+ */
+
+// These are the same factories that lib/database.js gives to the addon.
+const keys = ['real', 'integer', 'text', 'nul'];
+const rowFactory = Function(`return (v0, v1, v2, v3) => ({${keys.map((key, i) => `${key}: v${i}`).join(', ')}})`)();
+const arrayFactory = (...values) => values;
+const arrayAppender = (array, ...values) => {
+	const offset = array.length;
+	for (let i = 0; i < values.length; ++i) {
+		array[offset + i] = values[i];
+	}
+};
+
+const measure = (name, fn, count) => {
+	for (let i = 0; i < 5; ++i) fn();
+	const repetitions = 20;
+	const start = process.hrtime.bigint();
+	for (let i = 0; i < repetitions; ++i) fn();
+	const nanoseconds = Number(process.hrtime.bigint() - start) / repetitions / count;
+	console.log(`${name.padEnd(36)} ${nanoseconds.toFixed(1)} ns`);
+};
+
+console.log(`Node.js ${process.version}, ${keys.length} columns (time per row)`);
+const rows = 100000;
+measure('object rows: JS factory', () => addon.rowsFromFactory(rowFactory, rows), rows);
+measure('object rows: napi_define_properties', () => addon.objectsFromDescriptors(keys, rows), rows);
+measure('object rows: napi_set_property', () => addon.objectsFromSetters(keys, rows), rows);
+measure('raw rows: JS factory', () => addon.rowsFromFactory(arrayFactory, rows), rows);
+measure('raw rows: napi_set_element', () => addon.arraysFromElements(rows), rows);
+
+console.log('\nArrays of rows (time per array)');
+for (const length of [1, 10, 100, 10000]) {
+	const count = Math.ceil(100000 / length);
+	measure(`${length} rows: JS factory/appender`, () => {
+		for (let i = 0; i < count; ++i) addon.listFromFactory(arrayFactory, arrayAppender, length);
+	}, count);
+	measure(`${length} rows: napi_set_element`, () => {
+		for (let i = 0; i < count; ++i) addon.listFromElements(length);
+	}, count);
+}
@@ -0,0 +1,155 @@
+/*
+	Compares the ways that the addon could build rows and arrays of rows: by
+	calling factory functions in JavaScript (what better-sqlite3 does), or by
+	building them natively through Node-API. Each function builds the given
+	number of rows from the same four values, so only the building differs.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <node_api.h>
+
+#define COLUMNS 4
+#define BATCH_SIZE 1024
+
+static void get_args(napi_env env, napi_callback_info info, napi_value* args, size_t count) {
+	napi_get_cb_info(env, info, &count, args, NULL, NULL);
+}
+
+static void get_values(napi_env env, napi_value* values) {
+	napi_create_double(env, 1.5, &values[0]);
+	napi_create_int32(env, 42, &values[1]);
+	napi_create_string_utf8(env, "hello", 5, &values[2]);
+	napi_get_null(env, &values[3]);
+}
+
+// rowsFromFactory(factory, count): calls the factory with each row's values.
+static napi_value rows_from_factory(napi_env env, napi_callback_info info) {
+	napi_value args[2], values[COLUMNS], undefined, row;
+	uint32_t count;
+	get_args(env, info, args, 2);
+	napi_get_value_uint32(env, args[1], &count);
+	napi_get_undefined(env, &undefined);
+	for (uint32_t i = 0; i < count; ++i) {
+		napi_handle_scope scope;
+		napi_open_handle_scope(env, &scope);
+		get_values(env, values);
+		napi_call_function(env, undefined, args[0], COLUMNS, values, &row);
+		napi_close_handle_scope(env, scope);
+	}
+	return undefined;
+}
+
+// objectsFromDescriptors(keys, count): napi_define_properties on a new object.
+static napi_value objects_from_descriptors(napi_env env, napi_callback_info info) {
+	napi_value args[2], keys[COLUMNS], values[COLUMNS], undefined, row;
+	napi_property_descriptor descriptors[COLUMNS];
+	uint32_t count;
+	get_args(env, info, args, 2);
+	napi_get_value_uint32(env, args[1], &count);
+	napi_get_undefined(env, &undefined);
+	for (int i = 0; i < COLUMNS; ++i) napi_get_element(env, args[0], i, &keys[i]);
+	for (uint32_t i = 0; i < count; ++i) {
+		napi_handle_scope scope;
+		napi_open_handle_scope(env, &scope);
+		get_values(env, values);
+		memset(descriptors, 0, sizeof(descriptors));
+		for (int j = 0; j < COLUMNS; ++j) {
+			descriptors[j].name = keys[j];
+			descriptors[j].value = values[j];
+			descriptors[j].attributes = napi_writable | napi_enumerable | napi_configurable;
+		}
+		napi_create_object(env, &row);
+		napi_define_properties(env, row, COLUMNS, descriptors);
+		napi_close_handle_scope(env, scope);
+	}
+	return undefined;
+}
+
+// objectsFromSetters(keys, count): napi_set_property on a new object.
+static napi_value objects_from_setters(napi_env env, napi_callback_info info) {
+	napi_value args[2], keys[COLUMNS], values[COLUMNS], undefined, row;
+	uint32_t count;
+	get_args(env, info, args, 2);
+	napi_get_value_uint32(env, args[1], &count);
+	napi_get_undefined(env, &undefined);
+	for (int i = 0; i < COLUMNS; ++i) napi_get_element(env, args[0], i, &keys[i]);
+	for (uint32_t i = 0; i < count; ++i) {
+		napi_handle_scope scope;
+		napi_open_handle_scope(env, &scope);
+		get_values(env, values);
+		napi_create_object(env, &row);
+		for (int j = 0; j < COLUMNS; ++j) napi_set_property(env, row, keys[j], values[j]);
+		napi_close_handle_scope(env, scope);
+	}
+	return undefined;
+}
+
+// arraysFromElements(count): napi_set_element on a new array.
+static napi_value arrays_from_elements(napi_env env, napi_callback_info info) {
+	napi_value args[1], values[COLUMNS], undefined, row;
+	uint32_t count;
+	get_args(env, info, args, 1);
+	napi_get_value_uint32(env, args[0], &count);
+	napi_get_undefined(env, &undefined);
+	for (uint32_t i = 0; i < count; ++i) {
+		napi_handle_scope scope;
+		napi_open_handle_scope(env, &scope);
+		get_values(env, values);
+		napi_create_array_with_length(env, COLUMNS, &row);
+		for (int j = 0; j < COLUMNS; ++j) napi_set_element(env, row, j, values[j]);
+		napi_close_handle_scope(env, scope);
+	}
+	return undefined;
+}
+
+// listFromFactory(arrayFactory, arrayAppender, length): builds one array the
+// way Statement#all() does, in batches of BATCH_SIZE elements.
+static napi_value list_from_factory(napi_env env, napi_callback_info info) {
+	napi_value args[3], undefined, result;
+	napi_value batch[BATCH_SIZE + 1];
+	uint32_t length;
+	get_args(env, info, args, 3);
+	napi_get_value_uint32(env, args[2], &length);
+	napi_get_undefined(env, &undefined);
+	napi_value* elements = malloc(sizeof(napi_value) * (length + 1));
+	for (uint32_t i = 0; i < length; ++i) napi_create_uint32(env, i, &elements[i]);
+	size_t first = length < BATCH_SIZE ? length : BATCH_SIZE;
+	napi_call_function(env, undefined, args[0], first, elements, &result);
+	batch[0] = result;
+	for (size_t offset = first; offset < length; offset += BATCH_SIZE) {
+		size_t count = length - offset < BATCH_SIZE ? length - offset : BATCH_SIZE;
+		memcpy(batch + 1, elements + offset, count * sizeof(napi_value));
+		napi_call_function(env, undefined, args[1], count + 1, batch, NULL);
+	}
+	free(elements);
+	return result;
+}
+
+// listFromElements(length): builds one array with napi_set_element.
+static napi_value list_from_elements(napi_env env, napi_callback_info info) {
+	napi_value args[1], element, result;
+	uint32_t length;
+	get_args(env, info, args, 1);
+	napi_get_value_uint32(env, args[0], &length);
+	napi_create_array_with_length(env, length, &result);
+	for (uint32_t i = 0; i < length; ++i) {
+		napi_create_uint32(env, i, &element);
+		napi_set_element(env, result, i, element);
+	}
+	return result;
+}
+
+static napi_value init(napi_env env, napi_value exports) {
+	napi_property_descriptor methods[] = {
+		{ "rowsFromFactory", NULL, rows_from_factory, NULL, NULL, NULL, napi_default, NULL },
+		{ "objectsFromDescriptors", NULL, objects_from_descriptors, NULL, NULL, NULL, napi_default, NULL },
+		{ "objectsFromSetters", NULL, objects_from_setters, NULL, NULL, NULL, napi_default, NULL },
+		{ "arraysFromElements", NULL, arrays_from_elements, NULL, NULL, NULL, napi_default, NULL },
+		{ "listFromFactory", NULL, list_from_factory, NULL, NULL, NULL, napi_default, NULL },
+		{ "listFromElements", NULL, list_from_elements, NULL, NULL, NULL, napi_default, NULL },
+	};
+	napi_define_properties(env, exports, sizeof(methods) / sizeof(methods[0]), methods);
+	return exports;
+}
+
+NAPI_MODULE(NODE_GYP_MODULE_NAME, init)
@@ -0,0 +1,39 @@
+#!/usr/bin/env node
+'use strict';
+const benchmark = require('nodemark');
+const Database = require('../.');
+
+/*
+	Compares uncached and cached (stmt.cache()) statements, for a primary key
+	lookup that does almost no work of its own, and for an aggregate query that
+	scans a table. Each cached call still runs PRAGMA data_version, so the cache
+	pays off when the query costs more than that, and when the data changes
+	less often than it's read.
+ */
+
+const db = new Database(':memory:');
+db.exec('CREATE TABLE entries (id INTEGER PRIMARY KEY, name TEXT, score REAL)');
+db.prepare('INSERT INTO entries (name, score) WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < 10000) SELECT hex(randomblob(8)), random() % 1000 FROM n').run();
+
+const LOOKUP = 'SELECT name FROM entries WHERE id = ?';
+const AGGREGATE = 'SELECT count(*), avg(score) FROM entries WHERE score > ?';
+const lookup = db.prepare(LOOKUP).pluck();
+const cachedLookup = db.prepare(LOOKUP).pluck().cache();
+const aggregate = db.prepare(AGGREGATE).raw();
+const cachedAggregate = db.prepare(AGGREGATE).raw().cache();
+const write = db.prepare('UPDATE entries SET score = score WHERE id = 1');
+
+const trials = [
+	['lookup', () => lookup.get(42)],
+	['lookup (cached)', () => cachedLookup.get(42)],
+	['aggregate', () => aggregate.get(500)],
+	['aggregate (cached)', () => cachedAggregate.get(500)],
+	['aggregate (cached, after a write)', () => { write.run(); cachedAggregate.get(500); }],
+	['aggregate (after a write)', () => { write.run(); aggregate.get(500); }],
+];
+
+const nameLength = trials.reduce((m, [name]) => Math.max(m, name.length), 0);
+for (const [name, fn] of trials) {
+	console.log(`${name.padEnd(nameLength)} x ${String(benchmark(fn)).replace(/ \(.*/, '')}`);
+}
+db.close();
@@ -36,6 +36,7 @@ SQLITE_DEFAULT_FOREIGN_KEYS=1
 SQLITE_DEFAULT_MEMSTATUS=0
 SQLITE_DEFAULT_WAL_SYNCHRONOUS=1
 SQLITE_DQS=0
+SQLITE_ENABLE_CARRAY
 SQLITE_ENABLE_COLUMN_METADATA
 SQLITE_ENABLE_DBSTAT_VTAB
 SQLITE_ENABLE_DESERIALIZE
@@ -47,12 +48,13 @@ SQLITE_ENABLE_GEOPOLY
 SQLITE_ENABLE_JSON1
 SQLITE_ENABLE_MATH_FUNCTIONS
 SQLITE_ENABLE_PERCENTILE
+SQLITE_ENABLE_PREUPDATE_HOOK
 SQLITE_ENABLE_RTREE
+SQLITE_ENABLE_SESSION
 SQLITE_ENABLE_STAT4
 SQLITE_ENABLE_UPDATE_DELETE_LIMIT
 SQLITE_LIKE_DOESNT_MATCH_BLOBS
 SQLITE_OMIT_DEPRECATED
-SQLITE_OMIT_PROGRESS_CALLBACK
 SQLITE_OMIT_SHARED_CACHE
 SQLITE_OMIT_TCL_VARIABLE
 SQLITE_SOUNDEX
@@ -51,6 +51,8 @@
       'include_dirs': ['<(SHARED_INTERMEDIATE_DIR)/sqlite3/'],
       'direct_dependent_settings': {
         'include_dirs': ['<(SHARED_INTERMEDIATE_DIR)/sqlite3/'],
+        # The session extension is only declared by sqlite3.h when these are defined.
+        'defines': ['SQLITE_ENABLE_PREUPDATE_HOOK', 'SQLITE_ENABLE_SESSION'],
       },
       'cflags': ['-std=c99', '-w'],
       'xcode_settings': {
@@ -62,8 +64,11 @@
           'includes': ['defines.gypi'],
         }, {
           'defines': [
-            # This is currently required by better-sqlite3.
+            # These are currently required by better-sqlite3.
+            'SQLITE_ENABLE_CARRAY',
             'SQLITE_ENABLE_COLUMN_METADATA',
+            'SQLITE_ENABLE_PREUPDATE_HOOK',
+            'SQLITE_ENABLE_SESSION',
           ],
         }]
       ],
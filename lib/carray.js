@@ -0,0 +1,20 @@
+'use strict';
+
+// Wraps a list of values that should be bound to the first argument of
+// SQLite's carray() table-valued function (see Database.carray()). Arrays and
+// typed arrays are otherwise bound the usual way, so binding them for carray()
+// must be requested explicitly.
+class CArray {
+	constructor(value) {
+		if (!Array.isArray(value) && !isBindableTypedArray(value)) {
+			throw new TypeError('Expected first argument to be an array, Int32Array, BigInt64Array, or Float64Array');
+		}
+		this.value = value;
+		Object.freeze(this);
+	}
+}
+
+const isBindableTypedArray = value =>
+	value instanceof Int32Array || value instanceof BigInt64Array || value instanceof Float64Array;
+
+module.exports = CArray;
@@ -3,6 +3,8 @@ const fs = require('fs');
 const path = require('path');
 const util = require('./util');
 const SqliteError = require('./sqlite-error');
+const CArray = require('./carray');
+const exportTo = require('./methods/export-to');
 
 module.exports = function createDatabase(getAddon, allowNativeBinding) {
 	function Database(filenameGiven, options) {
@@ -33,29 +35,34 @@ module.exports = function createDatabase(getAddon, allowNativeBinding) {
 		const timeout = 'timeout' in options ? options.timeout : 5000;
 		const verbose = 'verbose' in options ? options.verbose : null;
 		const nativeBinding = 'nativeBinding' in options ? options.nativeBinding : null;
+		const vfs = 'vfs' in options ? options.vfs : null;
+		const mmap = 'mmap' in options ? options.mmap : null;
 
 		// Validate interpreted options
 		if (readonly && anonymous && !buffer) throw new TypeError('In-memory/temporary databases cannot be readonly');
 		if (!Number.isInteger(timeout) || timeout < 0) throw new TypeError('Expected the "timeout" option to be a positive integer');
 		if (timeout > 0x7fffffff) throw new RangeError('Option "timeout" cannot be greater than 2147483647');
 		if (verbose != null && typeof verbose !== 'function') throw new TypeError('Expected the "verbose" option to be a function');
+		if (vfs != null && (typeof vfs !== 'string' || !vfs)) throw new TypeError('Expected the "vfs" option to be a non-empty string');
+		if (vfs != null && (anonymous || buffer)) throw new TypeError('The "vfs" option requires a database filename');
+		if (mmap != null && (!Number.isSafeInteger(mmap) || mmap < 0)) throw new TypeError('Expected the "mmap" option to be a non-negative integer');
 		if (!allowNativeBinding && 'nativeBinding' in options) throw new TypeError('The "nativeBinding" option is only supported by the default better-sqlite3 entrypoint');
 		if (allowNativeBinding && nativeBinding != null && typeof nativeBinding !== 'string' && typeof nativeBinding !== 'object') throw new TypeError('Expected the "nativeBinding" option to be a string or addon object');
 
 		// Load the native addon
 		const addon = getAddon(nativeBinding);
 		if (!addon.isInitialized) {
-			addon.initialize(SqliteError, arrayFactory, arrayAppender, rowFactory, recordFactory);
+			addon.initialize(SqliteError, arrayFactory, arrayAppender, rowFactory, recordFactory, lazyRowFactory(addon.readRowBuffer), expandedRowFactory, CArray, exportTo(addon.readIteratorChunk));
 			addon.isInitialized = true;
 		}
 
 		// Make sure the specified directory exists
-		if (!anonymous && !filename.startsWith('file:') && !fs.existsSync(path.dirname(filename))) {
+		if (!anonymous && vfs == null && !filename.startsWith('file:') && !fs.existsSync(path.dirname(filename))) {
 			throw new TypeError('Cannot open database because the directory does not exist');
 		}
 
 		Object.defineProperties(this, {
-			[util.cppdb]: { value: new addon.Database(filename, filenameGiven, anonymous, readonly, fileMustExist, timeout, verbose || null, buffer || null) },
+			[util.cppdb]: { value: new addon.Database(filename, filenameGiven, anonymous || vfs === 'memory', readonly, fileMustExist, timeout, verbose || null, buffer || null, vfs || null, mmap == null ? null : mmap) },
 			...wrappers.getters,
 		});
 	}
@@ -67,19 +74,41 @@ module.exports = function createDatabase(getAddon, allowNativeBinding) {
 	Database.prototype.explain = require('./methods/explain');
 	Database.prototype.backup = require('./methods/backup');
 	Database.prototype.serialize = require('./methods/serialize');
+	Database.prototype.importCSV = require('./methods/import-csv');
+	Database.prototype.insertColumns = require('./methods/insert-columns');
+	Database.prototype.batchWrites = require('./methods/batch-writes');
+	Database.prototype.retry = require('./methods/retry');
+	Database.prototype.checkpointer = require('./methods/checkpointer');
+	Database.prototype.onChange = require('./methods/on-change');
+	Database.prototype.createSession = require('./methods/create-session');
+	Database.prototype.applyChangeset = require('./methods/apply-changeset');
 	Database.prototype.function = require('./methods/function');
 	Database.prototype.aggregate = require('./methods/aggregate');
 	Database.prototype.table = require('./methods/table');
 	Database.prototype.loadExtension = wrappers.loadExtension;
 	Database.prototype.exec = wrappers.exec;
+	Database.prototype.flushWrites = wrappers.flushWrites;
+	Database.prototype.mmapStats = wrappers.mmapStats;
+	Database.prototype.allocatorStats = wrappers.allocatorStats;
+	Database.prototype.pageCacheStats = wrappers.pageCacheStats;
+	Database.prototype.checkpointStats = wrappers.checkpointStats;
+	Database.prototype.invertChangeset = wrappers.invertChangeset;
+	Database.prototype.concatChangesets = wrappers.concatChangesets;
 	Database.prototype.close = wrappers.close;
+	Database.prototype.timeLimit = wrappers.timeLimit;
+	Database.prototype.interruptHandle = wrappers.interruptHandle;
 	Database.prototype.defaultSafeIntegers = wrappers.defaultSafeIntegers;
 	Database.prototype.unsafeMode = wrappers.unsafeMode;
 	Database.prototype[util.inspect] = require('./methods/inspect');
+	Database.carray = carray;
 
 	return Database;
 };
 
+function carray(value) {
+	return new CArray(value);
+}
+
 function arrayFactory(...values) {
 	return values;
 }
@@ -104,6 +133,69 @@ function rowFactory(...keys) {
 	};
 }
 
+function expandedRowFactory(tables, columns) {
+	if (!tables.includes('__proto__') && !columns.includes('__proto__')) {
+		const groups = new Map();
+		columns.forEach((column, index) => {
+			const group = groups.get(tables[index]) || [];
+			groups.set(tables[index], group);
+			group.push(`${JSON.stringify(column)}:v${index}`);
+		});
+		const parameters = columns.map((_, index) => `v${index}`).join(',');
+		const properties = [...groups].map(([table, group]) => `${JSON.stringify(table)}:{${group.join(',')}}`).join(',');
+		return Function(`return (${parameters}) => ({${properties}})`)();
+	}
+	return (...values) => {
+		const row = {};
+		for (let i = 0; i < columns.length; ++i) {
+			if (!Object.prototype.hasOwnProperty.call(row, tables[i])) row[tables[i]] = {};
+			row[tables[i]][columns[i]] = values[i];
+		}
+		return row;
+	};
+}
+
+function lazyRowFactory(readRowBuffer) {
+	return (...keys) => {
+		const columnCount = keys.length;
+		class LazyRow {
+			#buffer;
+			#offset;
+			#values;
+			constructor(buffer, offset) {
+				this.#buffer = buffer;
+				this.#offset = offset;
+				this.#values = null;
+			}
+			static read(row, index) {
+				const values = row.#values || (row.#values = new Array(columnCount));
+				let value = values[index];
+				if (value === undefined) {
+					value = values[index] = readRowBuffer(row.#buffer, row.#offset + index);
+				}
+				return value;
+			}
+			toJSON() {
+				const row = {};
+				for (let i = 0; i < columnCount; ++i) row[keys[i]] = LazyRow.read(this, i);
+				return row;
+			}
+		}
+		keys.forEach((key, index) => {
+			Object.defineProperty(LazyRow.prototype, key, {
+				get() { return LazyRow.read(this, index); },
+				enumerable: true,
+				configurable: true,
+			});
+		});
+		return (buffer, rowCount) => {
+			const rows = new Array(rowCount);
+			for (let i = 0; i < rowCount; ++i) rows[i] = new LazyRow(buffer, i * columnCount);
+			return rows;
+		};
+	};
+}
+
 function recordFactory(value) {
 	return { value, done: false };
 }
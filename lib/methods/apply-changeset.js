@@ -0,0 +1,30 @@
+'use strict';
+const { cppdb } = require('../util');
+
+// Indexed by SQLITE_CHANGESET_DATA, SQLITE_CHANGESET_NOTFOUND, etc.
+const CONFLICT_TYPES = [null, 'data', 'notfound', 'conflict', 'constraint', 'foreign_key'];
+const OPS = { 18: 'insert', 23: 'update', 9: 'delete' };
+const RESOLUTIONS = { omit: 0, replace: 1, abort: 2 };
+
+module.exports = function applyChangeset(changeset, onConflict) {
+	if (onConflict == null) onConflict = abort;
+
+	// Validate arguments
+	if (!Buffer.isBuffer(changeset)) throw new TypeError('Expected first argument to be a buffer');
+	if (typeof onConflict !== 'function') throw new TypeError('Expected second argument to be a function');
+
+	this[cppdb].applyChangeset(changeset, (typeCode, table, opCode) => {
+		const type = CONFLICT_TYPES[typeCode];
+		const resolution = onConflict.call(this, { type, table, op: opCode === null ? null : OPS[opCode] });
+		if (!Object.prototype.hasOwnProperty.call(RESOLUTIONS, resolution)) {
+			throw new TypeError('Expected the conflict handler to return "omit", "replace", or "abort"');
+		}
+		if (resolution === 'replace' && type !== 'data' && type !== 'conflict') {
+			throw new TypeError(`A "${type}" conflict cannot be resolved with "replace"`);
+		}
+		return RESOLUTIONS[resolution];
+	});
+	return this;
+};
+
+const abort = () => 'abort';
@@ -0,0 +1,53 @@
+'use strict';
+const { cppdb } = require('../util');
+const timers = new WeakMap();
+
+module.exports = function batchWrites(options) {
+	if (options === false) {
+		stopTimer(this);
+		this[cppdb].batchWrites(0);
+		return this;
+	}
+	if (options == null) options = {};
+
+	// Validate arguments
+	if (typeof options !== 'object') throw new TypeError('Expected first argument to be an options object or false');
+
+	// Interpret options
+	const maxWrites = 'maxWrites' in options ? options.maxWrites : 1000;
+	const maxDelay = 'maxDelay' in options ? options.maxDelay : 10;
+	const onError = 'onError' in options ? options.onError : null;
+
+	// Validate interpreted options
+	if (!Number.isInteger(maxWrites) || maxWrites < 1) throw new TypeError('Expected the "maxWrites" option to be a positive integer');
+	if (maxWrites > 0x7fffffff) throw new RangeError('The "maxWrites" option cannot be greater than 2147483647');
+	if (!Number.isInteger(maxDelay) || maxDelay < 1) throw new TypeError('Expected the "maxDelay" option to be a positive integer');
+	if (maxDelay > 0x7fffffff) throw new RangeError('The "maxDelay" option cannot be greater than 2147483647');
+	if (onError !== null && typeof onError !== 'function') throw new TypeError('Expected the "onError" option to be a function');
+
+	this[cppdb].batchWrites(maxWrites);
+
+	// Periodically commit whatever writes are pending, without keeping the
+	// process alive. The timer stops itself once the database is closed. Since
+	// nothing could catch an error thrown by the timer, errors are passed to
+	// onError, or emitted as process warnings if there's no onError.
+	stopTimer(this);
+	const db = this;
+	const timer = setInterval(() => {
+		if (!db.open) return stopTimer(db);
+		try {
+			db[cppdb].flushWrites();
+		} catch (err) {
+			if (onError === null) process.emitWarning(err);
+			else onError.call(db, err);
+		}
+	}, maxDelay);
+	timer.unref();
+	timers.set(this, timer);
+	return this;
+};
+
+const stopTimer = (db) => {
+	clearInterval(timers.get(db));
+	timers.delete(db);
+};
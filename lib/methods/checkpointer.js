@@ -0,0 +1,31 @@
+'use strict';
+const { cppdb } = require('../util');
+
+const MODES = { PASSIVE: 0, FULL: 1, RESTART: 2, TRUNCATE: 3 };
+
+module.exports = function checkpointer(options) {
+	if (options === false) {
+		this[cppdb].stopCheckpointer();
+		return this;
+	}
+	if (options == null) options = {};
+
+	// Validate arguments
+	if (typeof options !== 'object') throw new TypeError('Expected first argument to be an options object or false');
+
+	// Interpret options
+	const mode = 'mode' in options ? options.mode : 'PASSIVE';
+	const intervalMs = 'intervalMs' in options ? options.intervalMs : 1000;
+	const walSizeLimit = 'walSizeLimit' in options ? options.walSizeLimit : 1000;
+
+	// Validate interpreted options
+	if (typeof mode !== 'string') throw new TypeError('Expected the "mode" option to be a string');
+	if (!Object.prototype.hasOwnProperty.call(MODES, mode.toUpperCase())) throw new TypeError(`Invalid checkpoint mode "${mode}"`);
+	if (!Number.isInteger(intervalMs) || intervalMs < 1) throw new TypeError('Expected the "intervalMs" option to be a positive integer');
+	if (intervalMs > 0x7fffffff) throw new RangeError('The "intervalMs" option cannot be greater than 2147483647');
+	if (!Number.isInteger(walSizeLimit) || walSizeLimit < 0) throw new TypeError('Expected the "walSizeLimit" option to be a non-negative integer');
+	if (walSizeLimit > 0x7fffffff) throw new RangeError('The "walSizeLimit" option cannot be greater than 2147483647');
+
+	this[cppdb].startCheckpointer(MODES[mode.toUpperCase()], intervalMs, walSizeLimit);
+	return this;
+};
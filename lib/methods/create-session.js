@@ -0,0 +1,21 @@
+'use strict';
+const { cppdb } = require('../util');
+
+module.exports = function createSession(tables, options) {
+	if (options == null) options = {};
+	if (typeof tables === 'string') tables = [tables];
+
+	// Validate arguments
+	if (tables != null && !Array.isArray(tables)) throw new TypeError('Expected first argument to be a string or an array of strings');
+	if (tables != null && !tables.every(x => typeof x === 'string' && x)) throw new TypeError('Expected each table name to be a non-empty string');
+	if (typeof options !== 'object') throw new TypeError('Expected second argument to be an options object');
+
+	// Interpret options
+	const attachedName = 'attached' in options ? options.attached : 'main';
+
+	// Validate interpreted options
+	if (typeof attachedName !== 'string') throw new TypeError('Expected the "attached" option to be a string');
+	if (!attachedName) throw new TypeError('The "attached" option cannot be an empty string');
+
+	return this[cppdb].createSession(this, attachedName, tables == null ? null : [...tables]);
+};
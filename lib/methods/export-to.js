@@ -0,0 +1,75 @@
+'use strict';
+const { getBooleanOption } = require('../util');
+
+// The addon's readIteratorChunk() function is passed in, so that it doesn't
+// need to be exposed as a method of StatementIterator.
+module.exports = readChunk => async function exportTo(destination, options) {
+	if (options == null) options = {};
+
+	// Validate arguments
+	if (destination == null || typeof destination.write !== 'function' || typeof destination.once !== 'function') {
+		throw new TypeError('Expected first argument to be a writable stream');
+	}
+	if (typeof options !== 'object') throw new TypeError('Expected second argument to be an options object');
+
+	// Interpret options
+	const format = 'format' in options ? options.format : 'csv';
+	const header = 'header' in options ? getBooleanOption(options, 'header') : true;
+	const end = 'end' in options ? getBooleanOption(options, 'end') : true;
+	const chunkSize = 'chunkSize' in options ? options.chunkSize : 65536;
+
+	// Validate interpreted options
+	if (format !== 'csv' && format !== 'ndjson') throw new TypeError('Expected the "format" option to be "csv" or "ndjson"');
+	if (!Number.isInteger(chunkSize) || chunkSize <= 0) throw new TypeError('Expected the "chunkSize" option to be a positive integer');
+	if (chunkSize > 0x7fffffff) throw new RangeError('Option "chunkSize" cannot be greater than 2147483647');
+
+	const csv = format === 'csv';
+	return runExport(readChunk, this.iterate(), destination, csv, csv && header, chunkSize, end);
+};
+
+const runExport = (readChunk, iterator, destination, csv, header, chunkSize, end) => {
+	let bytes = 0;
+	let settled = false;
+
+	return new Promise((resolve, reject) => {
+		const settle = (err) => {
+			if (settled) return;
+			settled = true;
+			destination.removeListener('drain', step);
+			destination.removeListener('error', settle);
+			destination.removeListener('close', onClose);
+			destination.removeListener('finish', onFinish);
+			if (err) {
+				try { iterator.return(); } catch (_) {}
+				reject(err);
+			} else {
+				resolve(bytes);
+			}
+		};
+		const onClose = () => settle(new Error('The destination stream was closed before the export finished'));
+		const onFinish = () => settle(null);
+
+		function step() {
+			if (settled) return;
+			try {
+				let chunk;
+				while ((chunk = readChunk(iterator, csv, header, chunkSize)) !== undefined) {
+					header = false;
+					bytes += chunk.length;
+					if (chunk.length && !destination.write(chunk)) return;
+				}
+			} catch (err) {
+				settle(err);
+				return;
+			}
+			if (end) destination.end();
+			else settle(null);
+		}
+
+		destination.on('drain', step);
+		destination.once('error', settle);
+		destination.once('close', onClose);
+		if (end) destination.once('finish', onFinish);
+		step();
+	});
+};
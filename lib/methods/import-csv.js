@@ -0,0 +1,42 @@
+'use strict';
+const { getBooleanOption, cppdb } = require('../util');
+
+module.exports = function importCSV(table, source, options) {
+	if (options == null) options = {};
+
+	// Validate arguments
+	if (typeof table !== 'string') throw new TypeError('Expected first argument to be a string');
+	if (typeof source !== 'string' && !Buffer.isBuffer(source)) throw new TypeError('Expected second argument to be a string or Buffer');
+	if (typeof options !== 'object') throw new TypeError('Expected third argument to be an options object');
+	if (!table) throw new TypeError('Table name cannot be an empty string');
+	if (typeof source === 'string' && !source.trim()) throw new TypeError('CSV filename cannot be an empty string');
+
+	// Interpret options
+	const attachedName = 'attached' in options ? options.attached : 'main';
+	const delimiter = 'delimiter' in options ? options.delimiter : ',';
+	const quote = 'quote' in options ? options.quote : '"';
+	const header = 'header' in options ? getBooleanOption(options, 'header') : true;
+	const columns = 'columns' in options ? options.columns : null;
+	const batchSize = 'batchSize' in options ? options.batchSize : 10000;
+	const infer = getBooleanOption(options, 'infer');
+
+	// Validate interpreted options
+	if (typeof attachedName !== 'string') throw new TypeError('Expected the "attached" option to be a string');
+	if (!attachedName) throw new TypeError('The "attached" option cannot be an empty string');
+	if (!isSingleCharacter(delimiter)) throw new TypeError('Expected the "delimiter" option to be a single ASCII character');
+	if (!isSingleCharacter(quote)) throw new TypeError('Expected the "quote" option to be a single ASCII character');
+	if (delimiter === quote) throw new TypeError('The "delimiter" and "quote" options must be different characters');
+	if (columns !== null) {
+		if (!Array.isArray(columns)) throw new TypeError('Expected the "columns" option to be an array');
+		if (!columns.length) throw new TypeError('The "columns" option cannot be an empty array');
+		if (columns.some(x => typeof x !== 'string' || !x)) throw new TypeError('Expected the "columns" option to only contain non-empty strings');
+	}
+	if (!Number.isInteger(batchSize) || batchSize < 1) throw new TypeError('Expected the "batchSize" option to be a positive integer');
+	if (batchSize > 0x7fffffff) throw new RangeError('The "batchSize" option cannot be greater than 2147483647');
+
+	return this[cppdb].importCSV(attachedName, table, source, delimiter.charCodeAt(0), quote.charCodeAt(0), header, columns, batchSize, infer);
+};
+
+const isSingleCharacter = (value) => {
+	return typeof value === 'string' && value.length === 1 && value.charCodeAt(0) < 128 && value !== '\n' && value !== '\r';
+};
@@ -0,0 +1,37 @@
+'use strict';
+const { cppdb } = require('../util');
+
+module.exports = function insertColumns(table, columns, options) {
+	if (options == null) options = {};
+
+	// Validate arguments
+	if (typeof table !== 'string') throw new TypeError('Expected first argument to be a string');
+	if (columns === null || typeof columns !== 'object' || Array.isArray(columns)) throw new TypeError('Expected second argument to be a Buffer or an object of columns');
+	if (typeof options !== 'object') throw new TypeError('Expected third argument to be an options object');
+	if (!table) throw new TypeError('Table name cannot be an empty string');
+
+	// Interpret options
+	const attachedName = 'attached' in options ? options.attached : 'main';
+
+	// Validate interpreted options
+	if (typeof attachedName !== 'string') throw new TypeError('Expected the "attached" option to be a string');
+	if (!attachedName) throw new TypeError('The "attached" option cannot be an empty string');
+
+	// An Arrow IPC stream is decoded natively, including its column names
+	if (Buffer.isBuffer(columns)) {
+		return this[cppdb].insertColumns(attachedName, table, columns, null);
+	}
+
+	// Otherwise, each property is a column of values
+	const names = Object.keys(columns);
+	const values = names.map(name => columns[name]);
+	if (!names.length) throw new TypeError('Expected at least one column');
+	if (values.some(x => !Array.isArray(x) && !isTypedArray(x))) throw new TypeError('Expected each column to be an array or a typed array');
+	if (values.some(x => x.length !== values[0].length)) throw new RangeError('Expected every column to have the same number of values');
+
+	return this[cppdb].insertColumns(attachedName, table, values, names);
+};
+
+const isTypedArray = (value) => {
+	return ArrayBuffer.isView(value) && !(value instanceof DataView);
+};
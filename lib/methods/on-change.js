@@ -0,0 +1,45 @@
+'use strict';
+const { cppdb } = require('../util');
+const listenerSets = new WeakMap();
+
+module.exports = function onChange(callback, options) {
+	if (options == null) options = {};
+
+	// Validate arguments
+	if (typeof callback !== 'function') throw new TypeError('Expected first argument to be a function');
+	if (typeof options !== 'object') throw new TypeError('Expected second argument to be an options object');
+
+	// Interpret options
+	const batch = 'batch' in options ? options.batch : true;
+
+	// Validate interpreted options
+	if (typeof batch !== 'boolean') throw new TypeError('Expected the "batch" option to be a boolean');
+	if (!this.open) throw new TypeError('The database connection is not open');
+
+	// The native change feed is shared by every listener of the database, and
+	// only exists while there are listeners
+	let listeners = listenerSets.get(this);
+	if (!listeners) {
+		const newListeners = new Set();
+		this[cppdb].changeHandler(changes => dispatch(this, newListeners, changes));
+		listenerSets.set(this, listeners = newListeners);
+	}
+	const listener = { callback, batch };
+	listeners.add(listener);
+
+	return () => {
+		if (!listeners.has(listener)) return;
+		if (listeners.size === 1 && listenerSets.get(this) === listeners) {
+			if (this.open) this[cppdb].changeHandler(null);
+			listenerSets.delete(this);
+		}
+		listeners.delete(listener);
+	};
+};
+
+const dispatch = (db, listeners, changes) => {
+	for (const { callback, batch } of listeners) {
+		if (batch) callback.call(db, changes);
+		else for (const change of changes) callback.call(db, change);
+	}
+};
@@ -7,6 +7,8 @@ module.exports = function pragma(source, options) {
 	if (typeof options !== 'object') throw new TypeError('Expected second argument to be an options object');
 	const simple = getBooleanOption(options, 'simple');
 
+	// Some pragmas can't be used within a transaction, so commit any batched writes
+	this[cppdb].flushWrites();
 	const stmt = this[cppdb].prepare(`PRAGMA ${source}`, this, true, false);
 	return simple ? stmt.pluck().get() : stmt.all();
 };
@@ -0,0 +1,58 @@
+'use strict';
+const { cppdb } = require('../util');
+
+module.exports = function retry(fn, options) {
+	if (options == null) options = {};
+
+	// Validate arguments
+	if (typeof fn !== 'function') throw new TypeError('Expected first argument to be a function');
+	if (typeof options !== 'object') throw new TypeError('Expected second argument to be an options object');
+
+	// Interpret options
+	const timeout = 'timeout' in options ? options.timeout : 5000;
+	const minDelay = 'minDelay' in options ? options.minDelay : 2;
+	const maxDelay = 'maxDelay' in options ? options.maxDelay : 100;
+
+	// Validate interpreted options
+	if (!Number.isInteger(timeout) || timeout < 0) throw new TypeError('Expected the "timeout" option to be a non-negative integer');
+	if (!Number.isInteger(minDelay) || minDelay < 1) throw new TypeError('Expected the "minDelay" option to be a positive integer');
+	if (!Number.isInteger(maxDelay) || maxDelay < minDelay) throw new TypeError('Expected the "maxDelay" option to be an integer no less than "minDelay"');
+
+	const db = this;
+	const deadline = Date.now() + timeout;
+	let delay = minDelay;
+
+	return new Promise((resolve, reject) => {
+		const attempt = () => {
+			let result;
+			try {
+				result = runWithoutWaiting(db, fn);
+			} catch (err) {
+				if (!isBusy(err)) return reject(err);
+				const now = Date.now();
+				if (now >= deadline) return reject(err);
+
+				// Exponential backoff with jitter, so that competing processes
+				// don't keep retrying in lockstep.
+				const wait = Math.min(delay / 2 + Math.random() * delay / 2, deadline - now);
+				delay = Math.min(delay * 2, maxDelay);
+				return void setTimeout(attempt, wait);
+			}
+			resolve(result);
+		};
+		attempt();
+	});
+};
+
+// Runs the function with a busy timeout of zero, so that SQLITE_BUSY is thrown
+// right away, instead of blocking the thread until the lock is released.
+const runWithoutWaiting = (db, fn) => {
+	const previousTimeout = db[cppdb].busyTimeout(0);
+	try {
+		return fn.call(db);
+	} finally {
+		if (db.open) db[cppdb].busyTimeout(previousTimeout);
+	}
+};
+
+const isBusy = err => typeof err === 'object' && err !== null && typeof err.code === 'string' && err.code.startsWith('SQLITE_BUSY');
@@ -1,20 +1,24 @@
 'use strict';
 const { cppdb } = require('../util');
-const controllers = new WeakMap();
+
+// These must match the order of the cached BEGIN statements in the C++ code
+const DEFAULT = 0;
+const DEFERRED = 1;
+const IMMEDIATE = 2;
+const EXCLUSIVE = 3;
 
 module.exports = function transaction(fn) {
 	if (typeof fn !== 'function') throw new TypeError('Expected first argument to be a function');
 
 	const db = this[cppdb];
-	const controller = getController(db, this);
 	const { apply } = Function.prototype;
 
 	// Each version of the transaction function has these same properties
 	const properties = {
-		default: { value: wrapTransaction(apply, fn, db, controller.default) },
-		deferred: { value: wrapTransaction(apply, fn, db, controller.deferred) },
-		immediate: { value: wrapTransaction(apply, fn, db, controller.immediate) },
-		exclusive: { value: wrapTransaction(apply, fn, db, controller.exclusive) },
+		default: { value: wrapTransaction(apply, fn, db, DEFAULT) },
+		deferred: { value: wrapTransaction(apply, fn, db, DEFERRED) },
+		immediate: { value: wrapTransaction(apply, fn, db, IMMEDIATE) },
+		exclusive: { value: wrapTransaction(apply, fn, db, EXCLUSIVE) },
 		database: { value: this, enumerable: true },
 	};
 
@@ -27,52 +31,20 @@ module.exports = function transaction(fn) {
 	return properties.default.value;
 };
 
-// Return the database's cached transaction controller, or create a new one
-const getController = (db, self) => {
-	let controller = controllers.get(db);
-	if (!controller) {
-		const shared = {
-			commit: db.prepare('COMMIT', self, false, false),
-			rollback: db.prepare('ROLLBACK', self, false, false),
-			savepoint: db.prepare('SAVEPOINT `\t_bs3.\t`', self, false, false),
-			release: db.prepare('RELEASE `\t_bs3.\t`', self, false, false),
-			rollbackTo: db.prepare('ROLLBACK TO `\t_bs3.\t`', self, false, false),
-		};
-		controllers.set(db, controller = {
-			default: Object.assign({ begin: db.prepare('BEGIN', self, false, false) }, shared),
-			deferred: Object.assign({ begin: db.prepare('BEGIN DEFERRED', self, false, false) }, shared),
-			immediate: Object.assign({ begin: db.prepare('BEGIN IMMEDIATE', self, false, false) }, shared),
-			exclusive: Object.assign({ begin: db.prepare('BEGIN EXCLUSIVE', self, false, false) }, shared),
-		});
-	}
-	return controller;
-};
-
-// Return a new transaction function by wrapping the given function
-const wrapTransaction = (apply, fn, db, { begin, commit, rollback, savepoint, release, rollbackTo }) => function sqliteTransaction() {
-	let before, after, undo;
-	if (db.inTransaction) {
-		before = savepoint;
-		after = release;
-		undo = rollbackTo;
-	} else {
-		before = begin;
-		after = commit;
-		undo = rollback;
-	}
-	before.run();
+// Return a new transaction function by wrapping the given function. Beginning
+// and ending the transaction (or savepoint, if nested) are each a single
+// native call that runs a cached statement.
+const wrapTransaction = (apply, fn, db, behavior) => function sqliteTransaction() {
+	const nested = db.beginTransaction(behavior);
 	try {
 		const result = apply.call(fn, this, arguments);
 		if (result && typeof result.then === 'function') {
 			throw new TypeError('Transaction function cannot return a promise');
 		}
-		after.run();
+		db.endTransaction(nested, true);
 		return result;
 	} catch (ex) {
-		if (db.inTransaction) {
-			undo.run();
-			if (undo !== rollback) after.run();
-		}
+		db.endTransaction(nested, false);
 		throw ex;
 	}
 };
@@ -10,6 +10,35 @@ exports.exec = function exec(sql) {
 	return this;
 };
 
+exports.flushWrites = function flushWrites() {
+	this[cppdb].flushWrites();
+	return this;
+};
+
+exports.mmapStats = function mmapStats() {
+	return this[cppdb].mmapStats();
+};
+
+exports.allocatorStats = function allocatorStats() {
+	return this[cppdb].allocatorStats();
+};
+
+exports.pageCacheStats = function pageCacheStats() {
+	return this[cppdb].pageCacheStats();
+};
+
+exports.checkpointStats = function checkpointStats() {
+	return this[cppdb].checkpointStats();
+};
+
+exports.invertChangeset = function invertChangeset(changeset) {
+	return this[cppdb].invertChangeset(changeset);
+};
+
+exports.concatChangesets = function concatChangesets(changesets) {
+	return this[cppdb].concatChangesets(changesets);
+};
+
 exports.close = function close() {
 	this[cppdb].close();
 	return this;
@@ -20,6 +49,18 @@ exports.loadExtension = function loadExtension(...args) {
 	return this;
 };
 
+exports.timeLimit = function timeLimit(ms) {
+	if (ms == null) ms = 0;
+	if (!Number.isInteger(ms) || ms < 0) throw new TypeError('Expected first argument to be a non-negative integer');
+	if (ms > 0x7fffffff) throw new RangeError('The time limit cannot be greater than 2147483647');
+	this[cppdb].timeLimit(ms);
+	return this;
+};
+
+exports.interruptHandle = function interruptHandle() {
+	return this[cppdb].interruptHandle(new Int32Array(new SharedArrayBuffer(4)));
+};
+
 exports.defaultSafeIntegers = function defaultSafeIntegers(...args) {
 	this[cppdb].defaultSafeIntegers(...args);
 	return this;
@@ -30,28 +30,73 @@ struct Addon {
 		});
 	}
 
+	// Installs PoolAllocator as SQLite's allocator if SQLITE_ALLOCATOR=pool is
+	// set, and installs PageCache if SQLITE_PAGE_CACHE_BUDGET is set to a
+	// positive number of bytes. Like ConfigureURI(), this only has an effect in
+	// the first thread that loads the addon, because these are shared by the
+	// whole process.
+	static void ConfigureMemory() {
+		static std::once_flag init_flag;
+		std::call_once(init_flag, [](){
+			const char* env = getenv("SQLITE_ALLOCATOR");
+			if (env != NULL && strcmp(env, "pool") == 0) {
+				bool installed = PoolAllocator::Install();
+				assert(installed); ((void)installed);
+			}
+			env = getenv("SQLITE_PAGE_CACHE_BUDGET");
+			if (env != NULL) {
+				char* end;
+				long long budget = strtoll(env, &end, 10);
+				if (*end == '\0' && budget > 0) {
+					bool installed = PageCache::Install(budget);
+					assert(installed); ((void)installed);
+				}
+			}
+		});
+	}
+
+	// Must be invoked after ConfigureURI() and ConfigureMemory(), because registering a VFS
+	// initializes SQLite, after which it can no longer be configured.
+	static void RegisterVFS() {
+		MemoryVFS::Register();
+		CountingVFS::Register();
+	}
+
 	static NODE_METHOD(JS_initialize) {
 		REQUIRE_ARGUMENT_FUNCTION(first, Napi::Function SqliteError);
 		REQUIRE_ARGUMENT_FUNCTION(second, Napi::Function ArrayFactory);
 		REQUIRE_ARGUMENT_FUNCTION(third, Napi::Function ArrayAppender);
 		REQUIRE_ARGUMENT_FUNCTION(fourth, Napi::Function RowFactory);
 		REQUIRE_ARGUMENT_FUNCTION(fifth, Napi::Function RecordFactory);
+		REQUIRE_ARGUMENT_FUNCTION(sixth, Napi::Function LazyRowFactory);
+		REQUIRE_ARGUMENT_FUNCTION(seventh, Napi::Function ExpandedRowFactory);
+		REQUIRE_ARGUMENT_FUNCTION(eighth, Napi::Function CArray);
+		REQUIRE_ARGUMENT_FUNCTION(ninth, Napi::Function ExportTo);
 		OnlyAddon->SqliteError = Napi::Persistent(SqliteError);
 		OnlyAddon->ArrayFactory = Napi::Persistent(ArrayFactory);
 		OnlyAddon->ArrayAppender = Napi::Persistent(ArrayAppender);
 		OnlyAddon->RowFactory = Napi::Persistent(RowFactory);
 		OnlyAddon->RecordFactory = Napi::Persistent(RecordFactory);
+		OnlyAddon->LazyRowFactory = Napi::Persistent(LazyRowFactory);
+		OnlyAddon->ExpandedRowFactory = Napi::Persistent(ExpandedRowFactory);
+		OnlyAddon->CArray = Napi::Persistent(CArray);
+		OnlyAddon->ExportTo = Napi::Persistent(ExportTo);
 		return info.Env().Undefined();
 	}
 
 	Napi::FunctionReference Statement;
 	Napi::FunctionReference StatementIterator;
 	Napi::FunctionReference Backup;
+	Napi::FunctionReference Session;
 	Napi::FunctionReference SqliteError;
 	Napi::FunctionReference ArrayFactory;
 	Napi::FunctionReference ArrayAppender;
 	Napi::FunctionReference RowFactory;
 	Napi::FunctionReference RecordFactory;
+	Napi::FunctionReference LazyRowFactory;
+	Napi::FunctionReference ExpandedRowFactory;
+	Napi::FunctionReference CArray;
+	Napi::FunctionReference ExportTo;
 	NODE_ARGUMENTS_POINTER privileged_info;
 	sqlite3_uint64 next_id;
 	CS cs;
@@ -1,15 +1,27 @@
 #include <cassert>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
 #include <climits>
 #include <cmath>
+#include <cstdint>
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <set>
 #include <random>
 #include <unordered_map>
 #include <algorithm>
 #include <mutex>
+#include <shared_mutex>
+#include <map>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <condition_variable>
 #include <sqlite3.h>
 #include <napi.h>
 
@@ -18,15 +30,30 @@ class Database;
 class Statement;
 class StatementIterator;
 class Backup;
+class Session;
+class ChangeFeed;
 
 #include "util/macros.cpp"
 #include "util/helpers.cpp"
 #include "util/constants.cpp"
 #include "util/bind-map.cpp"
 #include "util/data-converter.cpp"
+#include "util/row-buffer.cpp"
+#include "util/external-string.cpp"
+#include "util/string-cache.cpp"
+#include "util/csv-reader.cpp"
+#include "util/arrow-reader.cpp"
+#include "util/memory-vfs.cpp"
+#include "util/counting-vfs.cpp"
+#include "util/pool-allocator.cpp"
+#include "util/page-cache.cpp"
+#include "util/checkpointer.cpp"
+#include "util/result-cache.cpp"
 
 #include "util/row-builder.hpp"
+#include "util/json-writer.hpp"
 #include "objects/backup.hpp"
+#include "objects/session.hpp"
 #include "objects/statement.hpp"
 #include "objects/database.hpp"
 #include "addon.cpp"
@@ -34,13 +61,18 @@ class Backup;
 
 #include "util/data.cpp"
 #include "util/row-builder.cpp"
+#include "util/json-writer.cpp"
+#include "util/csv-writer.cpp"
+#include "util/arrow-writer.cpp"
 #include "util/query-macros.cpp"
 #include "util/custom-function.cpp"
 #include "util/custom-aggregate.cpp"
 #include "util/custom-table.cpp"
 #include "util/binder.cpp"
+#include "util/change-feed.cpp"
 
 #include "objects/backup.cpp"
+#include "objects/session.cpp"
 #include "objects/statement.cpp"
 #include "objects/database.cpp"
 #include "objects/statement-iterator.cpp"
@@ -48,6 +80,8 @@ class Backup;
 Napi::Object InitAll(Napi::Env env, Napi::Object exports) {
 	Napi::HandleScope scope(env);
 	Addon::ConfigureURI();
+	Addon::ConfigureMemory();
+	Addon::RegisterVFS();
 
 	// Initialize addon instance. The addon is bound to each native-backed class
 	// as callback data (rather than per-environment instance data) so that
@@ -60,12 +94,16 @@ Napi::Object InitAll(Napi::Env env, Napi::Object exports) {
 	exports.Set("Statement", Statement::Init(env, addon));
 	exports.Set("StatementIterator", StatementIterator::Init(env, addon));
 	exports.Set("Backup", Backup::Init(env, addon));
+	exports.Set("Session", Session::Init(env, addon));
 	exports.Set("initialize", Napi::Function::New(env, Addon::JS_initialize, "initialize", addon));
+	exports.Set("readRowBuffer", Napi::Function::New(env, RowBuffer::JS_read, "readRowBuffer", addon));
+	exports.Set("readIteratorChunk", Napi::Function::New(env, StatementIterator::JS_readChunk, "readIteratorChunk", addon));
 
 	// Store addon instance data.
 	addon->Statement = Napi::Persistent(exports.Get("Statement").As<Napi::Function>());
 	addon->StatementIterator = Napi::Persistent(exports.Get("StatementIterator").As<Napi::Function>());
 	addon->Backup = Napi::Persistent(exports.Get("Backup").As<Napi::Function>());
+	addon->Session = Napi::Persistent(exports.Get("Session").As<Napi::Function>());
 
 	return exports;
 }
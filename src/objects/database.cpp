@@ -9,6 +9,18 @@ const int Database::MAX_STRING_SIZE = (1 << 29) - 24;
 
 const napi_type_tag Database::TYPE_TAG = RandomTypeTag();
 
+const char* const Database::TRANSACTION_SQL[] = {
+	"BEGIN",
+	"BEGIN DEFERRED",
+	"BEGIN IMMEDIATE",
+	"BEGIN EXCLUSIVE",
+	"COMMIT",
+	"ROLLBACK",
+	"SAVEPOINT `\t_bs3.\t`",
+	"RELEASE `\t_bs3.\t`",
+	"ROLLBACK TO `\t_bs3.\t`",
+};
+
 Database::Database(const Napi::CallbackInfo& info) :
 	Napi::ObjectWrap<Database>(info),
 	db_handle(NULL),
@@ -22,7 +34,22 @@ Database::Database(const Napi::CallbackInfo& info) :
 	addon(static_cast<Addon*>(info.Data())),
 	logger(),
 	stmts(),
-	backups() {
+	backups(),
+	sessions(),
+	transaction_handles(),
+	data_version_handle(NULL),
+	savepoint_marks(),
+	batch_limit(0),
+	batch_writes(0),
+	batch_open(false),
+	time_limit(0),
+	has_progress_handler(false),
+	time_limit_active(false),
+	deadline(),
+	interrupt_flag(NULL),
+	interrupt_handle(),
+	checkpointer(NULL),
+	change_feed(NULL) {
 	TYPE_TAG_CONSTRUCTOR(info);
 	JS_new(info);
 }
@@ -38,8 +65,26 @@ void Database::CloseHandles() {
 		open = false;
 		for (Statement* stmt : stmts) stmt->CloseHandles();
 		for (Backup* backup : backups) backup->CloseHandles();
+		for (Session* session : sessions) session->CloseHandles();
 		stmts.clear();
 		backups.clear();
+		sessions.clear();
+		if (batch_open) {
+			batch_open = false;
+			sqlite3_exec(db_handle, "COMMIT", NULL, NULL, NULL);
+		}
+		for (sqlite3_stmt*& handle : transaction_handles) {
+			sqlite3_finalize(handle);
+			handle = NULL;
+		}
+		sqlite3_finalize(data_version_handle);
+		data_version_handle = NULL;
+		delete checkpointer;
+		checkpointer = NULL;
+		if (change_feed != NULL) {
+			change_feed->Close();
+			change_feed = NULL;
+		}
 		int status = sqlite3_close(db_handle);
 		assert(status == SQLITE_OK); ((void)status);
 	}
@@ -84,6 +129,76 @@ bool Database::Log(Napi::Env env, sqlite3_stmt* handle) {
 	return was_js_error;
 }
 
+// Results are never cached within a transaction, because its changes might
+// be rolled back, which none of these counters would reveal. Outside of
+// transactions, the counters cover changes made by this connection (including
+// schema changes) and changes committed to the main database by others.
+// PRAGMA data_version starts its own read, so it only reflects commits that
+// are visible to this connection. It's stepped before the cached query runs,
+// so a commit landing in between can only make a result look older than it
+// is, never newer.
+bool Database::GetDataVersion(ResultCache::Version& version) {
+	if (!sqlite3_get_autocommit(db_handle)) return false;
+	if (data_version_handle == NULL && sqlite3_prepare_v3(db_handle, "PRAGMA data_version", -1, SQLITE_PREPARE_PERSISTENT, &data_version_handle, NULL) != SQLITE_OK) {
+		return false;
+	}
+	bool success = sqlite3_step(data_version_handle) == SQLITE_ROW;
+	version.data_version = sqlite3_column_int(data_version_handle, 0);
+	sqlite3_reset(data_version_handle);
+	if (!success) return false;
+	version.file_version = 0;
+	sqlite3_file_control(db_handle, "main", SQLITE_FCNTL_DATA_VERSION, &version.file_version);
+	version.total_changes = sqlite3_total_changes64(db_handle);
+	return true;
+}
+
+// The progress handler is only installed once a time limit or an interrupt
+// handle is used, so other connections don't pay for it.
+void Database::EnableProgressHandler() {
+	if (has_progress_handler || !open) return;
+	has_progress_handler = true;
+	sqlite3_progress_handler(db_handle, 1000, OnProgress, this);
+}
+
+void Database::StartTimeLimit(int time_limit) {
+	if (time_limit < 0) time_limit = this->time_limit;
+	deadline = time_limit > 0
+		? std::chrono::steady_clock::now() + std::chrono::milliseconds(time_limit)
+		: std::chrono::steady_clock::time_point::max();
+	time_limit_active = true;
+	if (interrupt_flag != NULL) {
+		std::atomic_ref<int32_t>(*interrupt_flag).store(0, std::memory_order_relaxed);
+	}
+}
+
+Database::ChangeMark Database::MarkChanges() {
+	if (change_feed == NULL) return { 0, 0 };
+	return { change_feed->GetRecorded(), sqlite3_total_changes64(db_handle) };
+}
+
+// When a statement fails, SQLite undoes its changes, unless it failed because
+// of ON CONFLICT FAIL (or RAISE(FAIL)). In that case, the rows it changed
+// before failing are kept, and they're counted by sqlite3_total_changes64().
+void Database::DiscardFailedChanges(const ChangeMark& mark) {
+	if (change_feed == NULL || sqlite3_total_changes64(db_handle) != mark.total_changes) return;
+	change_feed->Discard(mark.recorded);
+}
+
+void Database::DiscardChanges(const ChangeMark& mark) {
+	if (change_feed != NULL) change_feed->Discard(mark.recorded);
+}
+
+// Invoked by SQLite every 1000 virtual machine instructions. Returning
+// non-zero interrupts the running statement with SQLITE_INTERRUPT.
+int Database::OnProgress(void* data) {
+	Database* db = static_cast<Database*>(data);
+	if (!db->time_limit_active) return 0;
+	if (db->interrupt_flag != NULL && std::atomic_ref<int32_t>(*db->interrupt_flag).exchange(0, std::memory_order_relaxed) != 0) {
+		return 1;
+	}
+	return std::chrono::steady_clock::now() >= db->deadline;
+}
+
 bool Database::Deserialize(
 	Napi::Env env,
 	Napi::Object buffer,
@@ -126,6 +241,26 @@ INIT(Database::Init) {
 		PrototypeMethod<Database, &Database::JS_exec>("exec", addon),
 		PrototypeMethod<Database, &Database::JS_backup>("backup", addon),
 		PrototypeMethod<Database, &Database::JS_serialize>("serialize", addon),
+		PrototypeMethod<Database, &Database::JS_importCSV>("importCSV", addon),
+		PrototypeMethod<Database, &Database::JS_insertColumns>("insertColumns", addon),
+		PrototypeMethod<Database, &Database::JS_beginTransaction>("beginTransaction", addon),
+		PrototypeMethod<Database, &Database::JS_endTransaction>("endTransaction", addon),
+		PrototypeMethod<Database, &Database::JS_batchWrites>("batchWrites", addon),
+		PrototypeMethod<Database, &Database::JS_flushWrites>("flushWrites", addon),
+		PrototypeMethod<Database, &Database::JS_mmapStats>("mmapStats", addon),
+		PrototypeMethod<Database, &Database::JS_allocatorStats>("allocatorStats", addon),
+		PrototypeMethod<Database, &Database::JS_pageCacheStats>("pageCacheStats", addon),
+		PrototypeMethod<Database, &Database::JS_timeLimit>("timeLimit", addon),
+		PrototypeMethod<Database, &Database::JS_interruptHandle>("interruptHandle", addon),
+		PrototypeMethod<Database, &Database::JS_busyTimeout>("busyTimeout", addon),
+		PrototypeMethod<Database, &Database::JS_startCheckpointer>("startCheckpointer", addon),
+		PrototypeMethod<Database, &Database::JS_stopCheckpointer>("stopCheckpointer", addon),
+		PrototypeMethod<Database, &Database::JS_checkpointStats>("checkpointStats", addon),
+		PrototypeMethod<Database, &Database::JS_changeHandler>("changeHandler", addon),
+		PrototypeMethod<Database, &Database::JS_createSession>("createSession", addon),
+		PrototypeMethod<Database, &Database::JS_applyChangeset>("applyChangeset", addon),
+		PrototypeMethod<Database, &Database::JS_invertChangeset>("invertChangeset", addon),
+		PrototypeMethod<Database, &Database::JS_concatChangesets>("concatChangesets", addon),
 		PrototypeMethod<Database, &Database::JS_function>("function", addon),
 		PrototypeMethod<Database, &Database::JS_aggregate>("aggregate", addon),
 		PrototypeMethod<Database, &Database::JS_table>("table", addon),
@@ -146,6 +281,8 @@ NODE_METHOD(Database::JS_new) {
 	REQUIRE_ARGUMENT_INT32(sixth, int timeout);
 	REQUIRE_ARGUMENT_ANY(seventh, Napi::Value logger);
 	REQUIRE_ARGUMENT_ANY(eighth, Napi::Value buffer);
+	REQUIRE_ARGUMENT_ANY(ninth, Napi::Value vfs);
+	REQUIRE_ARGUMENT_ANY(tenth, Napi::Value mmap);
 
 	UseAddon;
 	UseIsolate;
@@ -155,7 +292,11 @@ NODE_METHOD(Database::JS_new) {
 		: must_exist ? SQLITE_OPEN_READWRITE
 		: (SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE);
 
-	if (sqlite3_open_v2(utf8.c_str(), &db_handle, mask, NULL) != SQLITE_OK) {
+	// Connections that use memory-mapped I/O are opened through CountingVFS
+	// (unless another VFS is given), so that JS_mmapStats() can report on it.
+	const bool use_mmap = mmap.IsNumber();
+	std::string vfs_name = vfs.IsString() ? vfs.As<Napi::String>().Utf8Value() : use_mmap ? CountingVFS::NAME : "";
+	if (sqlite3_open_v2(utf8.c_str(), &db_handle, mask, vfs_name.empty() ? NULL : vfs_name.c_str()) != SQLITE_OK) {
 		ThrowSqliteError(env, addon, db_handle);
 		int status = sqlite3_close(db_handle);
 		assert(status == SQLITE_OK); ((void)status);
@@ -172,6 +313,19 @@ NODE_METHOD(Database::JS_new) {
 	status = sqlite3_db_config(db_handle, SQLITE_DBCONFIG_DEFENSIVE, 1, NULL);
 	assert(status == SQLITE_OK); ((void)status);
 
+	// SQLite clamps the size to SQLITE_MAX_MMAP_SIZE. The global default set by
+	// SQLITE_CONFIG_MMAP_SIZE can't be changed here, since SQLite has already
+	// been initialized, so the size is set for each connection instead.
+	if (use_mmap) {
+		std::string pragma = "PRAGMA mmap_size = " + std::to_string(static_cast<sqlite3_int64>(mmap.As<Napi::Number>().DoubleValue()));
+		if (sqlite3_exec(db_handle, pragma.c_str(), NULL, NULL, NULL) != SQLITE_OK) {
+			ThrowSqliteError(env, addon, db_handle);
+			int status = sqlite3_close(db_handle);
+			assert(status == SQLITE_OK); ((void)status);
+			return env.Undefined();
+		}
+	}
+
 	if (buffer.IsBuffer() && !Deserialize(env, buffer.As<Napi::Object>(), addon, db_handle, readonly)) {
 		int status = sqlite3_close(db_handle);
 		assert(status == SQLITE_OK); ((void)status);
@@ -219,9 +373,11 @@ NODE_METHOD(Database::JS_exec) {
 	REQUIRE_DATABASE_OPEN(db);
 	REQUIRE_DATABASE_NOT_BUSY(db);
 	REQUIRE_DATABASE_NO_ITERATORS_UNLESS_UNSAFE(db);
+	UseIsolate;
+	if (!db->FlushBatch(env)) return env.Undefined();
 	db->busy = true;
+	TimeLimit time_limit(db, -1);
 
-	UseIsolate;
 	std::string utf8 = source.Utf8Value();
 	const char* sql = utf8.c_str();
 	const char* tail;
@@ -241,10 +397,14 @@ NODE_METHOD(Database::JS_exec) {
 			status = -1;
 			break;
 		}
+		const ChangeMark mark = db->MarkChanges();
 		do status = sqlite3_step(handle);
 		while (status == SQLITE_ROW);
 		status = sqlite3_finalize(handle);
-		if (status != SQLITE_OK) break;
+		if (status != SQLITE_OK) {
+			db->DiscardFailedChanges(mark);
+			break;
+		}
 	}
 
 	db->busy = false;
@@ -292,6 +452,859 @@ NODE_METHOD(Database::JS_serialize) {
 	return Napi::Buffer<char>::NewOrCopy(env, reinterpret_cast<char*>(data), length, FreeSerialization);
 }
 
+NODE_METHOD(Database::JS_importCSV) {
+	UNWRAP_OR_RETURN(Database, db, info.This());
+	REQUIRE_ARGUMENT_STRING(first, Napi::String attachedName);
+	REQUIRE_ARGUMENT_STRING(second, Napi::String tableName);
+	REQUIRE_ARGUMENT_ANY(third, Napi::Value source);
+	REQUIRE_ARGUMENT_INT32(fourth, int delimiter);
+	REQUIRE_ARGUMENT_INT32(fifth, int quote);
+	REQUIRE_ARGUMENT_BOOLEAN(sixth, bool header);
+	REQUIRE_ARGUMENT_ANY(seventh, Napi::Value columns);
+	REQUIRE_ARGUMENT_INT32(eighth, int batch_size);
+	REQUIRE_ARGUMENT_BOOLEAN(ninth, bool infer);
+	REQUIRE_DATABASE_OPEN(db);
+	REQUIRE_DATABASE_NOT_BUSY(db);
+	REQUIRE_DATABASE_NO_ITERATORS_UNLESS_UNSAFE(db);
+	assert(batch_size > 0);
+
+	UseIsolate;
+	if (!db->FlushBatch(env)) return env.Undefined();
+	Addon* addon = db->addon;
+	sqlite3* const db_handle = db->db_handle;
+	auto start_time = std::chrono::steady_clock::now();
+
+	FILE* file = NULL;
+	Napi::Buffer<char> buffer;
+	if (source.IsBuffer()) {
+		buffer = source.As<Napi::Buffer<char>>();
+	} else {
+		std::string filename = source.As<Napi::String>().Utf8Value();
+		file = fopen(filename.c_str(), "rb");
+		if (file == NULL) {
+			return ThrowError(env, (std::string("Cannot open file: ") + strerror(errno)).c_str());
+		}
+	}
+	CsvReader reader = file != NULL
+		? CsvReader(file, static_cast<char>(delimiter), static_cast<char>(quote))
+		: CsvReader(buffer.Data(), buffer.Length(), static_cast<char>(delimiter), static_cast<char>(quote));
+
+	// Determine the column names, if any.
+	std::vector<std::string> names;
+	if (columns.IsArray()) {
+		Napi::Array array = columns.As<Napi::Array>();
+		uint32_t length = array.Length();
+		for (uint32_t i = 0; i < length; ++i) {
+			Napi::Value name = SafeGetElement(env, array, i);
+			if (name.IsEmpty()) return env.Undefined();
+			names.push_back(name.As<Napi::String>().Utf8Value());
+		}
+	}
+	bool has_record = reader.Next();
+	if (header && has_record) {
+		if (names.empty()) {
+			for (size_t i = 0; i < reader.GetFieldCount(); ++i) {
+				names.emplace_back(reader.GetField(i), reader.GetFieldLength(i));
+			}
+		}
+		has_record = reader.Next();
+	}
+
+	size_t rows = 0;
+	if (has_record) {
+		size_t column_count = names.empty() ? reader.GetFieldCount() : names.size();
+		std::string sql = GetInsertSQL(attachedName.Utf8Value(), tableName.Utf8Value(), names, column_count);
+		sqlite3_stmt* handle;
+		if (sqlite3_prepare_v3(db_handle, sql.c_str(), -1, SQLITE_PREPARE_PERSISTENT, &handle, NULL) != SQLITE_OK) {
+			db->ThrowDatabaseError(env);
+			return env.Undefined();
+		}
+
+		// Rows are inserted in batches, each within its own savepoint. If there's
+		// no transaction already, each batch is committed when it's released.
+		db->busy = true;
+		const bool owns_transaction = sqlite3_get_autocommit(db_handle);
+		const ChangeMark change_mark = db->MarkChanges();
+		std::string error;
+		// Records are parsed in place, so a Buffer source is looked up again
+		// after each step (like in JS_insertColumns()), and nothing more is read
+		// from it if a function or trigger detached, moved, or shrunk it.
+		const char* const data = file == NULL ? buffer.Data() : NULL;
+		const size_t length = file == NULL ? buffer.Length() : 0;
+		auto buffer_changed = [&]() {
+			if (file != NULL) return false;
+			void* current_data;
+			size_t current_length;
+			return napi_get_buffer_info(env, source, &current_data, &current_length) != napi_ok
+				|| static_cast<const char*>(current_data) != data || current_length < length;
+		};
+		int status = sqlite3_exec(db_handle, "SAVEPOINT \"better-sqlite3 import\"", NULL, NULL, NULL);
+		while (status == SQLITE_OK && has_record) {
+			if (reader.GetFieldCount() != column_count) {
+				error = "Expected " + std::to_string(column_count) + " fields on line " + std::to_string(reader.GetLine()) + ", but found " + std::to_string(reader.GetFieldCount());
+				break;
+			}
+			for (size_t i = 0; i < column_count && status == SQLITE_OK; ++i) {
+				status = reader.BindField(handle, static_cast<int>(i + 1), i, infer);
+			}
+			if (status != SQLITE_OK) break;
+			status = sqlite3_step(handle);
+			sqlite3_reset(handle);
+			if (status != SQLITE_DONE) break;
+			status = SQLITE_OK;
+			if (buffer_changed()) {
+				error = "The CSV buffer was detached or resized during the import";
+				break;
+			}
+			if (++rows % batch_size == 0) {
+				status = sqlite3_exec(db_handle, "RELEASE \"better-sqlite3 import\"; SAVEPOINT \"better-sqlite3 import\"", NULL, NULL, NULL);
+			}
+			if (status == SQLITE_OK) has_record = reader.Next();
+		}
+		if (status == SQLITE_OK && error.empty() && reader.GetError() != NULL) {
+			error = std::string(reader.GetError()) + " on line " + std::to_string(reader.GetLine());
+		}
+		if (status == SQLITE_OK && error.empty()) {
+			status = sqlite3_exec(db_handle, "RELEASE \"better-sqlite3 import\"", NULL, NULL, NULL);
+		}
+		sqlite3_finalize(handle);
+
+		if (status != SQLITE_OK || !error.empty()) {
+			if (status != SQLITE_OK) db->ThrowDatabaseError(env);
+			else if (reader.GetError() != NULL) ThrowError(env, error.c_str());
+			else ThrowRangeError(env, error.c_str());
+			db->RollbackImport(owns_transaction, change_mark);
+			db->busy = false;
+			return env.Undefined();
+		}
+		db->busy = false;
+	} else if (reader.GetError() != NULL) {
+		return ThrowError(env, (std::string(reader.GetError()) + " on line " + std::to_string(reader.GetLine())).c_str());
+	}
+
+	double duration = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+	Napi::Object result = Napi::Object::New(env);
+	result.Set(addon->cs.rows.Value(), Napi::Number::New(env, static_cast<double>(rows)));
+	result.Set(addon->cs.bytes.Value(), Napi::Number::New(env, static_cast<double>(reader.GetBytesRead())));
+	result.Set(addon->cs.duration.Value(), Napi::Number::New(env, duration));
+	return result;
+}
+
+NODE_METHOD(Database::JS_insertColumns) {
+	UNWRAP_OR_RETURN(Database, db, info.This());
+	REQUIRE_ARGUMENT_STRING(first, Napi::String attachedName);
+	REQUIRE_ARGUMENT_STRING(second, Napi::String tableName);
+	REQUIRE_ARGUMENT_ANY(third, Napi::Value source);
+	REQUIRE_ARGUMENT_ANY(fourth, Napi::Value columnNames);
+	REQUIRE_DATABASE_OPEN(db);
+	REQUIRE_DATABASE_NOT_BUSY(db);
+	REQUIRE_DATABASE_NO_ITERATORS_UNLESS_UNSAFE(db);
+
+	UseIsolate;
+	if (!db->FlushBatch(env)) return env.Undefined();
+	Addon* addon = db->addon;
+	sqlite3* const db_handle = db->db_handle;
+	auto start_time = std::chrono::steady_clock::now();
+
+	// The source is either an Arrow IPC stream, or an array of columns (each
+	// being a typed array or an array) whose names are given separately.
+	const bool is_arrow = source.IsBuffer();
+	Napi::Buffer<char> buffer;
+	if (is_arrow) buffer = source.As<Napi::Buffer<char>>();
+	const char* const data = is_arrow ? buffer.Data() : NULL;
+	const size_t length = is_arrow ? buffer.Length() : 0;
+	ArrowReader reader(data, length);
+	std::vector<std::string> names;
+	std::vector<Napi::Value> columns;
+	size_t row_count = 0;
+	if (is_arrow) {
+		if (!reader.ReadSchema()) return ThrowTypeError(env, reader.GetError());
+		for (size_t i = 0; i < reader.GetColumnCount(); ++i) {
+			names.push_back(reader.GetColumnName(i));
+		}
+	} else {
+		Napi::Array source_array = source.As<Napi::Array>();
+		Napi::Array names_array = columnNames.As<Napi::Array>();
+		for (uint32_t i = 0; i < names_array.Length(); ++i) {
+			Napi::Value name = SafeGetElement(env, names_array, i);
+			if (name.IsEmpty()) return env.Undefined();
+			Napi::Value column = SafeGetElement(env, source_array, i);
+			if (column.IsEmpty()) return env.Undefined();
+			size_t column_length = column.IsTypedArray()
+				? column.As<Napi::TypedArray>().ElementLength()
+				: column.As<Napi::Array>().Length();
+			if (i > 0 && column_length != row_count) {
+				return ThrowRangeError(env, "Expected every column to have the same number of values");
+			}
+			names.push_back(name.As<Napi::String>().Utf8Value());
+			columns.push_back(column);
+			row_count = column_length;
+		}
+	}
+
+	sqlite3_stmt* handle;
+	std::string sql = GetInsertSQL(attachedName.Utf8Value(), tableName.Utf8Value(), names, names.size());
+	if (sqlite3_prepare_v3(db_handle, sql.c_str(), -1, SQLITE_PREPARE_PERSISTENT, &handle, NULL) != SQLITE_OK) {
+		db->ThrowDatabaseError(env);
+		return env.Undefined();
+	}
+
+	// All rows are inserted within a single savepoint, so either all of them
+	// are inserted or none are. A status of -1 means a JavaScript exception is
+	// already pending. Since JavaScript functions can run during each step (by
+	// way of user-defined SQL functions), column buffers are looked up again
+	// for every row, in case they were detached or resized.
+	db->busy = true;
+	const bool owns_transaction = sqlite3_get_autocommit(db_handle);
+	const ChangeMark change_mark = db->MarkChanges();
+	size_t rows = 0;
+	const size_t column_count = names.size();
+	const char* error = NULL;
+	bool is_type_error = false;
+	int status = sqlite3_exec(db_handle, "SAVEPOINT \"better-sqlite3 import\"", NULL, NULL, NULL);
+	if (is_arrow) {
+		// Napi::Buffer only records the pointer and length it was created with,
+		// so the Arrow buffer is looked up again after each step, and nothing
+		// more is read from it if it was detached, moved, or shrunk.
+		auto buffer_changed = [&]() {
+			void* current_data;
+			size_t current_length;
+			return napi_get_buffer_info(env, source, &current_data, &current_length) != napi_ok
+				|| static_cast<const char*>(current_data) != data || current_length < length;
+		};
+		while (status == SQLITE_OK && error == NULL && reader.NextBatch()) {
+			size_t batch_rows = reader.GetRowCount();
+			for (size_t row = 0; row < batch_rows && status == SQLITE_OK; ++row) {
+				for (size_t i = 0; i < column_count && status == SQLITE_OK; ++i) {
+					status = reader.BindValue(handle, static_cast<int>(i + 1), i, row);
+				}
+				if (status != SQLITE_OK) break;
+				status = sqlite3_step(handle);
+				sqlite3_reset(handle);
+				if (status == SQLITE_DONE) status = SQLITE_OK;
+				rows += 1;
+				if (status == SQLITE_OK && buffer_changed()) {
+					error = "The Arrow buffer was detached or resized during the insert";
+					break;
+				}
+			}
+		}
+		if (error == NULL && reader.GetError() != NULL) {
+			// Values that can't be bound are range errors, while a malformed
+			// stream is a type error (just like an invalid schema).
+			error = reader.GetError();
+			is_type_error = status != SQLITE_RANGE;
+		}
+	} else {
+		for (size_t row = 0; row < row_count && status == SQLITE_OK; ++row) {
+			for (size_t i = 0; i < column_count && status == SQLITE_OK; ++i) {
+				status = BindColumnValue(env, handle, static_cast<int>(i + 1), columns[i], row);
+			}
+			if (status != SQLITE_OK) break;
+			status = sqlite3_step(handle);
+			sqlite3_reset(handle);
+			if (status == SQLITE_DONE) status = SQLITE_OK;
+			rows += 1;
+		}
+	}
+	if (status == SQLITE_OK && error == NULL) {
+		status = sqlite3_exec(db_handle, "RELEASE \"better-sqlite3 import\"", NULL, NULL, NULL);
+	}
+	sqlite3_finalize(handle);
+
+	if (status != SQLITE_OK || error != NULL) {
+		if (error != NULL && is_type_error) ThrowTypeError(env, error);
+		else if (error != NULL) ThrowRangeError(env, error);
+		else if (status != -1) db->ThrowDatabaseError(env);
+		db->RollbackImport(owns_transaction, change_mark);
+		db->busy = false;
+		return env.Undefined();
+	}
+	db->busy = false;
+
+	double duration = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+	Napi::Object result = Napi::Object::New(env);
+	result.Set(addon->cs.rows.Value(), Napi::Number::New(env, static_cast<double>(rows)));
+	result.Set(addon->cs.duration.Value(), Napi::Number::New(env, duration));
+	return result;
+}
+
+// Builds an INSERT statement with a parameter for each column. If no column
+// names are given, values are inserted into the table's columns in order.
+std::string Database::GetInsertSQL(const std::string& attached, const std::string& table, const std::vector<std::string>& names, size_t column_count) {
+	std::string sql = "INSERT INTO " + QuoteIdentifier(attached) + "." + QuoteIdentifier(table);
+	if (!names.empty()) {
+		sql += " (";
+		for (size_t i = 0; i < column_count; ++i) {
+			if (i) sql += ',';
+			sql += QuoteIdentifier(names[i]);
+		}
+		sql += ')';
+	}
+	sql += " VALUES (";
+	for (size_t i = 0; i < column_count; ++i) sql += i ? ",?" : "?";
+	sql += ')';
+	return sql;
+}
+
+// Binds the value at the given row of a column given to insertColumns().
+// Values of integer typed arrays are bound as integers. Returns -1 if an
+// exception was thrown.
+int Database::BindColumnValue(Napi::Env env, sqlite3_stmt* handle, int param, Napi::Value column, size_t row) {
+	if (column.IsTypedArray()) {
+		napi_typedarray_type type;
+		size_t length;
+		void* data;
+		napi_status status = napi_get_typedarray_info(env, column, &type, &length, &data, NULL, NULL);
+		if (status != napi_ok || row >= length || data == NULL) {
+			ThrowRangeError(env, "A typed array was detached or resized during the insert");
+			return -1;
+		}
+		switch (type) {
+			case napi_int8_array: return sqlite3_bind_int64(handle, param, static_cast<int8_t*>(data)[row]);
+			case napi_uint8_array:
+			case napi_uint8_clamped_array: return sqlite3_bind_int64(handle, param, static_cast<uint8_t*>(data)[row]);
+			case napi_int16_array: return sqlite3_bind_int64(handle, param, static_cast<int16_t*>(data)[row]);
+			case napi_uint16_array: return sqlite3_bind_int64(handle, param, static_cast<uint16_t*>(data)[row]);
+			case napi_int32_array: return sqlite3_bind_int64(handle, param, static_cast<int32_t*>(data)[row]);
+			case napi_uint32_array: return sqlite3_bind_int64(handle, param, static_cast<uint32_t*>(data)[row]);
+			case napi_float32_array: return sqlite3_bind_double(handle, param, static_cast<float*>(data)[row]);
+			case napi_float64_array: return sqlite3_bind_double(handle, param, static_cast<double*>(data)[row]);
+			case napi_bigint64_array: return sqlite3_bind_int64(handle, param, static_cast<int64_t*>(data)[row]);
+			case napi_biguint64_array: {
+				uint64_t value = static_cast<uint64_t*>(data)[row];
+				if (value > static_cast<uint64_t>(INT64_MAX)) {
+					ThrowRangeError(env, "A BigUint64Array value is too large to be stored in SQLite");
+					return -1;
+				}
+				return sqlite3_bind_int64(handle, param, static_cast<sqlite3_int64>(value));
+			}
+			default:
+				ThrowTypeError(env, "Unsupported typed array type");
+				return -1;
+		}
+	}
+
+	Napi::Value value = SafeGetElement(env, column.As<Napi::Object>(), static_cast<uint32_t>(row));
+	if (value.IsEmpty()) return -1;
+	int status = Data::BindValueFromJS(env, handle, param, value);
+	if (status == -1) {
+		ThrowTypeError(env, "SQLite3 can only bind numbers, strings, bigints, buffers, and null");
+	} else if (status == SQLITE_TOOBIG) {
+		ThrowRangeError(env, "The bound string, buffer, or bigint is too big");
+		status = -1;
+	}
+	return status;
+}
+
+// Undoes a failed import. If the import started its own transaction, the
+// whole transaction is rolled back, otherwise just the import's savepoint
+// (which the ChangeFeed doesn't notice on its own).
+void Database::RollbackImport(bool owns_transaction, const ChangeMark& change_mark) {
+	if (owns_transaction) {
+		if (!sqlite3_get_autocommit(db_handle)) sqlite3_exec(db_handle, "ROLLBACK", NULL, NULL, NULL);
+	} else {
+		sqlite3_exec(db_handle, "ROLLBACK TO \"better-sqlite3 import\"; RELEASE \"better-sqlite3 import\"", NULL, NULL, NULL);
+		DiscardChanges(change_mark);
+	}
+}
+
+// Starts a transaction with the given behavior, or a savepoint if a transaction
+// is already active. Returns whether a savepoint was used, which must be passed
+// back to JS_endTransaction(). Unlike running the equivalent Statements, this
+// doesn't create any Statement objects or result objects, but it's subject to
+// the same restrictions as Statement#run().
+NODE_METHOD(Database::JS_beginTransaction) {
+	UNWRAP_OR_RETURN(Database, db, info.This());
+	REQUIRE_ARGUMENT_INT32(first, int behavior);
+	REQUIRE_DATABASE_OPEN(db);
+	REQUIRE_DATABASE_NOT_BUSY(db);
+	REQUIRE_DATABASE_NO_ITERATORS_UNLESS_UNSAFE(db);
+	UseIsolate;
+	if (behavior < BEGIN || behavior > BEGIN_EXCLUSIVE) {
+		return ThrowRangeError(env, "Invalid transaction behavior");
+	}
+	if (!db->FlushBatch(env)) return env.Undefined();
+	const bool nested = !sqlite3_get_autocommit(db->db_handle);
+	const ChangeMark change_mark = db->MarkChanges();
+	if (!db->RunTransactionStatement(env, nested ? SAVEPOINT : behavior)) {
+		return env.Undefined();
+	}
+	if (nested) db->savepoint_marks.push_back(change_mark);
+	return Napi::Boolean::New(env, nested);
+}
+
+// Commits or rolls back whatever JS_beginTransaction() started. Rolling back
+// does nothing if SQLite already rolled back the transaction on its own.
+// Changes undone by rolling back to a savepoint are withheld from the
+// ChangeFeed, since SQLite doesn't report them.
+NODE_METHOD(Database::JS_endTransaction) {
+	UNWRAP_OR_RETURN(Database, db, info.This());
+	REQUIRE_ARGUMENT_BOOLEAN(first, bool nested);
+	REQUIRE_ARGUMENT_BOOLEAN(second, bool commit);
+	UseIsolate;
+	ChangeMark change_mark = db->MarkChanges();
+	if (nested && !db->savepoint_marks.empty()) {
+		change_mark = db->savepoint_marks.back();
+		db->savepoint_marks.pop_back();
+	} else if (!nested) {
+		db->savepoint_marks.clear();
+	}
+	if (commit) {
+		REQUIRE_DATABASE_OPEN(db);
+		REQUIRE_DATABASE_NOT_BUSY(db);
+		REQUIRE_DATABASE_NO_ITERATORS_UNLESS_UNSAFE(db);
+		db->RunTransactionStatement(env, nested ? RELEASE : COMMIT);
+	} else if (db->open && !sqlite3_get_autocommit(db->db_handle)) {
+		REQUIRE_DATABASE_NOT_BUSY(db);
+		REQUIRE_DATABASE_NO_ITERATORS_UNLESS_UNSAFE(db);
+		if (!nested) db->RunTransactionStatement(env, ROLLBACK);
+		else if (db->RunTransactionStatement(env, ROLLBACK_TO)) {
+			db->DiscardChanges(change_mark);
+			db->RunTransactionStatement(env, RELEASE);
+		}
+	}
+	return env.Undefined();
+}
+
+// Runs one of the cached transaction statements, preparing it if necessary.
+// It's logged just like a Statement would be. Returns false if an exception
+// was thrown.
+bool Database::RunTransactionStatement(Napi::Env env, int which) {
+	sqlite3_stmt*& handle = transaction_handles[which];
+	if (handle == NULL && sqlite3_prepare_v3(db_handle, TRANSACTION_SQL[which], -1, SQLITE_PREPARE_PERSISTENT, &handle, NULL) != SQLITE_OK) {
+		ThrowDatabaseError(env);
+		return false;
+	}
+	const bool was_busy = busy;
+	busy = true;
+	if (Log(env, handle)) {
+		busy = was_busy;
+		ThrowDatabaseError(env);
+		return false;
+	}
+	sqlite3_step(handle);
+	busy = was_busy;
+	if (sqlite3_reset(handle) != SQLITE_OK) {
+		ThrowDatabaseError(env);
+		return false;
+	}
+	return true;
+}
+
+// Enables write batching, where writes made by Statement#run() outside of a
+// transaction are grouped into a single transaction, which is committed after
+// the given number of writes (or by JS_flushWrites()). A limit of zero commits
+// any pending writes and disables batching.
+NODE_METHOD(Database::JS_batchWrites) {
+	UNWRAP_OR_RETURN(Database, db, info.This());
+	REQUIRE_ARGUMENT_INT32(first, int limit);
+	REQUIRE_DATABASE_OPEN(db);
+	REQUIRE_DATABASE_NOT_BUSY(db);
+	UseIsolate;
+	if (limit < 0) return ThrowRangeError(env, "Invalid batch size");
+	if (limit <= db->batch_writes && !db->FlushBatch(env)) return env.Undefined();
+	db->batch_limit = limit;
+	return env.Undefined();
+}
+
+NODE_METHOD(Database::JS_flushWrites) {
+	UNWRAP_OR_RETURN(Database, db, info.This());
+	if (db->open) {
+		REQUIRE_DATABASE_NOT_BUSY(db);
+		db->FlushBatch(info.Env());
+	}
+	return info.Env().Undefined();
+}
+
+// Commits the pending batch of writes, if any. If the commit fails, the batch
+// is rolled back, so that the connection is never left in a transaction that
+// the user didn't start.
+bool Database::FlushBatch(Napi::Env env) {
+	if (!batch_open) return true;
+	batch_open = false;
+	batch_writes = 0;
+	if (RunTransactionStatement(env, COMMIT)) return true;
+	if (!sqlite3_get_autocommit(db_handle)) sqlite3_exec(db_handle, "ROLLBACK", NULL, NULL, NULL);
+	return false;
+}
+
+// Called before Statement#run() steps a statement. Writes outside of any
+// transaction open a new batch, while read-only statements (including
+// transaction control statements like BEGIN) and statements that can't run
+// within a transaction (like VACUUM) first commit the pending batch.
+bool Database::BeginBatchedWrite(Napi::Env env, sqlite3_stmt* handle) {
+	if (batch_limit == 0 && !batch_open) return true;
+	if (sqlite3_stmt_readonly(handle) || IsNonTransactional(handle)) return FlushBatch(env);
+	if (batch_limit == 0 || batch_open || !sqlite3_get_autocommit(db_handle)) return true;
+	if (!RunTransactionStatement(env, BEGIN)) return false;
+	batch_open = true;
+	return true;
+}
+
+// Returns whether the statement fails (or has no effect) within a transaction,
+// judging by its SQL: VACUUM, ATTACH, DETACH, and the pragmas that change the
+// journal mode, auto-vacuum mode, or foreign key enforcement.
+bool Database::IsNonTransactional(sqlite3_stmt* handle) {
+	const char* sql = sqlite3_sql(handle);
+
+	// Skips whitespace and comments, then reads an identifier (quoted or not).
+	auto identifier = [&]() -> std::string_view {
+		for (;;) {
+			while (isspace(static_cast<unsigned char>(*sql))) ++sql;
+			if (sql[0] == '-' && sql[1] == '-') {
+				while (*sql && *sql != '\n') ++sql;
+			} else if (sql[0] == '/' && sql[1] == '*') {
+				const char* end = strstr(sql + 2, "*/");
+				sql = end ? end + 2 : sql + strlen(sql);
+			} else {
+				break;
+			}
+		}
+		const char* start = sql;
+		if (*sql == '"' || *sql == '`' || *sql == '[') {
+			const char close = *sql == '[' ? ']' : *sql;
+			while (*++sql && *sql != close) {}
+			if (!*sql) return std::string_view();
+			return std::string_view(start + 1, sql++ - start - 1);
+		}
+		while (isalnum(static_cast<unsigned char>(*sql)) || *sql == '_' || *sql == '$') ++sql;
+		return std::string_view(start, sql - start);
+	};
+	auto is = [](std::string_view word, const char* expected) {
+		return word.length() == strlen(expected) && sqlite3_strnicmp(word.data(), expected, static_cast<int>(word.length())) == 0;
+	};
+
+	std::string_view word = identifier();
+	if (is(word, "VACUUM") || is(word, "ATTACH") || is(word, "DETACH")) return true;
+	if (!is(word, "PRAGMA")) return false;
+	word = identifier();
+	while (isspace(static_cast<unsigned char>(*sql))) ++sql;
+	if (*sql == '.') {
+		++sql;
+		word = identifier();
+	}
+	return is(word, "journal_mode") || is(word, "auto_vacuum") || is(word, "foreign_keys");
+}
+
+// Called after Statement#run() steps a statement. A failed statement is undone
+// by SQLite without affecting the rest of the batch, unless the error caused
+// SQLite to roll back the whole transaction (e.g., ON CONFLICT ROLLBACK).
+bool Database::EndBatchedWrite(Napi::Env env, bool success) {
+	if (!batch_open) return true;
+	if (sqlite3_get_autocommit(db_handle)) {
+		batch_open = false;
+		batch_writes = 0;
+		return true;
+	}
+	if (success && ++batch_writes >= batch_limit) return FlushBatch(env);
+	return true;
+}
+
+// Reports the current memory-mapped I/O limit of the main database, and how
+// its pages have been read. The counters are null unless the connection was
+// opened through CountingVFS.
+NODE_METHOD(Database::JS_mmapStats) {
+	UNWRAP_OR_RETURN(Database, db, info.This());
+	REQUIRE_DATABASE_OPEN(db);
+	UseIsolate;
+	Addon* addon = db->addon;
+	sqlite3_int64 size = -1;
+	if (sqlite3_file_control(db->db_handle, "main", SQLITE_FCNTL_MMAP_SIZE, &size) != SQLITE_OK) size = 0;
+	CountingVFS::Counters* counters = CountingVFS::GetCounters(db->db_handle);
+	Napi::Object result = Napi::Object::New(env);
+	result.Set(addon->cs.size.Value(), Napi::Number::New(env, static_cast<double>(size)));
+	result.Set(addon->cs.mappedReads.Value(), counters ? Napi::Number::New(env, static_cast<double>(counters->mapped_reads)) : env.Null());
+	result.Set(addon->cs.fileReads.Value(), counters ? Napi::Number::New(env, static_cast<double>(counters->file_reads)) : env.Null());
+	return result;
+}
+
+// Reports which allocator SQLite uses in this process. The counters, which
+// are summed over every thread, are null unless PoolAllocator is installed.
+NODE_METHOD(Database::JS_allocatorStats) {
+	UNWRAP_OR_RETURN(Database, db, info.This());
+	UseIsolate;
+	Addon* addon = db->addon;
+	Napi::Object result = Napi::Object::New(env);
+	if (PoolAllocator::IsInstalled()) {
+		PoolAllocator::Stats stats = PoolAllocator::GetStats();
+		result.Set(addon->cs.allocator.Value(), Napi::String::New(env, "pool"));
+		result.Set(addon->cs.allocations.Value(), Napi::Number::New(env, static_cast<double>(stats.allocations)));
+		result.Set(addon->cs.frees.Value(), Napi::Number::New(env, static_cast<double>(stats.frees)));
+		result.Set(addon->cs.poolHits.Value(), Napi::Number::New(env, static_cast<double>(stats.pool_hits)));
+		result.Set(addon->cs.bytesInUse.Value(), Napi::Number::New(env, static_cast<double>(stats.bytes_in_use)));
+		result.Set(addon->cs.bytesPooled.Value(), Napi::Number::New(env, static_cast<double>(stats.bytes_pooled)));
+	} else {
+		result.Set(addon->cs.allocator.Value(), Napi::String::New(env, "default"));
+		result.Set(addon->cs.allocations.Value(), env.Null());
+		result.Set(addon->cs.frees.Value(), env.Null());
+		result.Set(addon->cs.poolHits.Value(), env.Null());
+		result.Set(addon->cs.bytesInUse.Value(), env.Null());
+		result.Set(addon->cs.bytesPooled.Value(), env.Null());
+	}
+	return result;
+}
+
+// Reports how well this connection's page cache is working. When PageCache is
+// installed, it also reports on the page cache shared by the whole process;
+// otherwise, those properties are null.
+NODE_METHOD(Database::JS_pageCacheStats) {
+	UNWRAP_OR_RETURN(Database, db, info.This());
+	REQUIRE_DATABASE_OPEN(db);
+	UseIsolate;
+	Addon* addon = db->addon;
+	int hits, misses, bytes, highwater;
+	sqlite3_db_status(db->db_handle, SQLITE_DBSTATUS_CACHE_HIT, &hits, &highwater, 0);
+	sqlite3_db_status(db->db_handle, SQLITE_DBSTATUS_CACHE_MISS, &misses, &highwater, 0);
+	sqlite3_db_status(db->db_handle, SQLITE_DBSTATUS_CACHE_USED, &bytes, &highwater, 0);
+	Napi::Object result = Napi::Object::New(env);
+	result.Set(addon->cs.hits.Value(), Napi::Number::New(env, static_cast<double>(hits)));
+	result.Set(addon->cs.misses.Value(), Napi::Number::New(env, static_cast<double>(misses)));
+	result.Set(addon->cs.bytes.Value(), Napi::Number::New(env, static_cast<double>(bytes)));
+	if (PageCache::IsInstalled()) {
+		PageCache::Stats stats = PageCache::GetStats();
+		result.Set(addon->cs.budget.Value(), Napi::Number::New(env, static_cast<double>(stats.budget)));
+		result.Set(addon->cs.totalBytes.Value(), Napi::Number::New(env, static_cast<double>(stats.bytes_in_use)));
+		result.Set(addon->cs.evictions.Value(), Napi::Number::New(env, static_cast<double>(stats.evictions)));
+	} else {
+		result.Set(addon->cs.budget.Value(), env.Null());
+		result.Set(addon->cs.totalBytes.Value(), env.Null());
+		result.Set(addon->cs.evictions.Value(), env.Null());
+	}
+	return result;
+}
+
+NODE_METHOD(Database::JS_timeLimit) {
+	UNWRAP_OR_RETURN(Database, db, info.This());
+	REQUIRE_ARGUMENT_INT32(first, int time_limit);
+	REQUIRE_DATABASE_OPEN(db);
+	REQUIRE_DATABASE_NOT_BUSY(db);
+	db->time_limit = time_limit;
+	if (time_limit > 0) db->EnableProgressHandler();
+	return info.Env().Undefined();
+}
+
+// Adopts the given Int32Array (backed by a SharedArrayBuffer) as the
+// connection's interrupt handle, unless it already has one, and returns the
+// connection's interrupt handle. Any thread that sets its first element to a
+// non-zero value interrupts the statement that's running.
+NODE_METHOD(Database::JS_interruptHandle) {
+	UNWRAP_OR_RETURN(Database, db, info.This());
+	REQUIRE_ARGUMENT_ANY(first, Napi::Value handle);
+	REQUIRE_DATABASE_OPEN(db);
+	if (db->interrupt_flag == NULL) {
+		if (!handle.IsTypedArray() || handle.As<Napi::TypedArray>().TypedArrayType() != napi_int32_array || handle.As<Napi::TypedArray>().ElementLength() < 1) {
+			return ThrowTypeError(info.Env(), "Expected first argument to be an Int32Array");
+		}
+		db->interrupt_handle = Napi::Persistent(handle);
+		db->interrupt_flag = handle.As<Napi::TypedArrayOf<int32_t>>().Data();
+		db->EnableProgressHandler();
+	}
+	return db->interrupt_handle.Value();
+}
+
+// Sets how long SQLite may sleep while waiting for a lock, and returns the
+// previous value. This allows retry() to fail fast, instead of blocking the
+// thread, and then to restore the connection's timeout. The previous value is
+// read from SQLite, since it could have been changed by "PRAGMA busy_timeout".
+NODE_METHOD(Database::JS_busyTimeout) {
+	UNWRAP_OR_RETURN(Database, db, info.This());
+	REQUIRE_ARGUMENT_INT32(first, int timeout);
+	REQUIRE_DATABASE_OPEN(db);
+	REQUIRE_DATABASE_NOT_BUSY(db);
+	sqlite3_stmt* handle;
+	if (sqlite3_prepare_v2(db->db_handle, "PRAGMA busy_timeout", -1, &handle, NULL) != SQLITE_OK) {
+		db->ThrowDatabaseError(info.Env());
+		return info.Env().Undefined();
+	}
+	int previous = sqlite3_step(handle) == SQLITE_ROW ? sqlite3_column_int(handle, 0) : 0;
+	sqlite3_finalize(handle);
+	sqlite3_busy_timeout(db->db_handle, timeout);
+	return Napi::Number::New(info.Env(), previous);
+}
+
+// Replaces the connection's automatic checkpoints with a Checkpointer, which
+// runs checkpoints of the given mode on a background thread.
+NODE_METHOD(Database::JS_startCheckpointer) {
+	UNWRAP_OR_RETURN(Database, db, info.This());
+	REQUIRE_ARGUMENT_INT32(first, int mode);
+	REQUIRE_ARGUMENT_INT32(second, int interval);
+	REQUIRE_ARGUMENT_INT32(third, int wal_limit);
+	REQUIRE_DATABASE_OPEN(db);
+	REQUIRE_DATABASE_NOT_BUSY(db);
+	// A readonly connection never commits, and its checkpoints would need a
+	// connection that can write to the database.
+	if (sqlite3_db_readonly(db->db_handle, "main") == 1) {
+		return ThrowTypeError(info.Env(), "The checkpointer cannot be used with a readonly database");
+	}
+	UseIsolate;
+	delete db->checkpointer;
+	std::string error;
+	int error_code;
+	db->checkpointer = Checkpointer::Start(db->db_handle, mode, interval, wal_limit, error, error_code);
+	if (db->checkpointer == NULL) {
+		ThrowSqliteError(env, db->addon, error.c_str(), error_code);
+	}
+	return env.Undefined();
+}
+
+NODE_METHOD(Database::JS_stopCheckpointer) {
+	UNWRAP_OR_RETURN(Database, db, info.This());
+	REQUIRE_DATABASE_OPEN(db);
+	REQUIRE_DATABASE_NOT_BUSY(db);
+	delete db->checkpointer;
+	db->checkpointer = NULL;
+	return info.Env().Undefined();
+}
+
+// Reports on the connection's Checkpointer, or returns null if it has none.
+NODE_METHOD(Database::JS_checkpointStats) {
+	UNWRAP_OR_RETURN(Database, db, info.This());
+	REQUIRE_DATABASE_OPEN(db);
+	UseIsolate;
+	if (db->checkpointer == NULL) return env.Null();
+	Checkpointer::Stats stats = db->checkpointer->GetStats();
+	Addon* addon = db->addon;
+	Napi::Object result = Napi::Object::New(env);
+	result.Set(addon->cs.walFrames.Value(), Napi::Number::New(env, stats.wal_frames));
+	result.Set(addon->cs.checkpoints.Value(), Napi::Number::New(env, static_cast<double>(stats.checkpoints)));
+	result.Set(addon->cs.incompleteCheckpoints.Value(), Napi::Number::New(env, static_cast<double>(stats.incomplete)));
+	result.Set(addon->cs.lastDuration.Value(), Napi::Number::New(env, stats.last_duration));
+	result.Set(addon->cs.maxDuration.Value(), Napi::Number::New(env, stats.max_duration));
+	return result;
+}
+
+// Starts delivering the connection's committed changes to the given function
+// (see ChangeFeed), or stops if null is given.
+NODE_METHOD(Database::JS_changeHandler) {
+	UNWRAP_OR_RETURN(Database, db, info.This());
+	REQUIRE_ARGUMENT_ANY(first, Napi::Value handler);
+	REQUIRE_DATABASE_OPEN(db);
+	REQUIRE_DATABASE_NOT_BUSY(db);
+	if (db->change_feed != NULL) {
+		db->change_feed->Close();
+		db->change_feed = NULL;
+	}
+	if (handler.IsFunction()) {
+		db->change_feed = ChangeFeed::Create(info.Env(), db->addon, db->db_handle, handler.As<Napi::Function>());
+	}
+	return info.Env().Undefined();
+}
+
+NODE_METHOD(Database::JS_createSession) {
+	REQUIRE_ARGUMENT_OBJECT(first, Napi::Object database);
+	REQUIRE_ARGUMENT_STRING(second, Napi::String attachedName);
+	REQUIRE_ARGUMENT_ANY(third, Napi::Value tables);
+	(void)database;
+	(void)attachedName;
+	(void)tables;
+	UseAddon;
+	UseIsolate;
+	Napi::Function c = addon->Session.Value();
+	addon->privileged_info = &info;
+	Napi::Object session = SafeConstruct(env, c);
+	addon->privileged_info = NULL;
+	if (env.IsExceptionPending()) return env.Undefined();
+	return session;
+}
+
+// Applies a changeset (or patchset) to the database. Conflicts are resolved by
+// the given function, which receives the conflict type, the table name, and
+// the kind of change, and returns one of the SQLITE_CHANGESET_* resolutions.
+NODE_METHOD(Database::JS_applyChangeset) {
+	UNWRAP_OR_RETURN(Database, db, info.This());
+	REQUIRE_ARGUMENT_OBJECT(first, Napi::Object changeset);
+	REQUIRE_ARGUMENT_FUNCTION(second, Napi::Function handler);
+	REQUIRE_DATABASE_OPEN(db);
+	REQUIRE_DATABASE_NOT_BUSY(db);
+	REQUIRE_DATABASE_NO_ITERATORS_UNLESS_UNSAFE(db);
+	if (!changeset.IsBuffer()) return ThrowTypeError(info.Env(), "Expected first argument to be a buffer");
+	UseIsolate;
+	if (!db->FlushBatch(env)) return env.Undefined();
+
+	Napi::Buffer<char> buffer = changeset.As<Napi::Buffer<char>>();
+	if (buffer.Length() > INT_MAX) return ThrowRangeError(env, "The changeset is too large");
+	std::pair<Database*, Napi::Function> context(db, handler);
+	db->busy = true;
+	int status = sqlite3changeset_apply(db->db_handle, static_cast<int>(buffer.Length()), buffer.Data(), NULL, OnChangesetConflict, &context);
+	db->busy = false;
+
+	if (status != SQLITE_OK) {
+		if (db->was_js_error) db->was_js_error = false;
+		else if ((sqlite3_extended_errcode(db->db_handle) & 0xff) == (status & 0xff)) ThrowSqliteError(env, db->addon, db->db_handle);
+		else ThrowSqliteError(env, db->addon, sqlite3_errstr(status), status);
+	}
+	return env.Undefined();
+}
+
+int Database::OnChangesetConflict(void* data, int type, sqlite3_changeset_iter* iter) {
+	auto context = static_cast<std::pair<Database*, Napi::Function>*>(data);
+	Database* db = context->first;
+	Napi::Env env = context->second.Env();
+	Napi::HandleScope scope(env);
+
+	// A foreign key conflict refers to the whole changeset, not one change.
+	napi_value args[3] = { Napi::Number::New(env, type), env.Null(), env.Null() };
+	if (type != SQLITE_CHANGESET_FOREIGN_KEY) {
+		const char* table;
+		int column_count;
+		int op;
+		int indirect;
+		sqlite3changeset_op(iter, &table, &column_count, &op, &indirect);
+		args[1] = StringFromUtf8(env, table, -1);
+		args[2] = Napi::Number::New(env, op);
+	}
+
+	Napi::Value result = SafeCall(env, context->second, env.Undefined(), 3, args);
+	if (env.IsExceptionPending()) {
+		db->was_js_error = true;
+		return SQLITE_CHANGESET_ABORT;
+	}
+	return IsInt32(result) ? result.As<Napi::Number>().Int32Value() : SQLITE_CHANGESET_ABORT;
+}
+
+NODE_METHOD(Database::JS_invertChangeset) {
+	REQUIRE_ARGUMENT_OBJECT(first, Napi::Object changeset);
+	if (!changeset.IsBuffer()) return ThrowTypeError(info.Env(), "Expected first argument to be a buffer");
+	UseAddon;
+	Napi::Buffer<char> buffer = changeset.As<Napi::Buffer<char>>();
+	if (buffer.Length() > INT_MAX) return ThrowRangeError(info.Env(), "The changeset is too large");
+	int length = 0;
+	void* data = NULL;
+	int status = sqlite3changeset_invert(static_cast<int>(buffer.Length()), buffer.Data(), &length, &data);
+	return Session::ToBuffer(info.Env(), addon, status, length, data);
+}
+
+// Combines an array of changesets into one, as if their changes were all
+// recorded by a single session.
+NODE_METHOD(Database::JS_concatChangesets) {
+	REQUIRE_ARGUMENT_OBJECT(first, Napi::Object changesets);
+	if (!changesets.IsArray()) return ThrowTypeError(info.Env(), "Expected first argument to be an array");
+	UseAddon;
+	UseIsolate;
+	Napi::Array array = changesets.As<Napi::Array>();
+	sqlite3_changegroup* group;
+	int status = sqlite3changegroup_new(&group);
+	for (uint32_t i = 0, length = array.Length(); i < length && status == SQLITE_OK; ++i) {
+		Napi::Value changeset = array.Get(i);
+		if (!changeset.IsBuffer()) {
+			sqlite3changegroup_delete(group);
+			return ThrowTypeError(env, "Expected each changeset to be a buffer");
+		}
+		Napi::Buffer<char> buffer = changeset.As<Napi::Buffer<char>>();
+		if (buffer.Length() > INT_MAX) {
+			sqlite3changegroup_delete(group);
+			return ThrowRangeError(env, "The changeset is too large");
+		}
+		status = sqlite3changegroup_add(group, static_cast<int>(buffer.Length()), buffer.Data());
+	}
+	int length = 0;
+	void* data = NULL;
+	if (status == SQLITE_OK) status = sqlite3changegroup_output(group, &length, &data);
+	sqlite3changegroup_delete(group);
+	return Session::ToBuffer(env, addon, status, length, data);
+}
+
 NODE_METHOD(Database::JS_function) {
 	UNWRAP_OR_RETURN(Database, db, info.This());
 	REQUIRE_ARGUMENT_FUNCTION(first, Napi::Function fn);
@@ -400,6 +1413,7 @@ NODE_METHOD(Database::JS_close) {
 	if (db->open) {
 		REQUIRE_DATABASE_NOT_BUSY(db);
 		REQUIRE_DATABASE_NO_ITERATORS(db);
+		if (!db->FlushBatch(info.Env())) return info.Env().Undefined();
 		db->addon->dbs.erase(db);
 		db->CloseHandles();
 	}
@@ -428,5 +1442,5 @@ NODE_GETTER(Database::JS_open) {
 
 NODE_GETTER(Database::JS_inTransaction) {
 	UNWRAP_OR_RETURN(Database, db, info.This());
-	return Napi::Boolean::New(info.Env(), db->open && !static_cast<bool>(sqlite3_get_autocommit(db->db_handle)));
+	return Napi::Boolean::New(info.Env(), db->open && !db->batch_open && !static_cast<bool>(sqlite3_get_autocommit(db->db_handle)));
 }
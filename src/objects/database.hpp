@@ -23,6 +23,11 @@ public:
 			return Backup::Compare(a, b);
 		}
 	};
+	class CompareSession { public:
+		inline bool operator() (Session const * const a, Session const * const b) const {
+			return Session::Compare(a, b);
+		}
+	};
 
 	// Proper error handling logic for when an sqlite3 operation fails.
 	void ThrowDatabaseError(Napi::Env env);
@@ -32,6 +37,43 @@ public:
 	// Allows Statements to log their executed SQL.
 	bool Log(Napi::Env env, sqlite3_stmt* handle);
 
+	// Allows Statement#run() to take part in write batching (see batchWrites()).
+	// Each returns false if an exception was thrown.
+	bool BeginBatchedWrite(Napi::Env env, sqlite3_stmt* handle);
+	bool EndBatchedWrite(Napi::Env env, bool success);
+
+	// Applies the time limit and interrupt handle of the connection while a
+	// Statement runs. A negative time limit means the connection's default.
+	// Nothing else that runs (e.g., committing a batch of writes) is affected.
+	class TimeLimit { public:
+		inline TimeLimit(Database* db, int time_limit) : db(db->has_progress_handler ? db : NULL) {
+			if (this->db != NULL) this->db->StartTimeLimit(time_limit);
+		}
+		inline ~TimeLimit() {
+			if (db != NULL) db->time_limit_active = false;
+		}
+	private:
+		Database* const db;
+	};
+
+	// Installs the progress handler that enforces time limits and interrupts.
+	void EnableProgressHandler();
+
+	// Allows the changes made by a failed statement (or undone by rolling back
+	// to a savepoint) to be withheld from the ChangeFeed. A mark is taken
+	// before the statement runs, and passed back if it fails.
+	struct ChangeMark {
+		sqlite3_uint64 recorded;
+		sqlite3_int64 total_changes;
+	};
+	ChangeMark MarkChanges();
+	void DiscardFailedChanges(const ChangeMark& mark);
+	void DiscardChanges(const ChangeMark& mark);
+
+	// Allows Statements to cache their results (see ResultCache). Returns
+	// false if results can't be cached right now.
+	bool GetDataVersion(ResultCache::Version& version);
+
 	// Allow Statements to manage themselves when created and garbage collected.
 	inline void AddStatement(Statement* stmt) { stmts.insert(stmts.end(), stmt); }
 	inline void RemoveStatement(Statement* stmt) { stmts.erase(stmt); }
@@ -40,6 +82,10 @@ public:
 	inline void AddBackup(Backup* backup) { backups.insert(backups.end(), backup); }
 	inline void RemoveBackup(Backup* backup) { backups.erase(backup); }
 
+	// Allow Sessions to manage themselves when created and garbage collected.
+	inline void AddSession(Session* session) { sessions.insert(sessions.end(), session); }
+	inline void RemoveSession(Session* session) { sessions.erase(session); }
+
 	// A view for Statements to see and modify Database state.
 	// The order of these fields must exactly match their actual order.
 	struct State {
@@ -69,6 +115,26 @@ private:
 	static NODE_METHOD(JS_exec);
 	static NODE_METHOD(JS_backup);
 	static NODE_METHOD(JS_serialize);
+	static NODE_METHOD(JS_importCSV);
+	static NODE_METHOD(JS_insertColumns);
+	static NODE_METHOD(JS_beginTransaction);
+	static NODE_METHOD(JS_endTransaction);
+	static NODE_METHOD(JS_batchWrites);
+	static NODE_METHOD(JS_flushWrites);
+	static NODE_METHOD(JS_mmapStats);
+	static NODE_METHOD(JS_allocatorStats);
+	static NODE_METHOD(JS_pageCacheStats);
+	static NODE_METHOD(JS_timeLimit);
+	static NODE_METHOD(JS_interruptHandle);
+	static NODE_METHOD(JS_busyTimeout);
+	static NODE_METHOD(JS_startCheckpointer);
+	static NODE_METHOD(JS_stopCheckpointer);
+	static NODE_METHOD(JS_checkpointStats);
+	static NODE_METHOD(JS_changeHandler);
+	static NODE_METHOD(JS_createSession);
+	static NODE_METHOD(JS_applyChangeset);
+	static NODE_METHOD(JS_invertChangeset);
+	static NODE_METHOD(JS_concatChangesets);
 	static NODE_METHOD(JS_function);
 	static NODE_METHOD(JS_aggregate);
 	static NODE_METHOD(JS_table);
@@ -80,11 +146,30 @@ private:
 	static NODE_GETTER(JS_inTransaction);
 
 	static bool Deserialize(Napi::Env env, Napi::Object buffer, Addon* addon, sqlite3* db_handle, bool readonly);
+	static std::string GetInsertSQL(const std::string& attached, const std::string& table, const std::vector<std::string>& names, size_t column_count);
+	static int BindColumnValue(Napi::Env env, sqlite3_stmt* handle, int param, Napi::Value column, size_t row);
+	void RollbackImport(bool owns_transaction, const ChangeMark& change_mark);
+	bool RunTransactionStatement(Napi::Env env, int which);
+	bool FlushBatch(Napi::Env env);
+	static bool IsNonTransactional(sqlite3_stmt* handle);
+	void StartTimeLimit(int time_limit);
+	static int OnProgress(void* data);
 	static void FreeSerialization(Napi::Env env, char* data);
+	static int OnChangesetConflict(void* data, int type, sqlite3_changeset_iter* iter);
 
 	static const int MAX_BUFFER_SIZE;
 	static const int MAX_STRING_SIZE;
 
+	// The statements used by transaction functions, which are prepared lazily
+	// and cached for the lifetime of the connection. The first four begin a
+	// transaction with each behavior, in the order used by lib/methods/transaction.js.
+	enum TransactionStatement {
+		BEGIN, BEGIN_DEFERRED, BEGIN_IMMEDIATE, BEGIN_EXCLUSIVE,
+		COMMIT, ROLLBACK, SAVEPOINT, RELEASE, ROLLBACK_TO,
+		TRANSACTION_STATEMENT_COUNT
+	};
+	static const char* const TRANSACTION_SQL[TRANSACTION_STATEMENT_COUNT];
+
 	sqlite3* db_handle;
 	bool open;
 	bool busy;
@@ -97,4 +182,19 @@ private:
 	Napi::Reference<Napi::Value> logger;
 	std::set<Statement*, CompareStatement> stmts;
 	std::set<Backup*, CompareBackup> backups;
+	std::set<Session*, CompareSession> sessions;
+	sqlite3_stmt* transaction_handles[TRANSACTION_STATEMENT_COUNT];
+	sqlite3_stmt* data_version_handle;
+	std::vector<ChangeMark> savepoint_marks;
+	int batch_limit;
+	int batch_writes;
+	bool batch_open;
+	int time_limit;
+	bool has_progress_handler;
+	bool time_limit_active;
+	std::chrono::steady_clock::time_point deadline;
+	int32_t* interrupt_flag;
+	Napi::Reference<Napi::Value> interrupt_handle;
+	Checkpointer* checkpointer;
+	ChangeFeed* change_feed;
 };
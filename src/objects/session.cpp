@@ -0,0 +1,131 @@
+const napi_type_tag Session::TYPE_TAG = RandomTypeTag();
+
+Session::Session(const Napi::CallbackInfo& info) :
+	Napi::ObjectWrap<Session>(info),
+	db(NULL),
+	session_handle(NULL),
+	id(0),
+	alive(false) {
+	TYPE_TAG_CONSTRUCTOR(info);
+	JS_new(info);
+}
+
+Session::~Session() {
+	if (alive) db->RemoveSession(this);
+	CloseHandles();
+}
+
+// Whenever this is used, db->RemoveSession must be invoked beforehand.
+void Session::CloseHandles() {
+	if (alive) {
+		alive = false;
+		sqlite3session_delete(session_handle);
+	}
+}
+
+Napi::Value Session::ToBuffer(Napi::Env env, Addon* addon, int status, int length, void* data) {
+	if (status != SQLITE_OK) {
+		sqlite3_free(data);
+		Database::ThrowSqliteError(env, addon, sqlite3_errstr(status), status);
+		return env.Undefined();
+	}
+	if (data == NULL) return Napi::Buffer<char>::Copy(env, "", 0);
+	return Napi::Buffer<char>::NewOrCopy(env, static_cast<char*>(data), static_cast<size_t>(length), FreeChangeset);
+}
+
+INIT(Session::Init) {
+	return DefineClass(env, "Session", {
+		PrototypeMethod<Session, &Session::JS_changeset>("changeset", addon),
+		PrototypeMethod<Session, &Session::JS_patchset>("patchset", addon),
+		PrototypeMethod<Session, &Session::JS_close>("close", addon),
+	}, addon);
+}
+
+NODE_METHOD(Session::JS_new) {
+	UseAddon;
+	if (!addon->privileged_info) return ThrowTypeError(info.Env(), "Disabled constructor");
+	assert(info.IsConstructCall());
+	const Napi::CallbackInfo& pinfo = *addon->privileged_info;
+	UNWRAP_OR_RETURN(Database, db, pinfo.This());
+	REQUIRE_DATABASE_OPEN(db->GetState());
+	REQUIRE_DATABASE_NOT_BUSY(db->GetState());
+
+	Napi::Object database = pinfo[0].As<Napi::Object>();
+	Napi::String attachedName = pinfo[1].As<Napi::String>();
+	Napi::Value tables = pinfo[2];
+
+	UseIsolate;
+	sqlite3* db_handle = db->GetHandle();
+	std::string attached_name = attachedName.Utf8Value();
+	sqlite3_session* session_handle;
+
+	if (sqlite3session_create(db_handle, attached_name.c_str(), &session_handle) != SQLITE_OK) {
+		Database::ThrowSqliteError(env, addon, db_handle);
+		return env.Undefined();
+	}
+
+	// If no tables are given, every table in the database is recorded,
+	// including tables that are created later.
+	int status = SQLITE_OK;
+	if (tables.IsArray()) {
+		Napi::Array array = tables.As<Napi::Array>();
+		for (uint32_t i = 0, length = array.Length(); i < length && status == SQLITE_OK; ++i) {
+			std::string table = array.Get(i).As<Napi::String>().Utf8Value();
+			status = sqlite3session_attach(session_handle, table.c_str());
+		}
+	} else {
+		status = sqlite3session_attach(session_handle, NULL);
+	}
+	if (status != SQLITE_OK) {
+		sqlite3session_delete(session_handle);
+		Database::ThrowSqliteError(env, addon, sqlite3_errstr(status), status);
+		return env.Undefined();
+	}
+
+	this->db = db;
+	this->session_handle = session_handle;
+	this->id = addon->NextId();
+	this->alive = true;
+	db->AddSession(this);
+
+	SetFrozen(env, info.This().As<Napi::Object>(), addon->cs.database, database);
+
+	return info.This();
+}
+
+// Generating a changeset reads the current contents of each changed row, so
+// the database must not be in the middle of executing a query.
+#define SESSION_OUTPUT(generate)                                               \
+	UNWRAP_OR_RETURN(Session, session, info.This());                           \
+	if (!session->alive)                                                       \
+		return ThrowTypeError(info.Env(), "The session has been closed");      \
+	REQUIRE_DATABASE_OPEN(session->db->GetState());                            \
+	REQUIRE_DATABASE_NOT_BUSY(session->db->GetState());                        \
+	int length = 0;                                                            \
+	void* data = NULL;                                                         \
+	int status = generate(session->session_handle, &length, &data);            \
+	return ToBuffer(info.Env(), session->db->GetAddon(), status, length, data)
+
+NODE_METHOD(Session::JS_changeset) {
+	SESSION_OUTPUT(sqlite3session_changeset);
+}
+
+NODE_METHOD(Session::JS_patchset) {
+	SESSION_OUTPUT(sqlite3session_patchset);
+}
+
+#undef SESSION_OUTPUT
+
+NODE_METHOD(Session::JS_close) {
+	UNWRAP_OR_RETURN(Session, session, info.This());
+	if (session->alive) {
+		REQUIRE_DATABASE_NOT_BUSY(session->db->GetState());
+		session->db->RemoveSession(session);
+	}
+	session->CloseHandles();
+	return info.This();
+}
+
+void Session::FreeChangeset(Napi::Env env, char* data) {
+	sqlite3_free(data);
+}
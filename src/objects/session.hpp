@@ -0,0 +1,36 @@
+class Session : public Napi::ObjectWrap<Session> {
+public:
+
+	explicit Session(const Napi::CallbackInfo& info);
+	~Session();
+
+	// Whenever this is used, db->RemoveSession must be invoked beforehand.
+	void CloseHandles();
+
+	// Used to support ordered containers.
+	static inline bool Compare(Session const * const a, Session const * const b) {
+		return a->id < b->id;
+	}
+
+	// Converts a changeset or patchset that was allocated by SQLite into a
+	// Buffer, or throws an exception if the given status is an error.
+	static Napi::Value ToBuffer(Napi::Env env, Addon* addon, int status, int length, void* data);
+
+	// Identifies objects that are backed by this class (see IsInstanceOf).
+	static const napi_type_tag TYPE_TAG;
+
+	static INIT(Init);
+
+private:
+
+	NODE_METHOD(JS_new);
+	static NODE_METHOD(JS_changeset);
+	static NODE_METHOD(JS_patchset);
+	static NODE_METHOD(JS_close);
+	static void FreeChangeset(Napi::Env env, char* data);
+
+	Database* db;
+	sqlite3_session* session_handle;
+	sqlite3_uint64 id;
+	bool alive;
+};
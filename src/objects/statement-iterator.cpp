@@ -9,7 +9,8 @@ StatementIterator::StatementIterator(const Napi::CallbackInfo& info) :
 	safe_ints(false),
 	mode(Data::FLAT),
 	alive(false),
-	logged(false) {
+	logged(false),
+	change_mark() {
 	TYPE_TAG_CONSTRUCTOR(info);
 	JS_new(info);
 }
@@ -22,6 +23,7 @@ StatementIterator::~StatementIterator() {}
 Napi::Value StatementIterator::Next(Napi::Env env) {
 	assert(alive == true);
 	db_state->busy = true;
+	Database::TimeLimit time_limit(stmt->db, stmt->extras->time_limit);
 	if (!logged) {
 		logged = true;
 		if (stmt->db->Log(env, handle)) {
@@ -41,6 +43,45 @@ Napi::Value StatementIterator::Next(Napi::Env env) {
 	}
 }
 
+// Steps through rows until at least chunk_size bytes of CSV or NDJSON have
+// been written, and returns them as a Buffer. Once there are no more rows,
+// the iterator is finished and the last (possibly empty) chunk is returned.
+Napi::Value StatementIterator::NextChunk(Napi::Env env, bool csv, bool header, size_t chunk_size) {
+	assert(alive == true);
+	db_state->busy = true;
+	Database::TimeLimit time_limit(stmt->db, stmt->extras->time_limit);
+	if (!logged) {
+		logged = true;
+		if (stmt->db->Log(env, handle)) {
+			db_state->busy = false;
+			return Throw(env);
+		}
+	}
+	std::string chunk;
+	chunk.reserve(chunk_size + chunk_size / 4);
+	if (header) CsvWriter::WriteHeader(chunk, handle);
+	JsonWriter& json_writer = stmt->extras->json_writer;
+	int status;
+	while ((status = sqlite3_step(handle)) == SQLITE_ROW) {
+		if (csv) {
+			CsvWriter::WriteRow(chunk, handle, safe_ints);
+		} else {
+			json_writer.WriteRow(chunk, handle, safe_ints, mode);
+			chunk += '\n';
+		}
+		if (chunk.length() >= chunk_size) break;
+	}
+	db_state->busy = false;
+
+	if (status == SQLITE_ROW) {
+		return Napi::Buffer<char>::Copy(env, chunk.data(), chunk.length());
+	} else {
+		if (status != SQLITE_DONE) return Throw(env);
+		Cleanup();
+		STATEMENT_RETURN_LOGIC(Napi::Buffer<char>::Copy(env, chunk.data(), chunk.length()));
+	}
+}
+
 Napi::Value StatementIterator::Return(Napi::Env env) {
 	Cleanup();
 	STATEMENT_RETURN_LOGIC(DoneRecord(env, db_state->addon));
@@ -49,6 +90,7 @@ Napi::Value StatementIterator::Return(Napi::Env env) {
 Napi::Value StatementIterator::Throw(Napi::Env env) {
 	Cleanup();
 	Database* db = stmt->db;
+	db->DiscardFailedChanges(change_mark);
 	STATEMENT_THROW_LOGIC();
 }
 
@@ -84,6 +126,7 @@ NODE_METHOD(StatementIterator::JS_new) {
 		this->mode = stmt->mode;
 		this->alive = true;
 		this->logged = !db_state->has_logger;
+		this->change_mark = db->MarkChanges();
 		assert(stmt != NULL);
 		assert(handle != NULL);
 		assert(stmt->bound == bound);
@@ -107,6 +150,23 @@ NODE_METHOD(StatementIterator::JS_next) {
 	return DoneRecord(info.Env(), iter->db_state->addon);
 }
 
+// This is exported as a plain function (like RowBuffer::JS_read), instead of
+// being a method of StatementIterator, because it's only used internally by
+// Statement#exportTo().
+NODE_METHOD(StatementIterator::JS_readChunk) {
+	if (info.Length() < 1 || !IsInstanceOf<StatementIterator>(info.Env(), info[0])) {
+		return ThrowTypeError(info.Env(), "Expected a statement iterator");
+	}
+	UNWRAP_OR_RETURN(StatementIterator, iter, info[0]);
+	REQUIRE_ARGUMENT_BOOLEAN(second, bool csv);
+	REQUIRE_ARGUMENT_BOOLEAN(third, bool header);
+	REQUIRE_ARGUMENT_INT32(fourth, int chunk_size);
+	REQUIRE_DATABASE_NOT_BUSY(iter->db_state);
+	if (chunk_size <= 0) return ThrowRangeError(info.Env(), "Invalid chunk size");
+	if (iter->alive) return iter->NextChunk(info.Env(), csv, header, static_cast<size_t>(chunk_size));
+	return info.Env().Undefined();
+}
+
 NODE_METHOD(StatementIterator::JS_return) {
 	UNWRAP_OR_RETURN(StatementIterator, iter, info.This());
 	REQUIRE_DATABASE_NOT_BUSY(iter->db_state);
@@ -12,9 +12,13 @@ public:
 
 	static INIT(Init);
 
+	// Reads the next chunk of CSV or NDJSON from an iterator (see NextChunk()).
+	static NODE_METHOD(JS_readChunk);
+
 private:
 
 	Napi::Value Next(Napi::Env env);
+	Napi::Value NextChunk(Napi::Env env, bool csv, bool header, size_t chunk_size);
 	Napi::Value Return(Napi::Env env);
 	Napi::Value Throw(Napi::Env env);
 	void Cleanup();
@@ -68,4 +72,5 @@ private:
 	char mode;
 	bool alive;
 	bool logged;
+	Database::ChangeMark change_mark;
 };
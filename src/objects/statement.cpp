@@ -48,14 +48,44 @@ RowBuilder& Statement::GetRowBuilder() {
 	return extras->row_builder;
 }
 
+// Returns the Statement's string cache, or NULL if it has nothing to do.
+StringCache* Statement::GetStringCache() {
+	return extras->string_cache.IsEnabled() ? &extras->string_cache : NULL;
+}
+
+// Returns the addon that the Statement's Database belongs to.
+Addon* Statement::GetAddon() {
+	return db->GetAddon();
+}
+
+// Returns the string that bound parameters should be recorded in, or NULL
+// if the Statement's results aren't cached (see ResultCache).
+std::string* Statement::StartResultCacheKey() {
+	return extras->result_cache.StartKey();
+}
+
+// Returns the Statement's result cache, or NULL if results shouldn't be cached
+// right now. Lazy rows decode themselves on access, so they're never cached.
+ResultCache* Statement::GetResultCache(ResultCache::Version& version) {
+	if (!extras->result_cache.IsEnabled() || mode == Data::LAZY) return NULL;
+	if (!db->GetDataVersion(version)) return NULL;
+	return &extras->result_cache;
+}
+
 Statement::Extras::Extras(
 	Napi::Env env,
 	Napi::Function row_factory,
 	Napi::Function array_factory,
+	Napi::Function lazy_row_factory,
+	Napi::Function expanded_row_factory,
 	sqlite3_uint64 id
 ) :
 	bind_map(0),
-	row_builder(env, row_factory, array_factory),
+	row_builder(env, row_factory, array_factory, lazy_row_factory, expanded_row_factory),
+	string_cache(),
+	json_writer(),
+	result_cache(),
+	time_limit(-1),
 	id(id) {}
 
 INIT(Statement::Init) {
@@ -64,11 +94,21 @@ INIT(Statement::Init) {
 		PrototypeMethod<Statement, &Statement::JS_get>("get", addon),
 		PrototypeMethod<Statement, &Statement::JS_all>("all", addon),
 		PrototypeMethod<Statement, &Statement::JS_iterate>("iterate", addon),
+		PrototypeMethod<Statement, &Statement::JS_json>("json", addon),
+		PrototypeMethod<Statement, &Statement::JS_ndjson>("ndjson", addon),
+		PrototypeMethod<Statement, &Statement::JS_arrow>("arrow", addon),
+		PrototypeMethod<Statement, &Statement::JS_exportTo>("exportTo", addon),
 		PrototypeMethod<Statement, &Statement::JS_bind>("bind", addon),
 		PrototypeMethod<Statement, &Statement::JS_pluck>("pluck", addon),
 		PrototypeMethod<Statement, &Statement::JS_expand>("expand", addon),
 		PrototypeMethod<Statement, &Statement::JS_raw>("raw", addon),
+		PrototypeMethod<Statement, &Statement::JS_lazy>("lazy", addon),
 		PrototypeMethod<Statement, &Statement::JS_safeIntegers>("safeIntegers", addon),
+		PrototypeMethod<Statement, &Statement::JS_timeLimit>("timeLimit", addon),
+		PrototypeMethod<Statement, &Statement::JS_cache>("cache", addon),
+		PrototypeMethod<Statement, &Statement::JS_compile>("compile", addon),
+		PrototypeMethod<Statement, &Statement::JS_internStrings>("internStrings", addon),
+		PrototypeMethod<Statement, &Statement::JS_externalStrings>("externalStrings", addon),
 		PrototypeMethod<Statement, &Statement::JS_columns>("columns", addon),
 		PrototypeMethod<Statement, &Statement::JS_toString>("toString", addon),
 	}, addon);
@@ -142,7 +182,7 @@ NODE_METHOD(Statement::JS_new) {
 	bool returns_data = sqlite3_column_count(handle) >= 1 || pragmaMode;
 	this->db = db;
 	this->handle = handle;
-	this->extras = new Extras(env, addon->RowFactory.Value(), addon->ArrayFactory.Value(), addon->NextId());
+	this->extras = new Extras(env, addon->RowFactory.Value(), addon->ArrayFactory.Value(), addon->LazyRowFactory.Value(), addon->ExpandedRowFactory.Value(), addon->NextId());
 	this->bound = explainMode;
 	this->safe_ints = db->GetState()->safe_ints;
 	this->returns_data = returns_data;
@@ -162,15 +202,40 @@ NODE_METHOD(Statement::JS_new) {
 }
 
 NODE_METHOD(Statement::JS_run) {
-	STATEMENT_START(ALLOW_ANY_STATEMENT, DOES_MUTATE);
+	UNWRAP_OR_RETURN(Statement, stmt, info.This());
+	return Run(info, stmt);
+}
+
+Napi::Value Statement::Run(const Napi::CallbackInfo& info, Statement* stmt) {
+	// This is STATEMENT_ENTER(), except that a batch of writes might need to
+	// be started or committed before the statement is logged and executed.
+	STATEMENT_ENTER_LOGIC(ALLOW_ANY_STATEMENT, DOES_MUTATE);
+	UseIsolate;
+	if (!db->BeginBatchedWrite(env, handle)) {
+		if (!bound) { sqlite3_clear_bindings(handle); }
+		return env.Undefined();
+	}
+	db->GetState()->busy = true;
+	const Database::ChangeMark _change_mark = db->MarkChanges();
+	if (db->Log(env, handle)) {
+		STATEMENT_THROW();
+	}
 	sqlite3* db_handle = db->GetHandle();
 	int total_changes_before = sqlite3_total_changes(db_handle);
 
-	sqlite3_step(handle);
+	{
+		Database::TimeLimit time_limit(db, stmt->extras->time_limit);
+		sqlite3_step(handle);
+	}
 	if (sqlite3_reset(handle) == SQLITE_OK) {
 		int changes = sqlite3_total_changes(db_handle) == total_changes_before ? 0 : sqlite3_changes(db_handle);
 		sqlite3_int64 id = sqlite3_last_insert_rowid(db_handle);
 		Addon* addon = db->GetAddon();
+		if (!db->EndBatchedWrite(env, true)) {
+			db->GetState()->busy = false;
+			if (!bound) { sqlite3_clear_bindings(handle); }
+			return env.Undefined();
+		}
 
 		napi_property_descriptor properties[2] = {};
 		properties[0].name = addon->cs.changes.Value();
@@ -191,18 +256,33 @@ NODE_METHOD(Statement::JS_run) {
 		assert(status == napi_ok || status == napi_cannot_run_js); ((void)status);
 		STATEMENT_RETURN(Napi::Object(env, result));
 	}
+	db->EndBatchedWrite(env, false);
 	STATEMENT_THROW();
 }
 
 NODE_METHOD(Statement::JS_get) {
-	STATEMENT_START(REQUIRE_STATEMENT_RETURNS_DATA, DOES_NOT_MUTATE);
+	UNWRAP_OR_RETURN(Statement, stmt, info.This());
+	return Get(info, stmt);
+}
+
+Napi::Value Statement::Get(const Napi::CallbackInfo& info, Statement* stmt) {
+	STATEMENT_ENTER(REQUIRE_STATEMENT_RETURNS_DATA, DOES_NOT_MUTATE);
+	ResultCache::Version version;
+	ResultCache* cache = stmt->GetResultCache(version);
+	Napi::Value cached;
+	if (cache != NULL && cache->Get(env, version, ResultCache::GET, stmt->mode, stmt->safe_ints, cached)) {
+		STATEMENT_RETURN(cached);
+	}
 	int status = sqlite3_step(handle);
 	if (status == SQLITE_ROW) {
 		Napi::Value result = Data::GetRowJS(env, stmt, handle, stmt->safe_ints, stmt->mode);
-		sqlite3_reset(handle);
+		if (sqlite3_reset(handle) == SQLITE_OK && cache != NULL) {
+			cache->Set(env, result, ResultCache::GET, stmt->mode == Data::EXPAND);
+		}
 		STATEMENT_RETURN(result);
 	} else if (status == SQLITE_DONE) {
 		sqlite3_reset(handle);
+		if (cache != NULL) cache->Set(env, env.Undefined(), ResultCache::GET, false);
 		STATEMENT_RETURN(env.Undefined());
 	}
 	sqlite3_reset(handle);
@@ -213,6 +293,30 @@ NODE_METHOD(Statement::JS_all) {
 	STATEMENT_START(REQUIRE_STATEMENT_RETURNS_DATA, DOES_NOT_MUTATE);
 	const bool safe_ints = stmt->safe_ints;
 	const char mode = stmt->mode;
+	ResultCache::Version version;
+	ResultCache* cache = stmt->GetResultCache(version);
+	Napi::Value cached;
+	if (cache != NULL && cache->Get(env, version, ResultCache::ALL, mode, safe_ints, cached)) {
+		STATEMENT_RETURN(cached);
+	}
+
+	if (mode == Data::LAZY) {
+		RowBuffer* buffer = new RowBuffer(sqlite3_column_count(handle), safe_ints);
+		while (sqlite3_step(handle) == SQLITE_ROW) {
+			buffer->AppendRow(handle);
+		}
+		if (sqlite3_reset(handle) == SQLITE_OK) {
+			Napi::Value result = stmt->GetRowBuilder().GetLazyRowsJS(env, handle, buffer);
+			if (env.IsExceptionPending()) {
+				db->GetState()->was_js_error = true;
+			} else {
+				STATEMENT_RETURN(result);
+			}
+		} else {
+			delete buffer;
+		}
+		STATEMENT_THROW();
+	}
 
 	std::vector<napi_value> rows;
 	rows.reserve(8);
@@ -229,6 +333,9 @@ NODE_METHOD(Statement::JS_all) {
 			Addon* addon = db->GetAddon();
 			assert(!addon->ArrayFactory.IsEmpty());
 			assert(!addon->ArrayAppender.IsEmpty());
+			// Passing rows to JavaScript in batches is much faster than
+			// napi_set_element for all but the smallest results (see
+			// benchmark/materialize).
 			static const size_t batch_size = 1024;
 			size_t first_batch_size = std::min(rows.size(), batch_size);
 			Napi::Value result = SafeCall(env, addon->ArrayFactory.Value(), env.Undefined(), first_batch_size, rows.data());
@@ -245,6 +352,7 @@ NODE_METHOD(Statement::JS_all) {
 			if (env.IsExceptionPending()) {
 				db->GetState()->was_js_error = true;
 			} else {
+				if (cache != NULL) cache->Set(env, result, ResultCache::ALL, mode == Data::EXPAND);
 				STATEMENT_RETURN(result);
 			}
 		}
@@ -263,13 +371,103 @@ NODE_METHOD(Statement::JS_iterate) {
 	return iterator;
 }
 
+NODE_METHOD(Statement::JS_json) {
+	return GetJSON(info, false);
+}
+
+NODE_METHOD(Statement::JS_ndjson) {
+	return GetJSON(info, true);
+}
+
+Napi::Value Statement::GetJSON(const Napi::CallbackInfo& info, bool newline_delimited) {
+	STATEMENT_START(REQUIRE_STATEMENT_RETURNS_DATA, DOES_NOT_MUTATE);
+	std::string json;
+	stmt->extras->json_writer.WriteRows(json, handle, stmt->safe_ints, stmt->mode, newline_delimited);
+
+	if (sqlite3_reset(handle) == SQLITE_OK) {
+		if (json.length() > static_cast<size_t>(INT_MAX)) {
+			ThrowRangeError(env, "String overflow (too much data returned)");
+			db->GetState()->was_js_error = true;
+		} else {
+			Napi::Value result = StringFromUtf8(env, json.data(), static_cast<int>(json.length()));
+			if (env.IsExceptionPending()) {
+				db->GetState()->was_js_error = true;
+			} else {
+				STATEMENT_RETURN(result);
+			}
+		}
+	}
+	STATEMENT_THROW();
+}
+
+// Bind parameters are accepted like in all(). If the last argument is an
+// object with a "batchSize" property, it's used as options instead.
+NODE_METHOD(Statement::JS_arrow) {
+	UNWRAP_OR_RETURN(Statement, stmt, info.This());
+	int batch_size = 65536;
+	int argc = info.Length();
+	if (argc > 0 && info[argc - 1].IsObject()) {
+		Napi::Env env = info.Env();
+		Napi::Object options = info[argc - 1].As<Napi::Object>();
+		napi_value key = stmt->GetAddon()->cs.batchSize.Value();
+		bool has_batch_size;
+		if (!SafeHasOwnProperty(env, options, key, &has_batch_size)) return env.Undefined();
+		if (has_batch_size) {
+			Napi::Value value = SafeGet(env, options, key);
+			if (value.IsEmpty()) return env.Undefined();
+			if (!IsInt32(value)) return ThrowTypeError(env, "Expected the \"batchSize\" option to be a 32-bit signed integer");
+			batch_size = value.As<Napi::Number>().Int32Value();
+			if (batch_size <= 0) return ThrowRangeError(env, "Expected the \"batchSize\" option to be a positive integer");
+			argc -= 1;
+		}
+	}
+	STATEMENT_ENTER_ARGS(REQUIRE_STATEMENT_RETURNS_DATA, DOES_NOT_MUTATE, argc);
+
+	ArrowWriter writer(handle);
+	while (sqlite3_step(handle) == SQLITE_ROW) {
+		writer.AppendRow(handle);
+	}
+
+	if (sqlite3_reset(handle) == SQLITE_OK) {
+		std::string* data = new std::string();
+		const char* error = writer.Write(*data, static_cast<size_t>(batch_size));
+		if (error != NULL) {
+			delete data;
+			ThrowRangeError(env, error);
+			db->GetState()->was_js_error = true;
+		} else {
+			Napi::Value result = Napi::Buffer<char>::NewOrCopy(env, &(*data)[0], data->length(), FreeArrowData, data);
+			if (env.IsExceptionPending()) {
+				db->GetState()->was_js_error = true;
+			} else {
+				STATEMENT_RETURN(result);
+			}
+		}
+	}
+	STATEMENT_THROW();
+}
+
+void Statement::FreeArrowData(Napi::Env env, char* data, std::string* hint) {
+	delete hint;
+}
+
+// Exports are driven by JavaScript (lib/methods/export-to.js), which waits for
+// the destination stream while reading rows through StatementIterator chunks.
+NODE_METHOD(Statement::JS_exportTo) {
+	UNWRAP_OR_RETURN(Statement, stmt, info.This());
+	std::vector<napi_value> args(info.Length());
+	for (size_t i = 0; i < args.size(); ++i) args[i] = info[i];
+	Napi::Value result = SafeCall(info.Env(), stmt->GetAddon()->ExportTo.Value(), info.This(), args.size(), args.data());
+	return result.IsEmpty() ? info.Env().Undefined() : result;
+}
+
 NODE_METHOD(Statement::JS_bind) {
 	UNWRAP_OR_RETURN(Statement, stmt, info.This());
 	if (stmt->bound) return ThrowTypeError(info.Env(), "The bind() method can only be invoked once per statement object");
 	REQUIRE_DATABASE_OPEN(stmt->db->GetState());
 	REQUIRE_DATABASE_NOT_BUSY(stmt->db->GetState());
 	REQUIRE_STATEMENT_NOT_LOCKED(stmt);
-	STATEMENT_BIND(stmt->handle);
+	STATEMENT_BIND(stmt->handle, info.Length());
 	stmt->bound = true;
 	return info.This();
 }
@@ -307,6 +505,17 @@ NODE_METHOD(Statement::JS_raw) {
 	return info.This();
 }
 
+NODE_METHOD(Statement::JS_lazy) {
+	UNWRAP_OR_RETURN(Statement, stmt, info.This());
+	if (!stmt->returns_data) return ThrowTypeError(info.Env(), "The lazy() method is only for statements that return data");
+	REQUIRE_DATABASE_NOT_BUSY(stmt->db->GetState());
+	REQUIRE_STATEMENT_NOT_LOCKED(stmt);
+	bool use = true;
+	if (info.Length() != 0) { REQUIRE_ARGUMENT_BOOLEAN(first, use); }
+	stmt->mode = use ? Data::LAZY : stmt->mode == Data::LAZY ? Data::FLAT : stmt->mode;
+	return info.This();
+}
+
 NODE_METHOD(Statement::JS_safeIntegers) {
 	UNWRAP_OR_RETURN(Statement, stmt, info.This());
 	REQUIRE_DATABASE_NOT_BUSY(stmt->db->GetState());
@@ -316,6 +525,80 @@ NODE_METHOD(Statement::JS_safeIntegers) {
 	return info.This();
 }
 
+// Sets the number of milliseconds that this statement may run for, or 0 for
+// no limit. With no argument (or null), the database's time limit is used.
+NODE_METHOD(Statement::JS_timeLimit) {
+	UNWRAP_OR_RETURN(Statement, stmt, info.This());
+	REQUIRE_DATABASE_NOT_BUSY(stmt->db->GetState());
+	REQUIRE_STATEMENT_NOT_LOCKED(stmt);
+	int time_limit = -1;
+	if (info.Length() != 0 && !info[0].IsNull() && !info[0].IsUndefined()) {
+		REQUIRE_ARGUMENT_INT32(first, time_limit);
+		if (time_limit < 0) return ThrowRangeError(info.Env(), "Expected the time limit to be a non-negative integer");
+	}
+	stmt->extras->time_limit = time_limit;
+	if (time_limit > 0) stmt->db->EnableProgressHandler();
+	return info.This();
+}
+
+// Caches the results of get() and all() by their bound parameters, until the
+// database changes. Only read-only statements can be cached.
+NODE_METHOD(Statement::JS_cache) {
+	UNWRAP_OR_RETURN(Statement, stmt, info.This());
+	if (!stmt->returns_data || (stmt->alive && !sqlite3_stmt_readonly(stmt->handle))) return ThrowTypeError(info.Env(), "The cache() method is only for read-only statements that return data");
+	REQUIRE_DATABASE_NOT_BUSY(stmt->db->GetState());
+	REQUIRE_STATEMENT_NOT_LOCKED(stmt);
+	bool use = true;
+	if (info.Length() != 0) { REQUIRE_ARGUMENT_BOOLEAN(first, use); }
+	stmt->extras->result_cache.SetEnabled(use);
+	return info.This();
+}
+
+// Returns a function that does the same as get() (or run(), for statements
+// that don't return data), but which has the Statement as its callback data,
+// so the receiver doesn't need to be validated and unwrapped on every call.
+NODE_METHOD(Statement::JS_compile) {
+	UNWRAP_OR_RETURN(Statement, stmt, info.This());
+	UseIsolate;
+	napi_value function;
+	napi_status status = stmt->returns_data
+		? napi_create_function(env, "get", NAPI_AUTO_LENGTH, CompiledCallback<Get>, stmt, &function)
+		: napi_create_function(env, "run", NAPI_AUTO_LENGTH, CompiledCallback<Run>, stmt, &function);
+	if (status != napi_ok) return env.Undefined();
+	// The function keeps the Statement alive, since it only has a raw pointer.
+	Napi::Object result(env, function);
+	SetFrozen(env, result, stmt->db->GetAddon()->cs.statement, info.This());
+	return result;
+}
+
+template <Napi::Value (*method)(const Napi::CallbackInfo&, Statement*)>
+napi_value Statement::CompiledCallback(napi_env env, napi_callback_info info) {
+	Napi::CallbackInfo cbinfo(env, info);
+	return method(cbinfo, static_cast<Statement*>(cbinfo.Data()));
+}
+
+NODE_METHOD(Statement::JS_internStrings) {
+	UNWRAP_OR_RETURN(Statement, stmt, info.This());
+	if (!stmt->returns_data) return ThrowTypeError(info.Env(), "The internStrings() method is only for statements that return data");
+	REQUIRE_DATABASE_NOT_BUSY(stmt->db->GetState());
+	REQUIRE_STATEMENT_NOT_LOCKED(stmt);
+	bool use = true;
+	if (info.Length() != 0) { REQUIRE_ARGUMENT_BOOLEAN(first, use); }
+	stmt->extras->string_cache.SetInterning(use);
+	return info.This();
+}
+
+NODE_METHOD(Statement::JS_externalStrings) {
+	UNWRAP_OR_RETURN(Statement, stmt, info.This());
+	if (!stmt->returns_data) return ThrowTypeError(info.Env(), "The externalStrings() method is only for statements that return data");
+	REQUIRE_DATABASE_NOT_BUSY(stmt->db->GetState());
+	REQUIRE_STATEMENT_NOT_LOCKED(stmt);
+	bool use = true;
+	if (info.Length() != 0) { REQUIRE_ARGUMENT_BOOLEAN(first, use); }
+	stmt->extras->string_cache.SetExternalizing(use);
+	return info.This();
+}
+
 NODE_METHOD(Statement::JS_columns) {
 	UNWRAP_OR_RETURN(Statement, stmt, info.This());
 	if (!stmt->returns_data) return ThrowTypeError(info.Env(), "The columns() method is only for statements that return data");
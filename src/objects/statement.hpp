@@ -18,6 +18,16 @@ public:
 	// Returns the Statement's row builder.
 	RowBuilder& GetRowBuilder();
 
+	// Returns the Statement's string cache, or NULL if it has nothing to do.
+	StringCache* GetStringCache();
+
+	// Returns the string that bound parameters should be recorded in, or NULL
+	// if the Statement's results aren't cached (see ResultCache).
+	std::string* StartResultCacheKey();
+
+	// Returns the addon that the Statement's Database belongs to.
+	Addon* GetAddon();
+
 	// Identifies objects that are backed by this class (see IsInstanceOf).
 	static const napi_type_tag TYPE_TAG;
 
@@ -31,23 +41,46 @@ private:
 			Napi::Env env,
 			Napi::Function row_factory,
 			Napi::Function array_Factory,
+			Napi::Function lazy_row_factory,
+			Napi::Function expanded_row_factory,
 			sqlite3_uint64 id
 		);
 		BindMap bind_map;
 		RowBuilder row_builder;
+		StringCache string_cache;
+		JsonWriter json_writer;
+		ResultCache result_cache;
+		int time_limit;
 		const sqlite3_uint64 id;
 	};
 
 	NODE_METHOD(JS_new);
+	static Napi::Value GetJSON(const Napi::CallbackInfo& info, bool newline_delimited);
+	static Napi::Value Run(const Napi::CallbackInfo& info, Statement* stmt);
+	static Napi::Value Get(const Napi::CallbackInfo& info, Statement* stmt);
+	template <Napi::Value (*method)(const Napi::CallbackInfo&, Statement*)>
+	static napi_value CompiledCallback(napi_env env, napi_callback_info info);
+	static void FreeArrowData(Napi::Env env, char* data, std::string* hint);
+	ResultCache* GetResultCache(ResultCache::Version& version);
 	static NODE_METHOD(JS_run);
 	static NODE_METHOD(JS_get);
 	static NODE_METHOD(JS_all);
 	static NODE_METHOD(JS_iterate);
+	static NODE_METHOD(JS_json);
+	static NODE_METHOD(JS_ndjson);
+	static NODE_METHOD(JS_arrow);
+	static NODE_METHOD(JS_exportTo);
 	static NODE_METHOD(JS_bind);
 	static NODE_METHOD(JS_pluck);
 	static NODE_METHOD(JS_expand);
 	static NODE_METHOD(JS_raw);
+	static NODE_METHOD(JS_lazy);
 	static NODE_METHOD(JS_safeIntegers);
+	static NODE_METHOD(JS_timeLimit);
+	static NODE_METHOD(JS_cache);
+	static NODE_METHOD(JS_compile);
+	static NODE_METHOD(JS_internStrings);
+	static NODE_METHOD(JS_externalStrings);
 	static NODE_METHOD(JS_columns);
 	static NODE_METHOD(JS_toString);
 	static NODE_GETTER(JS_busy);
@@ -0,0 +1,407 @@
+// Reads record batches from a buffer in the Apache Arrow IPC streaming format,
+// and binds values directly out of the column buffers. Only flat columns of
+// the following types are supported: Null, Int (of any width), FloatingPoint
+// (single or double precision), Bool, Utf8, Binary, LargeUtf8, and
+// LargeBinary. Dictionary-encoded and compressed batches are not supported.
+// The input is untrusted, so every offset and length is validated before it's
+// used, and values are read byte by byte, so they don't need to be aligned.
+class ArrowReader {
+public:
+
+	explicit ArrowReader(const char* data, size_t length) :
+		data(reinterpret_cast<const unsigned char*>(data)),
+		length(length),
+		position(0),
+		metadata(NULL, 0),
+		header(0),
+		body(NULL),
+		body_length(0),
+		row_count(0),
+		columns(),
+		error(NULL) {}
+
+	// Reads the schema, which must be the first message in the stream.
+	bool ReadSchema() {
+		if (NextMessage() != HEADER_SCHEMA) return Fail("Expected the Arrow stream to start with a schema");
+		FlatReader::Table schema = metadata.GetTable(header);
+		if (metadata.GetScalar(schema, 0, 2, 0) != 0) return Fail("Big-endian Arrow data is not supported");
+		size_t count;
+		size_t fields = metadata.GetVector(schema, 1, 4, &count);
+		if (count == 0 && metadata.valid) return Fail("The Arrow schema has no fields");
+		for (size_t i = 0; i < count && metadata.valid; ++i) {
+			FlatReader::Table field = metadata.GetTable(metadata.Deref(fields + 4 * i));
+			Column column = {};
+			column.name = metadata.GetString(metadata.GetOffsetField(field, 0));
+			if (metadata.GetField(field, 4)) return Fail("Dictionary-encoded Arrow data is not supported");
+			FlatReader::Table type = metadata.GetTable(metadata.GetOffsetField(field, 3));
+			switch (metadata.GetScalar(field, 2, 1, 0)) {
+				case TYPE_NULL:
+					column.type = NUL;
+					break;
+				case TYPE_INT:
+					column.type = INTEGER;
+					column.width = static_cast<size_t>(metadata.GetScalar(type, 0, 4, 0)) / 8;
+					column.is_signed = metadata.GetScalar(type, 1, 1, 0) != 0;
+					if (column.width != 1 && column.width != 2 && column.width != 4 && column.width != 8) {
+						return Fail("Unsupported Arrow integer width");
+					}
+					break;
+				case TYPE_FLOATING_POINT: {
+					uint64_t precision = metadata.GetScalar(type, 0, 2, 0);
+					if (precision != 1 && precision != 2) return Fail("Unsupported Arrow floating point precision");
+					column.type = REAL;
+					column.width = precision == 1 ? 4 : 8;
+					break;
+				}
+				case TYPE_BOOL:
+					column.type = BOOL;
+					break;
+				case TYPE_BINARY:
+				case TYPE_LARGE_BINARY:
+					column.type = BLOB;
+					column.width = metadata.GetScalar(field, 2, 1, 0) == TYPE_BINARY ? 4 : 8;
+					break;
+				case TYPE_UTF8:
+				case TYPE_LARGE_UTF8:
+					column.type = TEXT;
+					column.width = metadata.GetScalar(field, 2, 1, 0) == TYPE_UTF8 ? 4 : 8;
+					break;
+				default:
+					if (metadata.valid) return Fail("Unsupported Arrow data type");
+			}
+			columns.push_back(column);
+		}
+		if (!metadata.valid) return Fail("Invalid Arrow schema");
+		return true;
+	}
+
+	// Reads the next record batch. Returns false at the end of the stream, or
+	// if an error occurred (in which case GetError() returns non-NULL).
+	bool NextBatch() {
+		int header_type = NextMessage();
+		if (header_type <= 0) return false;
+		if (header_type == HEADER_DICTIONARY_BATCH) return Fail("Dictionary-encoded Arrow data is not supported");
+		if (header_type != HEADER_RECORD_BATCH) return Fail("Unexpected Arrow message");
+
+		FlatReader::Table batch = metadata.GetTable(header);
+		row_count = metadata.GetScalar(batch, 0, 8, 0);
+		if (metadata.GetField(batch, 3)) return Fail("Compressed Arrow data is not supported");
+		size_t node_count;
+		size_t buffer_count;
+		size_t nodes = metadata.GetVector(batch, 1, 16, &node_count);
+		size_t buffers = metadata.GetVector(batch, 2, 16, &buffer_count);
+		if (!metadata.valid || row_count > static_cast<uint64_t>(INT64_MAX / 8) || node_count != columns.size()) {
+			return Fail("Invalid Arrow record batch");
+		}
+
+		size_t buffer_index = 0;
+		for (size_t i = 0; i < columns.size(); ++i) {
+			Column& column = columns[i];
+			uint64_t node_length = metadata.Read(nodes + 16 * i, 8);
+			uint64_t null_count = metadata.Read(nodes + 16 * i + 8, 8);
+			if (node_length != row_count) return Fail("Invalid Arrow record batch");
+			column.validity = NULL;
+			column.values = NULL;
+			column.offsets = NULL;
+			column.values_length = 0;
+			if (column.type == NUL) continue;
+
+			size_t buffer_length;
+			const unsigned char* validity = GetBuffer(buffers, buffer_count, buffer_index++, &buffer_length);
+			if (null_count > 0) {
+				if (validity == NULL || buffer_length < (row_count + 7) / 8) return Fail("Invalid Arrow validity buffer");
+				column.validity = validity;
+			}
+			if (column.type == TEXT || column.type == BLOB) {
+				column.offsets = GetBuffer(buffers, buffer_count, buffer_index++, &buffer_length);
+				if (row_count > 0 && buffer_length / column.width <= row_count) return Fail("Invalid Arrow offsets buffer");
+			}
+			column.values = GetBuffer(buffers, buffer_count, buffer_index++, &column.values_length);
+			uint64_t minimum_length = column.type == BOOL ? (row_count + 7) / 8
+				: column.type == INTEGER || column.type == REAL ? row_count * column.width : 0;
+			if (column.values_length < minimum_length) return Fail("Invalid Arrow values buffer");
+		}
+		if (!metadata.valid || error != NULL) return Fail("Invalid Arrow record batch");
+		return true;
+	}
+
+	inline size_t GetColumnCount() { return columns.size(); }
+	inline const std::string& GetColumnName(size_t index) { return columns[index].name; }
+	inline size_t GetRowCount() { return static_cast<size_t>(row_count); }
+	inline const char* GetError() { return error; }
+
+	// Binds a value of the current record batch to the given parameter. If the
+	// value can't be represented in SQLite, SQLITE_RANGE is returned and an
+	// error is set.
+	int BindValue(sqlite3_stmt* handle, int param, size_t column_index, size_t row) {
+		const Column& column = columns[column_index];
+		if (column.type == NUL || (column.validity && !((column.validity[row / 8] >> (row % 8)) & 1))) {
+			return sqlite3_bind_null(handle, param);
+		}
+		switch (column.type) {
+			case INTEGER: {
+				uint64_t value = ReadUnsigned(column.values + row * column.width, column.width);
+				if (column.is_signed) {
+					if (column.width < 8 && (value >> (column.width * 8 - 1))) value |= ~uint64_t(0) << (column.width * 8);
+				} else if (value > static_cast<uint64_t>(INT64_MAX)) {
+					error = "An unsigned 64-bit integer is too large to be stored in SQLite";
+					return SQLITE_RANGE;
+				}
+				return sqlite3_bind_int64(handle, param, static_cast<sqlite3_int64>(value));
+			}
+			case REAL: {
+				uint64_t bits = ReadUnsigned(column.values + row * column.width, column.width);
+				if (column.width == 4) {
+					uint32_t bits32 = static_cast<uint32_t>(bits);
+					float value;
+					memcpy(&value, &bits32, 4);
+					return sqlite3_bind_double(handle, param, value);
+				}
+				double value;
+				memcpy(&value, &bits, 8);
+				return sqlite3_bind_double(handle, param, value);
+			}
+			case BOOL:
+				return sqlite3_bind_int(handle, param, (column.values[row / 8] >> (row % 8)) & 1);
+			default: {
+				uint64_t start = ReadUnsigned(column.offsets + row * column.width, column.width);
+				uint64_t end = ReadUnsigned(column.offsets + (row + 1) * column.width, column.width);
+				if (start > end || end > column.values_length) {
+					error = "Invalid Arrow offsets buffer";
+					return SQLITE_RANGE;
+				}
+				// A NULL pointer would bind NULL instead of an empty value. The
+				// bytes are copied, since the buffer belongs to the caller and a
+				// function or trigger could detach it while the statement runs.
+				const char* bytes = end > start ? reinterpret_cast<const char*>(column.values) + start : "";
+				if (column.type == TEXT) {
+					return sqlite3_bind_text64(handle, param, bytes, end - start, SQLITE_TRANSIENT, SQLITE_UTF8);
+				}
+				return sqlite3_bind_blob64(handle, param, bytes, end - start, SQLITE_TRANSIENT);
+			}
+		}
+	}
+
+private:
+
+	static const uint32_t CONTINUATION = 0xffffffff;
+
+	// Union type IDs, as defined by Message.fbs and Schema.fbs.
+	static const int HEADER_SCHEMA = 1;
+	static const int HEADER_DICTIONARY_BATCH = 2;
+	static const int HEADER_RECORD_BATCH = 3;
+	static const uint64_t TYPE_NULL = 1;
+	static const uint64_t TYPE_INT = 2;
+	static const uint64_t TYPE_FLOATING_POINT = 3;
+	static const uint64_t TYPE_BINARY = 4;
+	static const uint64_t TYPE_UTF8 = 5;
+	static const uint64_t TYPE_BOOL = 6;
+	static const uint64_t TYPE_LARGE_BINARY = 19;
+	static const uint64_t TYPE_LARGE_UTF8 = 20;
+
+	// Column types.
+	static const char NUL = 0;
+	static const char INTEGER = 1;
+	static const char REAL = 2;
+	static const char BOOL = 3;
+	static const char TEXT = 4;
+	static const char BLOB = 5;
+
+	struct Column {
+		std::string name;
+		char type;
+		size_t width; // The byte width of values (or of offsets, for TEXT/BLOB).
+		bool is_signed;
+		const unsigned char* validity;
+		const unsigned char* values;
+		const unsigned char* offsets;
+		size_t values_length;
+	};
+
+	// A FlatBuffers decoder that checks every access. Instead of failing
+	// immediately, out-of-bounds accesses return zero and clear the valid flag,
+	// which is checked after decoding each message.
+	class FlatReader {
+	public:
+
+		struct Table {
+			size_t position;
+			size_t vtable;
+			size_t vtable_size;
+		};
+
+		explicit FlatReader(const unsigned char* data, size_t size) : data(data), size(size), valid(true) {}
+
+		uint64_t Read(size_t position, size_t bytes) {
+			if (position > size || bytes > size - position) {
+				valid = false;
+				return 0;
+			}
+			return ReadUnsigned(data + position, bytes);
+		}
+
+		// Follows the offset stored at the given position.
+		size_t Deref(size_t position) {
+			uint64_t offset = Read(position, 4);
+			if (!valid || offset == 0 || offset >= size - position) {
+				valid = false;
+				return 0;
+			}
+			return position + static_cast<size_t>(offset);
+		}
+
+		Table GetTable(size_t position) {
+			Table table = { position, 0, 0 };
+			int64_t vtable = static_cast<int64_t>(position) - static_cast<int32_t>(Read(position, 4));
+			if (!valid || vtable < 0 || static_cast<uint64_t>(vtable) >= size) {
+				valid = false;
+				return table;
+			}
+			table.vtable = static_cast<size_t>(vtable);
+			table.vtable_size = static_cast<size_t>(Read(table.vtable, 2));
+			if (table.vtable_size < 4 || table.vtable_size > size - table.vtable) {
+				valid = false;
+				table.vtable_size = 0;
+			}
+			return table;
+		}
+
+		// Returns the position of a field, or 0 if it's absent.
+		size_t GetField(const Table& table, int id) {
+			size_t entry = 4 + 2 * static_cast<size_t>(id);
+			if (!valid || entry + 2 > table.vtable_size) return 0;
+			size_t offset = static_cast<size_t>(Read(table.vtable + entry, 2));
+			return offset ? table.position + offset : 0;
+		}
+
+		uint64_t GetScalar(const Table& table, int id, size_t bytes, uint64_t default_value) {
+			size_t field = GetField(table, id);
+			return field ? Read(field, bytes) : default_value;
+		}
+
+		size_t GetOffsetField(const Table& table, int id) {
+			size_t field = GetField(table, id);
+			return field ? Deref(field) : 0;
+		}
+
+		// Returns the position of the first element of a vector field.
+		size_t GetVector(const Table& table, int id, size_t element_size, size_t* count) {
+			*count = 0;
+			size_t vector = GetOffsetField(table, id);
+			if (vector == 0) return 0;
+			uint64_t length = Read(vector, 4);
+			if (!valid || length > (size - vector - 4) / element_size) {
+				valid = false;
+				return 0;
+			}
+			*count = static_cast<size_t>(length);
+			return vector + 4;
+		}
+
+		std::string GetString(size_t position) {
+			if (position == 0) return std::string();
+			uint64_t length = Read(position, 4);
+			if (!valid || length > size - position - 4) {
+				valid = false;
+				return std::string();
+			}
+			return std::string(reinterpret_cast<const char*>(data) + position + 4, static_cast<size_t>(length));
+		}
+
+		const unsigned char* data;
+		size_t size;
+		bool valid;
+	};
+
+	static uint64_t ReadUnsigned(const unsigned char* bytes, size_t width) {
+		uint64_t value = 0;
+		for (size_t i = 0; i < width; ++i) value |= static_cast<uint64_t>(bytes[i]) << (8 * i);
+		return value;
+	}
+
+	// Reads the next encapsulated message, returning its header type, 0 at
+	// the end of the stream, or -1 if an error occurred.
+	int NextMessage() {
+		if (error != NULL) return -1;
+		if (length - position < 4) {
+			if (position == length) return 0;
+			Fail("Truncated Arrow stream");
+			return -1;
+		}
+		uint64_t metadata_length = ReadUnsigned(data + position, 4);
+		position += 4;
+		if (metadata_length == CONTINUATION) {
+			if (length - position < 4) {
+				Fail("Truncated Arrow stream");
+				return -1;
+			}
+			metadata_length = ReadUnsigned(data + position, 4);
+			position += 4;
+		}
+		if (metadata_length == 0) return 0;
+		if (metadata_length > length - position) {
+			Fail("Truncated Arrow stream");
+			return -1;
+		}
+		metadata = FlatReader(data + position, static_cast<size_t>(metadata_length));
+		position += static_cast<size_t>(metadata_length);
+
+		FlatReader::Table message = metadata.GetTable(metadata.Deref(0));
+		uint64_t version = metadata.GetScalar(message, 0, 2, 0);
+		int header_type = static_cast<int>(metadata.GetScalar(message, 1, 1, 0));
+		header = metadata.GetOffsetField(message, 2);
+		uint64_t message_body_length = metadata.GetScalar(message, 3, 8, 0);
+		if (!metadata.valid || header == 0) {
+			Fail("Invalid Arrow message");
+			return -1;
+		}
+		if (version < METADATA_V4) {
+			Fail("Unsupported Arrow metadata version");
+			return -1;
+		}
+		if (message_body_length > length - position) {
+			Fail("Truncated Arrow stream");
+			return -1;
+		}
+		body = data + position;
+		body_length = static_cast<size_t>(message_body_length);
+		position += body_length;
+		return header_type;
+	}
+
+	// Returns a buffer of the current message body, or NULL if it's empty.
+	const unsigned char* GetBuffer(size_t buffers, size_t buffer_count, size_t index, size_t* buffer_length) {
+		*buffer_length = 0;
+		if (index >= buffer_count) {
+			Fail("Invalid Arrow record batch");
+			return NULL;
+		}
+		uint64_t offset = metadata.Read(buffers + 16 * index, 8);
+		uint64_t buffer_size = metadata.Read(buffers + 16 * index + 8, 8);
+		if (buffer_size > body_length || offset > body_length - buffer_size) {
+			Fail("Invalid Arrow record batch");
+			return NULL;
+		}
+		if (buffer_size == 0) return NULL;
+		*buffer_length = static_cast<size_t>(buffer_size);
+		return body + offset;
+	}
+
+	bool Fail(const char* message) {
+		if (error == NULL) error = message;
+		return false;
+	}
+
+	static const uint64_t METADATA_V4 = 3;
+
+	const unsigned char* const data;
+	const size_t length;
+	size_t position;
+	FlatReader metadata;
+	size_t header;
+	const unsigned char* body;
+	size_t body_length;
+	uint64_t row_count;
+	std::vector<Column> columns;
+	const char* error;
+};
@@ -0,0 +1,404 @@
+// Serializes a result set in the Apache Arrow IPC streaming format: a schema
+// message, followed by one record batch message per batch_size rows, followed
+// by the end-of-stream marker. Since SQLite is dynamically typed, rows are
+// buffered until the result set is complete, and then each column gets the
+// narrowest Arrow type that fits all of its values:
+//   - Int64, if it only contains integers;
+//   - Float64, if it only contains numbers;
+//   - Utf8, if it contains text (any numbers are converted to text);
+//   - Binary, if it contains blobs (any numbers are converted to text).
+// Columns that only contain NULLs (or no rows at all) get their type from the
+// declared type of the underlying table column, if any, and are otherwise
+// Utf8. Every column is nullable.
+class ArrowWriter {
+public:
+
+	explicit ArrowWriter(sqlite3_stmt* handle) :
+		cells(),
+		data(),
+		names(),
+		declared_types(),
+		column_count(sqlite3_column_count(handle)) {
+		names.reserve(column_count);
+		declared_types.reserve(column_count);
+		for (int i = 0; i < column_count; ++i) {
+			names.emplace_back(sqlite3_column_name(handle, i));
+			declared_types.push_back(GetDeclaredType(sqlite3_column_decltype(handle, i)));
+		}
+	}
+
+	// Copies the current row of the given statement.
+	void AppendRow(sqlite3_stmt* handle) {
+		for (int i = 0; i < column_count; ++i) {
+			Cell cell;
+			cell.type = sqlite3_column_type(handle, i);
+			cell.length = 0;
+			switch (cell.type) {
+				case SQLITE_INTEGER:
+					cell.integer = sqlite3_column_int64(handle, i);
+					break;
+				case SQLITE_FLOAT:
+					cell.real = sqlite3_column_double(handle, i);
+					break;
+				case SQLITE_TEXT:
+				case SQLITE_BLOB: {
+					const char* bytes = cell.type == SQLITE_TEXT
+						? reinterpret_cast<const char*>(sqlite3_column_text(handle, i))
+						: static_cast<const char*>(sqlite3_column_blob(handle, i));
+					cell.length = sqlite3_column_bytes(handle, i);
+					cell.offset = data.size();
+					data.append(bytes, cell.length);
+					break;
+				}
+				default:
+					assert(cell.type == SQLITE_NULL);
+			}
+			cells.push_back(cell);
+		}
+	}
+
+	// Writes the entire stream. Returns NULL on success, or an error message.
+	const char* Write(std::string& out, size_t batch_size) {
+		std::vector<char> types(column_count);
+		for (int i = 0; i < column_count; ++i) types[i] = GetColumnType(i);
+		WriteSchema(out, types);
+		size_t row_count = column_count ? cells.size() / column_count : 0;
+		for (size_t start = 0; start < row_count; start += batch_size) {
+			size_t end = std::min(row_count, start + batch_size);
+			if (!WriteRecordBatch(out, types, start, end)) {
+				return "Too much data in a single Arrow record batch (try a smaller batch size)";
+			}
+		}
+		WriteUint32(out, CONTINUATION);
+		WriteUint32(out, 0);
+		return NULL;
+	}
+
+private:
+
+	static const uint32_t CONTINUATION = 0xffffffff;
+	static const short METADATA_V5 = 4;
+
+	// Column types.
+	static const char INT64 = 0;
+	static const char FLOAT64 = 1;
+	static const char UTF8 = 2;
+	static const char BINARY = 3;
+
+	// Union type IDs, as defined by Message.fbs and Schema.fbs.
+	static const unsigned char HEADER_SCHEMA = 1;
+	static const unsigned char HEADER_RECORD_BATCH = 3;
+	static const unsigned char TYPE_INT = 2;
+	static const unsigned char TYPE_FLOATING_POINT = 3;
+	static const unsigned char TYPE_BINARY = 4;
+	static const unsigned char TYPE_UTF8 = 5;
+
+	struct Cell {
+		int type;
+		int length;
+		union {
+			sqlite3_int64 integer;
+			double real;
+			size_t offset;
+		};
+	};
+
+	// A minimal FlatBuffers encoder. Unlike the official builders, objects are
+	// written front to back, so each parent is written before its children,
+	// and the (necessarily forward) offsets to the children are patched in
+	// once the children have been written. Scalars are written little-endian.
+	class FlatBuilder {
+	public:
+
+		// A table being built. Fields are added by ID, and each field's final
+		// position is known after the table has been written.
+		class Table {
+		public:
+			void Add(int id, int size, uint64_t value) {
+				fields.push_back({ id, size, value, 0 });
+			}
+			void AddOffset(int id) {
+				fields.push_back({ id, 4, 0, 0 });
+			}
+			size_t GetPosition(int id) const {
+				for (const Field& field : fields) {
+					if (field.id == id) return field.position;
+				}
+				assert(false);
+				return 0;
+			}
+		private:
+			friend class FlatBuilder;
+			struct Field {
+				int id;
+				int size;
+				uint64_t value;
+				size_t position;
+			};
+			std::vector<Field> fields;
+		};
+
+		// The buffer starts with the root table's offset, which is set by Link().
+		explicit FlatBuilder() : bytes(4, '\0') {}
+
+		// Writes a table, preceded by its vtable. Fields are sorted by size so
+		// they can be naturally aligned without much padding.
+		size_t WriteTable(Table& table) {
+			std::stable_sort(table.fields.begin(), table.fields.end(), [](const Table::Field& a, const Table::Field& b) {
+				return a.size > b.size;
+			});
+			int max_id = -1;
+			bool wide = false;
+			for (const Table::Field& field : table.fields) {
+				max_id = std::max(max_id, field.id);
+				wide = wide || field.size == 8;
+			}
+			size_t vtable_size = 4 + 2 * (max_id + 1);
+			Align(2);
+			size_t vtable = bytes.size();
+			bytes.append(vtable_size, '\0');
+
+			// The table starts with a 4-byte offset to its vtable, so if it has
+			// any 8-byte fields, it must start 4 bytes past an 8-byte boundary.
+			while ((bytes.size() + (wide ? 4 : 0)) % (wide ? 8 : 4)) bytes += '\0';
+			size_t start = bytes.size();
+			size_t size = 4;
+			for (Table::Field& field : table.fields) {
+				while ((start + size) % field.size) ++size;
+				field.position = start + size;
+				size += field.size;
+			}
+			bytes.append(size, '\0');
+			Put(start, start - vtable, 4);
+			Put(vtable, vtable_size, 2);
+			Put(vtable + 2, size, 2);
+			for (const Table::Field& field : table.fields) {
+				Put(vtable + 4 + 2 * field.id, field.position - start, 2);
+				Put(field.position, field.value, field.size);
+			}
+			return start;
+		}
+
+		// Writes a vector with uninitialized elements, and returns the position
+		// of its length prefix (the elements follow immediately).
+		size_t WriteVector(size_t count, size_t element_size) {
+			size_t alignment = std::max<size_t>(element_size, 4);
+			while ((bytes.size() + 4) % alignment) bytes += '\0';
+			size_t position = bytes.size();
+			bytes.append(4 + count * element_size, '\0');
+			Put(position, count, 4);
+			return position;
+		}
+
+		size_t WriteString(const std::string& str) {
+			Align(4);
+			size_t position = bytes.size();
+			bytes.append(4, '\0');
+			Put(position, str.length(), 4);
+			bytes.append(str);
+			bytes += '\0';
+			return position;
+		}
+
+		// Sets the offset at the given position to point to the given object.
+		void Link(size_t position, size_t target) {
+			assert(target > position);
+			Put(position, target - position, 4);
+		}
+
+		void Put(size_t position, uint64_t value, int size) {
+			for (int i = 0; i < size; ++i) {
+				bytes[position + i] = static_cast<char>(value >> (8 * i));
+			}
+		}
+
+		std::string bytes;
+
+	private:
+
+		void Align(size_t alignment) {
+			while (bytes.size() % alignment) bytes += '\0';
+		}
+	};
+
+	char GetColumnType(int column) {
+		unsigned int seen = 0;
+		for (size_t i = column; i < cells.size(); i += column_count) {
+			seen |= 1u << cells[i].type;
+		}
+		if (seen & (1u << SQLITE_BLOB)) return BINARY;
+		if (seen & (1u << SQLITE_TEXT)) return UTF8;
+		if (seen & (1u << SQLITE_FLOAT)) return FLOAT64;
+		if (seen & (1u << SQLITE_INTEGER)) return INT64;
+		return declared_types[column];
+	}
+
+	// Maps a declared column type to an Arrow type, following SQLite's rules
+	// for determining column affinity (NUMERIC affinity maps to Float64).
+	static char GetDeclaredType(const char* declared) {
+		if (declared == NULL) return UTF8;
+		std::string type(declared);
+		for (char& c : type) {
+			if (c >= 'a' && c <= 'z') c -= 'a' - 'A';
+		}
+		if (type.find("INT") != std::string::npos) return INT64;
+		if (type.find("CHAR") != std::string::npos || type.find("CLOB") != std::string::npos || type.find("TEXT") != std::string::npos) return UTF8;
+		if (type.find("BLOB") != std::string::npos) return BINARY;
+		return FLOAT64;
+	}
+
+	// Writes the common part of a Message table, and returns the position of
+	// its header offset.
+	static size_t WriteMessage(FlatBuilder& builder, unsigned char header_type, size_t body_length) {
+		FlatBuilder::Table message;
+		message.Add(0, 2, METADATA_V5);
+		message.Add(1, 1, header_type);
+		message.AddOffset(2);
+		message.Add(3, 8, body_length);
+		builder.Link(0, builder.WriteTable(message));
+		return message.GetPosition(2);
+	}
+
+	// Writes an encapsulated message (the flatbuffer is padded so that the
+	// body starts on an 8-byte boundary).
+	static void WriteEncapsulated(std::string& out, std::string& metadata, const std::string& body) {
+		while (metadata.size() % 8) metadata += '\0';
+		WriteUint32(out, CONTINUATION);
+		WriteUint32(out, static_cast<uint32_t>(metadata.size()));
+		out += metadata;
+		out += body;
+	}
+
+	void WriteSchema(std::string& out, const std::vector<char>& types) {
+		FlatBuilder builder;
+		size_t header = WriteMessage(builder, HEADER_SCHEMA, 0);
+
+		FlatBuilder::Table schema;
+		schema.AddOffset(1);
+		builder.Link(header, builder.WriteTable(schema));
+		size_t fields = builder.WriteVector(column_count, 4);
+		builder.Link(schema.GetPosition(1), fields);
+
+		for (int i = 0; i < column_count; ++i) {
+			FlatBuilder::Table field;
+			field.AddOffset(0);
+			field.Add(1, 1, 1);
+			field.Add(2, 1, types[i] == INT64 ? TYPE_INT : types[i] == FLOAT64 ? TYPE_FLOATING_POINT : types[i] == UTF8 ? TYPE_UTF8 : TYPE_BINARY);
+			field.AddOffset(3);
+			field.AddOffset(5);
+			builder.Link(fields + 4 + 4 * i, builder.WriteTable(field));
+			builder.Link(field.GetPosition(0), builder.WriteString(names[i]));
+
+			FlatBuilder::Table type;
+			if (types[i] == INT64) {
+				type.Add(0, 4, 64);
+				type.Add(1, 1, 1);
+			} else if (types[i] == FLOAT64) {
+				type.Add(0, 2, 2);
+			}
+			builder.Link(field.GetPosition(3), builder.WriteTable(type));
+			builder.Link(field.GetPosition(5), builder.WriteVector(0, 4));
+		}
+
+		WriteEncapsulated(out, builder.bytes, std::string());
+	}
+
+	bool WriteRecordBatch(std::string& out, const std::vector<char>& types, size_t start, size_t end) {
+		size_t length = end - start;
+		std::string body;
+		std::vector<std::pair<size_t, size_t>> buffers;
+		std::vector<std::pair<size_t, size_t>> nodes;
+
+		for (int column = 0; column < column_count; ++column) {
+			std::string validity((length + 7) / 8, '\0');
+			size_t null_count = 0;
+			for (size_t row = start; row < end; ++row) {
+				if (GetCell(row, column).type == SQLITE_NULL) ++null_count;
+				else validity[(row - start) / 8] |= static_cast<char>(1 << ((row - start) % 8));
+			}
+			nodes.emplace_back(length, null_count);
+			AppendBuffer(body, buffers, null_count ? validity : std::string());
+
+			char type = types[column];
+			if (type == INT64 || type == FLOAT64) {
+				std::string values(length * 8, '\0');
+				for (size_t row = start; row < end; ++row) {
+					const Cell& cell = GetCell(row, column);
+					uint64_t bits = 0;
+					if (cell.type == SQLITE_INTEGER && type == INT64) {
+						bits = static_cast<uint64_t>(cell.integer);
+					} else if (cell.type != SQLITE_NULL) {
+						double real = cell.type == SQLITE_INTEGER ? static_cast<double>(cell.integer) : cell.real;
+						memcpy(&bits, &real, 8);
+					}
+					for (int i = 0; i < 8; ++i) {
+						values[(row - start) * 8 + i] = static_cast<char>(bits >> (8 * i));
+					}
+				}
+				AppendBuffer(body, buffers, values);
+			} else {
+				std::string offsets((length + 1) * 4, '\0');
+				std::string values;
+				for (size_t row = start; row < end; ++row) {
+					const Cell& cell = GetCell(row, column);
+					if (cell.type == SQLITE_INTEGER) JsonWriter::WriteInteger(values, cell.integer, true);
+					else if (cell.type == SQLITE_FLOAT) CsvWriter::WriteReal(values, cell.real);
+					else if (cell.type != SQLITE_NULL) values.append(data, cell.offset, cell.length);
+					if (values.length() > static_cast<size_t>(INT32_MAX)) return false;
+					uint32_t offset = static_cast<uint32_t>(values.length());
+					for (int i = 0; i < 4; ++i) {
+						offsets[(row - start + 1) * 4 + i] = static_cast<char>(offset >> (8 * i));
+					}
+				}
+				AppendBuffer(body, buffers, offsets);
+				AppendBuffer(body, buffers, values);
+			}
+		}
+
+		FlatBuilder builder;
+		size_t header = WriteMessage(builder, HEADER_RECORD_BATCH, body.size());
+
+		FlatBuilder::Table record_batch;
+		record_batch.Add(0, 8, length);
+		record_batch.AddOffset(1);
+		record_batch.AddOffset(2);
+		builder.Link(header, builder.WriteTable(record_batch));
+
+		size_t node_vector = builder.WriteVector(nodes.size(), 16);
+		builder.Link(record_batch.GetPosition(1), node_vector);
+		for (size_t i = 0; i < nodes.size(); ++i) {
+			builder.Put(node_vector + 4 + 16 * i, nodes[i].first, 8);
+			builder.Put(node_vector + 12 + 16 * i, nodes[i].second, 8);
+		}
+		size_t buffer_vector = builder.WriteVector(buffers.size(), 16);
+		builder.Link(record_batch.GetPosition(2), buffer_vector);
+		for (size_t i = 0; i < buffers.size(); ++i) {
+			builder.Put(buffer_vector + 4 + 16 * i, buffers[i].first, 8);
+			builder.Put(buffer_vector + 12 + 16 * i, buffers[i].second, 8);
+		}
+
+		WriteEncapsulated(out, builder.bytes, body);
+		return true;
+	}
+
+	// Appends a buffer to a message body, padded to a multiple of 8 bytes.
+	static void AppendBuffer(std::string& body, std::vector<std::pair<size_t, size_t>>& buffers, const std::string& buffer) {
+		buffers.emplace_back(body.size(), buffer.size());
+		body += buffer;
+		while (body.size() % 8) body += '\0';
+	}
+
+	static void WriteUint32(std::string& out, uint32_t value) {
+		for (int i = 0; i < 4; ++i) out += static_cast<char>(value >> (8 * i));
+	}
+
+	inline const Cell& GetCell(size_t row, int column) {
+		return cells[row * column_count + column];
+	}
+
+	std::vector<Cell> cells;
+	std::string data;
+	std::vector<std::string> names;
+	std::vector<char> declared_types;
+	const int column_count;
+};
@@ -6,11 +6,15 @@ public:
 		param_count = sqlite3_bind_parameter_count(_handle);
 		anon_index = 0;
 		success = true;
+		cache_key = NULL;
+		addon = NULL;
 	}
 
 	bool Bind(NODE_ARGUMENTS info, int argc, Statement* stmt) {
 		assert(anon_index == 0);
 		Napi::Env env = info.Env();
+		cache_key = stmt->StartResultCacheKey();
+		addon = stmt->GetAddon();
 		Result result = BindArgs(info, argc, stmt);
 		if (success && result.count != param_count) {
 			if (result.count < param_count) {
@@ -70,13 +74,30 @@ private:
 		return anon_index;
 	}
 
+	// Returns whether the value was created by Database.carray(). If it was, the
+	// wrapped array is returned through the second argument.
+	bool IsCArray(Napi::Env env, Napi::Value value, Napi::Value& array) {
+		bool result;
+		if (!value.IsObject()) return false;
+		if (napi_instanceof(env, value, addon->CArray.Value(), &result) != napi_ok || !result) return false;
+		array = SafeGet(env, value.As<Napi::Object>(), addon->cs.value.Value());
+		return !array.IsEmpty();
+	}
+
 	// Binds the value at the given index or throws an appropriate error.
 	void BindValue(Napi::Env env, Napi::Value value, int index) {
+		Napi::Value array;
 		int status = Data::BindValueFromJS(env, handle, index, value);
+		if (status == -1 && IsCArray(env, value, array)) {
+			status = Data::BindArrayFromJS(env, handle, index, array);
+		}
 		if (status != SQLITE_OK) {
+			if (env.IsExceptionPending()) return Fail(NULL, env, NULL);
 			switch (status) {
 				case -1:
 					return Fail(ThrowTypeError, env, "SQLite3 can only bind numbers, strings, bigints, buffers, and null");
+				case -2:
+					return Fail(ThrowTypeError, env, "The elements of a bound array must be all strings, or all numbers and bigints");
 				case SQLITE_TOOBIG:
 					return Fail(ThrowRangeError, env, "The bound string, buffer, or bigint is too big");
 				case SQLITE_RANGE:
@@ -88,6 +109,7 @@ private:
 			}
 			assert(false);
 		}
+		if (cache_key != NULL) ResultCache::AppendKey(env, *cache_key, index, array.IsEmpty() ? value : array, !array.IsEmpty());
 	}
 
 	// Binds each value in the array or throws an appropriate error.
@@ -164,6 +186,7 @@ private:
 		Napi::Env env = info.Env();
 		int count = 0;
 		bool bound_object = false;
+		Napi::Value array;
 
 		for (int i = 0; i < argc; ++i) {
 			Napi::Value arg = info[i];
@@ -189,7 +212,11 @@ private:
 				} else if (env.IsExceptionPending()) {
 					Fail(NULL, env, NULL);
 					break;
-				} else if (stmt->GetBindMap(env).GetSize()) {
+				} else if (stmt->GetBindMap(env).GetSize() && !IsCArray(env, arg, array)) {
+					if (env.IsExceptionPending()) {
+						Fail(NULL, env, NULL);
+						break;
+					}
 					Fail(ThrowTypeError, env, "Named parameters can only be passed within plain objects");
 					break;
 				}
@@ -207,4 +234,6 @@ private:
 	int param_count;
 	int anon_index; // This value should only be used by NextAnonIndex()
 	bool success; // This value should only be set by Fail()
+	std::string* cache_key; // The key of the Statement's ResultCache, if any
+	Addon* addon;
 };
@@ -0,0 +1,175 @@
+// Collects the rows changed by a connection (via sqlite3_preupdate_hook) and
+// delivers them to a JavaScript function once per commit. Changes are kept in
+// a native buffer until their transaction commits (or discarded if it rolls
+// back, or if the statement that made them fails), and then they're delivered
+// asynchronously through a thread-safe function, so no JavaScript runs while
+// SQLite is in the middle of a commit. Unlike the update hook, the preupdate
+// hook also sees rows deleted by truncating a table or by REPLACE conflict
+// resolution. Everything happens on the thread that uses the connection.
+class ChangeFeed {
+public:
+
+	// Registers the hooks and starts delivering changes to the given function.
+	// On failure, NULL is returned and an exception is pending.
+	static ChangeFeed* Create(Napi::Env env, Addon* addon, sqlite3* db_handle, Napi::Function callback) {
+		ChangeFeed* feed = new ChangeFeed(addon, db_handle);
+		napi_value name = Napi::String::New(env, "better-sqlite3:onChange");
+		napi_status status = napi_create_threadsafe_function(env, callback, NULL, name, 0, 1, NULL, Finalize, feed, Deliver, &feed->tsfn);
+		if (status != napi_ok) {
+			delete feed;
+			Napi::Error::New(env, "Failed to create the change feed").ThrowAsJavaScriptException();
+			return NULL;
+		}
+		// Pending deliveries shouldn't keep the process alive.
+		napi_unref_threadsafe_function(env, feed->tsfn);
+		sqlite3_preupdate_hook(db_handle, OnPreupdate, feed);
+		sqlite3_commit_hook(db_handle, OnCommit, feed);
+		sqlite3_rollback_hook(db_handle, OnRollback, feed);
+		return feed;
+	}
+
+	// Unregisters the hooks. Changes that were already committed are still
+	// delivered. The object deletes itself once the thread-safe function is
+	// finalized, so it must not be used after this.
+	void Close() {
+		sqlite3_preupdate_hook(db_handle, NULL, NULL);
+		sqlite3_commit_hook(db_handle, NULL, NULL);
+		sqlite3_rollback_hook(db_handle, NULL, NULL);
+		pending.clear();
+		napi_release_threadsafe_function(tsfn, napi_tsfn_release);
+	}
+
+	// The number of changes recorded so far. Changes recorded after a given
+	// count can be discarded with Discard(), if they were undone.
+	inline sqlite3_uint64 GetRecorded() { return recorded; }
+
+	void Discard(sqlite3_uint64 count) {
+		if (count >= recorded) return;
+		size_t discarded = static_cast<size_t>(std::min<sqlite3_uint64>(recorded - count, pending.size()));
+		pending.resize(pending.size() - discarded);
+		recorded -= discarded;
+	}
+
+private:
+
+	struct Change {
+		int op;
+		size_t database;
+		size_t table;
+		sqlite3_int64 rowid;
+	};
+
+	struct Table {
+		size_t database;
+		size_t table;
+		bool has_rowid;
+	};
+
+	explicit ChangeFeed(Addon* addon, sqlite3* db_handle) :
+		addon(addon),
+		db_handle(db_handle),
+		tsfn(NULL),
+		scheduled(false),
+		recorded(0) {}
+
+	// Table names are stored once, instead of once per change.
+	size_t Intern(const char* name) {
+		for (size_t i = names.size(); i > 0; --i) {
+			if (names[i - 1] == name) return i - 1;
+		}
+		names.emplace_back(name);
+		return names.size() - 1;
+	}
+
+	// Changes to WITHOUT ROWID tables have no rowid to report. Whether a table
+	// has a rowid is only looked up the first time it's changed.
+	bool HasRowid(const char* database, size_t database_index, const char* table, size_t table_index) {
+		for (size_t i = tables.size(); i > 0; --i) {
+			const Table& entry = tables[i - 1];
+			if (entry.database == database_index && entry.table == table_index) return entry.has_rowid;
+		}
+		bool has_rowid = sqlite3_table_column_metadata(db_handle, database, table, "rowid", NULL, NULL, NULL, NULL, NULL) == SQLITE_OK;
+		tables.push_back({ database_index, table_index, has_rowid });
+		return has_rowid;
+	}
+
+	// Like the update hook, this ignores internal tables (e.g., sqlite_sequence)
+	// and WITHOUT ROWID tables. If an update changes the rowid, the new rowid
+	// is reported.
+	static void OnPreupdate(void* data, sqlite3* db_handle, int op, const char* database, const char* table, sqlite3_int64 old_rowid, sqlite3_int64 new_rowid) {
+		if (strncmp(table, "sqlite_", 7) == 0) return;
+		ChangeFeed* feed = static_cast<ChangeFeed*>(data);
+		size_t database_index = feed->Intern(database);
+		size_t table_index = feed->Intern(table);
+		if (!feed->HasRowid(database, database_index, table, table_index)) return;
+		feed->pending.push_back({ op, database_index, table_index, op == SQLITE_DELETE ? old_rowid : new_rowid });
+		feed->recorded += 1;
+	}
+
+	// This is invoked before the commit happens, but it's the last chance to
+	// learn which changes belong to the transaction.
+	static int OnCommit(void* data) {
+		ChangeFeed* feed = static_cast<ChangeFeed*>(data);
+		if (feed->pending.empty()) return 0;
+		if (feed->committed.empty()) feed->committed.swap(feed->pending);
+		else {
+			feed->committed.insert(feed->committed.end(), feed->pending.begin(), feed->pending.end());
+			feed->pending.clear();
+		}
+		if (!feed->scheduled) {
+			feed->scheduled = napi_call_threadsafe_function(feed->tsfn, NULL, napi_tsfn_nonblocking) == napi_ok;
+		}
+		return 0;
+	}
+
+	static void OnRollback(void* data) {
+		static_cast<ChangeFeed*>(data)->pending.clear();
+	}
+
+	static void Deliver(napi_env _env, napi_value callback, void* context, void* data) {
+		ChangeFeed* feed = static_cast<ChangeFeed*>(context);
+		feed->scheduled = false;
+		if (_env == NULL) return;
+		Napi::Env env(_env);
+		Napi::HandleScope scope(env);
+		std::vector<Change> changes;
+		changes.swap(feed->committed);
+
+		CS& cs = feed->addon->cs;
+		std::vector<Napi::Value> names;
+		names.reserve(feed->names.size());
+		for (const std::string& name : feed->names) names.push_back(StringFromUtf8(env, name.data(), static_cast<int>(name.length())));
+		if (feed->pending.empty()) {
+			feed->names.clear();
+			feed->tables.clear();
+		}
+		Napi::String ops[3] = { Napi::String::New(env, "insert"), Napi::String::New(env, "update"), Napi::String::New(env, "delete") };
+
+		Napi::Array result = Napi::Array::New(env, changes.size());
+		for (size_t i = 0; i < changes.size(); ++i) {
+			const Change& change = changes[i];
+			Napi::Object record = Napi::Object::New(env);
+			record.Set(cs.op.Value(), ops[change.op == SQLITE_INSERT ? 0 : change.op == SQLITE_UPDATE ? 1 : 2]);
+			record.Set(cs.database.Value(), names[change.database]);
+			record.Set(cs.table.Value(), names[change.table]);
+			record.Set(cs.rowid.Value(), Napi::Number::New(env, static_cast<double>(change.rowid)));
+			result.Set(static_cast<uint32_t>(i), record);
+		}
+		napi_value arg = result;
+		napi_call_function(env, env.Undefined(), callback, 1, &arg, NULL);
+	}
+
+	static void Finalize(napi_env env, void* data, void* hint) {
+		delete static_cast<ChangeFeed*>(data);
+	}
+
+	Addon* const addon;
+	sqlite3* const db_handle;
+	napi_threadsafe_function tsfn;
+	bool scheduled;
+	sqlite3_uint64 recorded;
+	std::vector<std::string> names;
+	std::vector<Table> tables;
+	std::vector<Change> pending;
+	std::vector<Change> committed;
+};
@@ -0,0 +1,154 @@
+// Runs WAL checkpoints for a connection on a background thread, using a
+// private connection to the same database. The main connection's automatic
+// checkpoints are replaced by a WAL hook, which only records the size of the
+// WAL after each commit and wakes up the background thread once the WAL has
+// grown past the limit. Otherwise, the background thread checkpoints
+// periodically, if anything was committed since its last checkpoint (the
+// first checkpoint always runs, since the WAL might not be empty yet).
+class Checkpointer {
+public:
+
+	struct Stats {
+		int wal_frames;
+		sqlite3_uint64 checkpoints;
+		sqlite3_uint64 incomplete;
+		double last_duration;
+		double max_duration;
+	};
+
+	// Starts checkpointing the main database of the given connection. On
+	// failure, NULL is returned and the error is stored in the given strings.
+	static Checkpointer* Start(sqlite3* db_handle, int mode, int interval, int wal_limit, std::string& error, int& error_code) {
+		const char* filename = sqlite3_db_filename(db_handle, "main");
+		if (filename == NULL || filename[0] == '\0') {
+			error = "Checkpoints cannot be run for in-memory or temporary databases";
+			error_code = SQLITE_MISUSE;
+			return NULL;
+		}
+		sqlite3_vfs* vfs = NULL;
+		sqlite3_file_control(db_handle, "main", SQLITE_FCNTL_VFS_POINTER, &vfs);
+		sqlite3* checkpoint_handle;
+		if (sqlite3_open_v2(filename, &checkpoint_handle, SQLITE_OPEN_READWRITE, vfs ? vfs->zName : NULL) != SQLITE_OK) {
+			error = sqlite3_errmsg(checkpoint_handle);
+			error_code = sqlite3_extended_errcode(checkpoint_handle);
+			sqlite3_close(checkpoint_handle);
+			return NULL;
+		}
+		sqlite3_extended_result_codes(checkpoint_handle, 1);
+		sqlite3_busy_timeout(checkpoint_handle, interval);
+		return new Checkpointer(db_handle, checkpoint_handle, mode, interval, wal_limit);
+	}
+
+	// Stops the background thread (waiting for any checkpoint in progress) and
+	// restores the main connection's automatic checkpoints.
+	~Checkpointer() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+		wake.notify_one();
+		thread.join();
+		int status = sqlite3_close(checkpoint_handle);
+		assert(status == SQLITE_OK); ((void)status);
+		sqlite3_wal_autocheckpoint(db_handle, previous_autocheckpoint);
+	}
+
+	Stats GetStats() {
+		std::lock_guard<std::mutex> lock(mutex);
+		Stats result = stats;
+		result.wal_frames = wal_frames.load(std::memory_order_relaxed);
+		return result;
+	}
+
+private:
+
+	explicit Checkpointer(sqlite3* db_handle, sqlite3* checkpoint_handle, int mode, int interval, int wal_limit) :
+		db_handle(db_handle),
+		checkpoint_handle(checkpoint_handle),
+		mode(mode),
+		interval(interval),
+		wal_limit(wal_limit),
+		previous_autocheckpoint(GetAutocheckpoint(db_handle)),
+		wal_frames(0),
+		dirty(true),
+		pending(false),
+		stopping(false),
+		in_wal_mode(false),
+		stats() {
+		// This replaces the WAL hook that implements automatic checkpoints.
+		sqlite3_wal_hook(db_handle, OnCommit, this);
+		thread = std::thread(&Checkpointer::Run, this);
+	}
+
+	static int GetAutocheckpoint(sqlite3* db_handle) {
+		int result = 1000;
+		sqlite3_stmt* handle;
+		if (sqlite3_prepare_v2(db_handle, "PRAGMA wal_autocheckpoint", -1, &handle, NULL) == SQLITE_OK) {
+			if (sqlite3_step(handle) == SQLITE_ROW) result = sqlite3_column_int(handle, 0);
+			sqlite3_finalize(handle);
+		}
+		return result;
+	}
+
+	// Invoked on the main connection's thread, after each commit to the WAL.
+	static int OnCommit(void* data, sqlite3* db_handle, const char* name, int frames) {
+		Checkpointer* self = static_cast<Checkpointer*>(data);
+		if (strcmp(name, "main") != 0) return SQLITE_OK;
+		self->wal_frames.store(frames, std::memory_order_relaxed);
+		self->dirty.store(true, std::memory_order_relaxed);
+		if (self->wal_limit > 0 && frames >= self->wal_limit) {
+			{
+				std::lock_guard<std::mutex> lock(self->mutex);
+				self->pending = true;
+			}
+			self->wake.notify_one();
+		}
+		return SQLITE_OK;
+	}
+
+	void Run() {
+		std::unique_lock<std::mutex> lock(mutex);
+		while (!stopping) {
+			wake.wait_for(lock, std::chrono::milliseconds(interval), [this]() { return stopping || pending; });
+			if (stopping) break;
+			pending = false;
+			if (!dirty.exchange(false, std::memory_order_relaxed)) continue;
+			lock.unlock();
+
+			// A connection only notices that the database uses a WAL once it
+			// reads from it. Until then, checkpoints do nothing.
+			if (!in_wal_mode) {
+				sqlite3_exec(checkpoint_handle, "PRAGMA schema_version", NULL, NULL, NULL);
+			}
+
+			int log_frames = 0;
+			int checkpointed_frames = 0;
+			auto start = std::chrono::steady_clock::now();
+			int status = sqlite3_wal_checkpoint_v2(checkpoint_handle, "main", mode, &log_frames, &checkpointed_frames);
+			std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - start;
+			in_wal_mode = log_frames >= 0;
+
+			lock.lock();
+			stats.checkpoints += 1;
+			if (status != SQLITE_OK || checkpointed_frames < log_frames) stats.incomplete += 1;
+			stats.last_duration = duration.count();
+			if (duration.count() > stats.max_duration) stats.max_duration = duration.count();
+		}
+	}
+
+	sqlite3* const db_handle;
+	sqlite3* const checkpoint_handle;
+	const int mode;
+	const int interval;
+	const int wal_limit;
+	const int previous_autocheckpoint;
+	std::atomic<int> wal_frames;
+	std::atomic<bool> dirty;
+	std::mutex mutex;
+	std::condition_variable wake;
+	bool pending;
+	bool stopping;
+	bool in_wal_mode;
+	Stats stats;
+	std::thread thread;
+};
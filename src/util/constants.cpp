@@ -28,6 +28,31 @@ public:
 		SetString(env, type, "type");
 		SetString(env, totalPages, "totalPages");
 		SetString(env, remainingPages, "remainingPages");
+		SetString(env, rows, "rows");
+		SetString(env, bytes, "bytes");
+		SetString(env, duration, "duration");
+		SetString(env, size, "size");
+		SetString(env, mappedReads, "mappedReads");
+		SetString(env, fileReads, "fileReads");
+		SetString(env, allocator, "allocator");
+		SetString(env, allocations, "allocations");
+		SetString(env, frees, "frees");
+		SetString(env, poolHits, "poolHits");
+		SetString(env, bytesInUse, "bytesInUse");
+		SetString(env, bytesPooled, "bytesPooled");
+		SetString(env, hits, "hits");
+		SetString(env, misses, "misses");
+		SetString(env, budget, "budget");
+		SetString(env, totalBytes, "totalBytes");
+		SetString(env, evictions, "evictions");
+		SetString(env, walFrames, "walFrames");
+		SetString(env, checkpoints, "checkpoints");
+		SetString(env, incompleteCheckpoints, "incompleteCheckpoints");
+		SetString(env, lastDuration, "lastDuration");
+		SetString(env, maxDuration, "maxDuration");
+		SetString(env, op, "op");
+		SetString(env, rowid, "rowid");
+		SetString(env, batchSize, "batchSize");
 
 		SetCode(env, SQLITE_OK, "SQLITE_OK");
 		SetCode(env, SQLITE_ERROR, "SQLITE_ERROR");
@@ -157,6 +182,31 @@ public:
 	Napi::Reference<Napi::String> type;
 	Napi::Reference<Napi::String> totalPages;
 	Napi::Reference<Napi::String> remainingPages;
+	Napi::Reference<Napi::String> rows;
+	Napi::Reference<Napi::String> bytes;
+	Napi::Reference<Napi::String> duration;
+	Napi::Reference<Napi::String> size;
+	Napi::Reference<Napi::String> mappedReads;
+	Napi::Reference<Napi::String> fileReads;
+	Napi::Reference<Napi::String> allocator;
+	Napi::Reference<Napi::String> allocations;
+	Napi::Reference<Napi::String> frees;
+	Napi::Reference<Napi::String> poolHits;
+	Napi::Reference<Napi::String> bytesInUse;
+	Napi::Reference<Napi::String> bytesPooled;
+	Napi::Reference<Napi::String> hits;
+	Napi::Reference<Napi::String> misses;
+	Napi::Reference<Napi::String> budget;
+	Napi::Reference<Napi::String> totalBytes;
+	Napi::Reference<Napi::String> evictions;
+	Napi::Reference<Napi::String> walFrames;
+	Napi::Reference<Napi::String> checkpoints;
+	Napi::Reference<Napi::String> incompleteCheckpoints;
+	Napi::Reference<Napi::String> lastDuration;
+	Napi::Reference<Napi::String> maxDuration;
+	Napi::Reference<Napi::String> op;
+	Napi::Reference<Napi::String> rowid;
+	Napi::Reference<Napi::String> batchSize;
 
 private:
 
@@ -0,0 +1,142 @@
+// A shim over the default VFS that counts how the pages of each main database
+// file are read: either through memory-mapped I/O (xFetch), or by copying them
+// with read() (xRead). It's used for connections opened with the "mmap"
+// option, so that users can see how much of their working set is actually
+// served by memory-mapped I/O. Everything else is passed through unchanged.
+class CountingVFS {
+public:
+
+	static constexpr const char* NAME = "better-sqlite3-counting";
+
+	struct Counters {
+		sqlite3_uint64 mapped_reads;
+		sqlite3_uint64 file_reads;
+	};
+
+	// Registers the VFS with SQLite. This is safe to call more than once.
+	static void Register() {
+		static std::once_flag init_flag;
+		std::call_once(init_flag, [](){
+			static sqlite3_vfs vfs = {};
+			sqlite3_vfs* base = sqlite3_vfs_find(NULL);
+			assert(base != NULL);
+			vfs.iVersion = base->iVersion < 3 ? base->iVersion : 3;
+			vfs.szOsFile = static_cast<int>(sizeof(File)) + base->szOsFile;
+			vfs.mxPathname = base->mxPathname;
+			vfs.zName = NAME;
+			vfs.pAppData = base;
+			vfs.xOpen = Open;
+			vfs.xDelete = [](sqlite3_vfs* vfs, const char* name, int sync_dir) { return Base(vfs)->xDelete(Base(vfs), name, sync_dir); };
+			vfs.xAccess = [](sqlite3_vfs* vfs, const char* name, int flags, int* result) { return Base(vfs)->xAccess(Base(vfs), name, flags, result); };
+			vfs.xFullPathname = [](sqlite3_vfs* vfs, const char* name, int length, char* result) { return Base(vfs)->xFullPathname(Base(vfs), name, length, result); };
+			vfs.xDlOpen = [](sqlite3_vfs* vfs, const char* filename) { return Base(vfs)->xDlOpen(Base(vfs), filename); };
+			vfs.xDlError = [](sqlite3_vfs* vfs, int length, char* message) { Base(vfs)->xDlError(Base(vfs), length, message); };
+			vfs.xDlSym = [](sqlite3_vfs* vfs, void* handle, const char* symbol) { return Base(vfs)->xDlSym(Base(vfs), handle, symbol); };
+			vfs.xDlClose = [](sqlite3_vfs* vfs, void* handle) { Base(vfs)->xDlClose(Base(vfs), handle); };
+			vfs.xRandomness = [](sqlite3_vfs* vfs, int length, char* result) { return Base(vfs)->xRandomness(Base(vfs), length, result); };
+			vfs.xSleep = [](sqlite3_vfs* vfs, int microseconds) { return Base(vfs)->xSleep(Base(vfs), microseconds); };
+			vfs.xCurrentTime = [](sqlite3_vfs* vfs, double* result) { return Base(vfs)->xCurrentTime(Base(vfs), result); };
+			vfs.xGetLastError = [](sqlite3_vfs* vfs, int length, char* result) { return Base(vfs)->xGetLastError(Base(vfs), length, result); };
+			vfs.xCurrentTimeInt64 = [](sqlite3_vfs* vfs, sqlite3_int64* result) { return Base(vfs)->xCurrentTimeInt64(Base(vfs), result); };
+			vfs.xSetSystemCall = [](sqlite3_vfs* vfs, const char* name, sqlite3_syscall_ptr ptr) { return Base(vfs)->xSetSystemCall(Base(vfs), name, ptr); };
+			vfs.xGetSystemCall = [](sqlite3_vfs* vfs, const char* name) { return Base(vfs)->xGetSystemCall(Base(vfs), name); };
+			vfs.xNextSystemCall = [](sqlite3_vfs* vfs, const char* name) { return Base(vfs)->xNextSystemCall(Base(vfs), name); };
+			int status = sqlite3_vfs_register(&vfs, 0);
+			assert(status == SQLITE_OK); ((void)status);
+		});
+	}
+
+	// Returns the counters of the given connection's main database file, or
+	// NULL if it wasn't opened through this VFS.
+	static Counters* GetCounters(sqlite3* db_handle) {
+		sqlite3_file* file = NULL;
+		if (sqlite3_file_control(db_handle, "main", SQLITE_FCNTL_FILE_POINTER, &file) != SQLITE_OK) return NULL;
+		if (file == NULL || file->pMethods == NULL || file->pMethods->xClose != Close) return NULL;
+		File* f = reinterpret_cast<File*>(file);
+		return f->is_main_db ? &f->counters : NULL;
+	}
+
+private:
+
+	// The underlying VFS's file is stored immediately after this struct.
+	struct File {
+		sqlite3_file base;
+		sqlite3_file* real;
+		Counters counters;
+		bool is_main_db;
+	};
+
+	static inline sqlite3_vfs* Base(sqlite3_vfs* vfs) {
+		return static_cast<sqlite3_vfs*>(vfs->pAppData);
+	}
+
+	static inline sqlite3_file* Real(sqlite3_file* file) {
+		return reinterpret_cast<File*>(file)->real;
+	}
+
+	static int Open(sqlite3_vfs* vfs, const char* name, sqlite3_file* file, int flags, int* out_flags) {
+		File* f = reinterpret_cast<File*>(file);
+		f->real = reinterpret_cast<sqlite3_file*>(f + 1);
+		f->counters = {};
+		f->is_main_db = (flags & SQLITE_OPEN_MAIN_DB) != 0;
+		int status = Base(vfs)->xOpen(Base(vfs), name, f->real, flags, out_flags);
+		if (f->real->pMethods == NULL) {
+			f->base.pMethods = NULL;
+			return status;
+		}
+
+		// The shim's methods mirror the version of the underlying file's methods.
+		static const sqlite3_io_methods methods[3] = {
+			MakeMethods(1),
+			MakeMethods(2),
+			MakeMethods(3),
+		};
+		int version = f->real->pMethods->iVersion;
+		f->base.pMethods = &methods[(version < 1 ? 1 : version > 3 ? 3 : version) - 1];
+		return status;
+	}
+
+	static sqlite3_io_methods MakeMethods(int version) {
+		sqlite3_io_methods methods = {};
+		methods.iVersion = version;
+		methods.xClose = Close;
+		methods.xRead = Read;
+		methods.xWrite = [](sqlite3_file* file, const void* buffer, int amount, sqlite3_int64 offset) { return Real(file)->pMethods->xWrite(Real(file), buffer, amount, offset); };
+		methods.xTruncate = [](sqlite3_file* file, sqlite3_int64 size) { return Real(file)->pMethods->xTruncate(Real(file), size); };
+		methods.xSync = [](sqlite3_file* file, int flags) { return Real(file)->pMethods->xSync(Real(file), flags); };
+		methods.xFileSize = [](sqlite3_file* file, sqlite3_int64* size) { return Real(file)->pMethods->xFileSize(Real(file), size); };
+		methods.xLock = [](sqlite3_file* file, int level) { return Real(file)->pMethods->xLock(Real(file), level); };
+		methods.xUnlock = [](sqlite3_file* file, int level) { return Real(file)->pMethods->xUnlock(Real(file), level); };
+		methods.xCheckReservedLock = [](sqlite3_file* file, int* result) { return Real(file)->pMethods->xCheckReservedLock(Real(file), result); };
+		methods.xFileControl = [](sqlite3_file* file, int op, void* arg) { return Real(file)->pMethods->xFileControl(Real(file), op, arg); };
+		methods.xSectorSize = [](sqlite3_file* file) { return Real(file)->pMethods->xSectorSize(Real(file)); };
+		methods.xDeviceCharacteristics = [](sqlite3_file* file) { return Real(file)->pMethods->xDeviceCharacteristics(Real(file)); };
+		if (version >= 2) {
+			methods.xShmMap = [](sqlite3_file* file, int index, int size, int extend, void volatile** result) { return Real(file)->pMethods->xShmMap(Real(file), index, size, extend, result); };
+			methods.xShmLock = [](sqlite3_file* file, int offset, int n, int flags) { return Real(file)->pMethods->xShmLock(Real(file), offset, n, flags); };
+			methods.xShmBarrier = [](sqlite3_file* file) { Real(file)->pMethods->xShmBarrier(Real(file)); };
+			methods.xShmUnmap = [](sqlite3_file* file, int delete_flag) { return Real(file)->pMethods->xShmUnmap(Real(file), delete_flag); };
+		}
+		if (version >= 3) {
+			methods.xFetch = Fetch;
+			methods.xUnfetch = [](sqlite3_file* file, sqlite3_int64 offset, void* page) { return Real(file)->pMethods->xUnfetch(Real(file), offset, page); };
+		}
+		return methods;
+	}
+
+	static int Close(sqlite3_file* file) {
+		return Real(file)->pMethods->xClose(Real(file));
+	}
+
+	static int Read(sqlite3_file* file, void* buffer, int amount, sqlite3_int64 offset) {
+		reinterpret_cast<File*>(file)->counters.file_reads += 1;
+		return Real(file)->pMethods->xRead(Real(file), buffer, amount, offset);
+	}
+
+	// SQLite falls back to xRead() whenever xFetch() doesn't provide a page.
+	static int Fetch(sqlite3_file* file, sqlite3_int64 offset, int amount, void** result) {
+		int status = Real(file)->pMethods->xFetch(Real(file), offset, amount, result);
+		if (status == SQLITE_OK && *result != NULL) reinterpret_cast<File*>(file)->counters.mapped_reads += 1;
+		return status;
+	}
+};
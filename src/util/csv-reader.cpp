@@ -0,0 +1,254 @@
+// Parses CSV (or TSV, etc.) records from a file or an in-memory buffer,
+// following RFC 4180 with a configurable delimiter and quote character. Files
+// are read in large chunks, and fields are referenced in place whenever
+// possible, so only quoted fields containing escaped quotes are copied while
+// parsing. Both CRLF and LF line endings are accepted, a leading UTF-8 byte
+// order mark is ignored, and unquoted fields may contain quote characters.
+class CsvReader {
+public:
+
+	explicit CsvReader(const char* data, size_t length, char delimiter, char quote) :
+		CsvReader(NULL, delimiter, quote) {
+		begin = data;
+		end = data + length;
+		eof = true;
+	}
+
+	explicit CsvReader(FILE* file, char delimiter, char quote) :
+		file(file),
+		buffer(),
+		begin(NULL),
+		end(NULL),
+		eof(file == NULL),
+		started(false),
+		delimiter(delimiter),
+		quote(quote),
+		line(1),
+		record_line(1),
+		bytes_read(0),
+		error(NULL),
+		fields(),
+		unescaped() {
+		memset(special, 0, sizeof(special));
+		special[static_cast<unsigned char>(delimiter)] = true;
+		special[static_cast<unsigned char>('\n')] = true;
+		special[static_cast<unsigned char>('\r')] = true;
+	}
+
+	~CsvReader() {
+		if (file != NULL) fclose(file);
+	}
+
+	// Reads the next non-empty record. Returns false at the end of the input,
+	// or if an error occurred (in which case GetError() returns non-NULL).
+	bool Next() {
+		for (;;) {
+			int result = ParseRecord();
+			if (result == NEED_MORE) {
+				if (!Refill()) return false;
+				continue;
+			}
+			if (result == DONE || result == FAILED) return false;
+			if (fields.size() == 1 && fields[0].length == 0 && !fields[0].quoted) continue;
+			for (Field& field : fields) {
+				if (field.escaped) field.data = unescaped.data() + field.offset;
+			}
+			return true;
+		}
+	}
+
+	inline size_t GetFieldCount() { return fields.size(); }
+	inline const char* GetField(size_t index) { return fields[index].data; }
+	inline size_t GetFieldLength(size_t index) { return fields[index].length; }
+	inline bool IsQuoted(size_t index) { return fields[index].quoted; }
+
+	// Binds a field of the current record to the given parameter. If infer is
+	// true, unquoted fields that look like numbers are bound as numbers, and
+	// empty unquoted fields are bound as NULL. Everything else is bound as text
+	// (which SQLite will convert according to the column's type affinity).
+	int BindField(sqlite3_stmt* handle, int param, size_t index, bool infer) {
+		const Field& field = fields[index];
+		const char* data = field.length ? field.data : "";
+		if (infer && !field.quoted) {
+			if (field.length == 0) return sqlite3_bind_null(handle, param);
+			if (IsNumeric(data, field.length)) {
+				const char* end = data + field.length;
+				int64_t integer;
+				std::from_chars_result result = std::from_chars(data, end, integer);
+				if (result.ec == std::errc() && result.ptr == end) {
+					return sqlite3_bind_int64(handle, param, integer);
+				}
+				double real;
+				result = std::from_chars(data, end, real);
+				if (result.ec == std::errc() && result.ptr == end) {
+					return sqlite3_bind_double(handle, param, real);
+				}
+			}
+		}
+		// Fields that point into a caller's buffer are copied, since a function
+		// or trigger could detach the buffer while the statement runs. The
+		// reader's own memory doesn't change until the next record is read.
+		const bool owned = file != NULL || field.escaped || field.length == 0;
+		return sqlite3_bind_text64(handle, param, data, field.length, owned ? SQLITE_STATIC : SQLITE_TRANSIENT, SQLITE_UTF8);
+	}
+
+	// The 1-based line number on which the most recently read record started,
+	// or on which the error occurred. For an unterminated quoted field, that's
+	// the line on which the field started.
+	inline size_t GetLine() { return record_line; }
+	inline size_t GetBytesRead() { return bytes_read; }
+	inline const char* GetError() { return error; }
+
+private:
+
+	static const int RECORD = 0;
+	static const int NEED_MORE = 1;
+	static const int DONE = 2;
+	static const int FAILED = 3;
+	static const size_t CHUNK_SIZE = 1024 * 1024;
+
+	struct Field {
+		const char* data;
+		size_t offset;
+		size_t length;
+		bool quoted;
+		bool escaped;
+	};
+
+	// Returns whether the text starts like a decimal number. Numbers with
+	// redundant leading zeros (e.g., zip codes) are not considered numeric.
+	static bool IsNumeric(const char* data, size_t length) {
+		const char* digits = data[0] == '-' ? data + 1 : data;
+		size_t count = length - (digits - data);
+		if (count == 0 || digits[0] < '0' || digits[0] > '9') return false;
+		return !(digits[0] == '0' && count > 1 && digits[1] >= '0' && digits[1] <= '9');
+	}
+
+	// Parses the record starting at the current position. On success, the
+	// position is moved to the start of the next record. If the record might
+	// continue past the data that has been read so far, nothing is consumed.
+	int ParseRecord() {
+		if (!started) {
+			if (end - begin < 3 && !eof) return NEED_MORE;
+			if (end - begin >= 3 && memcmp(begin, "\xef\xbb\xbf", 3) == 0) {
+				begin += 3;
+				bytes_read += 3;
+			}
+			started = true;
+		}
+		if (begin == end) return eof ? DONE : NEED_MORE;
+
+		const char* p = begin;
+		size_t newlines = 0;
+		fields.clear();
+		unescaped.clear();
+		for (;;) {
+			Field field = { NULL, 0, 0, false, false };
+			if (p < end && *p == quote) {
+				const char* start = ++p;
+				const size_t field_line = line + newlines;
+				field.quoted = true;
+				for (;;) {
+					const char* q = static_cast<const char*>(memchr(p, quote, end - p));
+					if (q == NULL || (q + 1 == end && !eof)) {
+						if (!eof) return NEED_MORE;
+						error = "Unterminated quoted field";
+						record_line = field_line;
+						return FAILED;
+					}
+					newlines += std::count(p, q, '\n');
+					if (q + 1 < end && q[1] == quote) {
+						if (!field.escaped) {
+							field.escaped = true;
+							field.offset = unescaped.size();
+						}
+						unescaped.append(start, q + 1);
+						p = start = q + 2;
+						continue;
+					}
+					if (field.escaped) {
+						unescaped.append(start, q);
+						field.length = unescaped.size() - field.offset;
+					} else {
+						field.data = start;
+						field.length = q - start;
+					}
+					p = q + 1;
+					break;
+				}
+				if (p < end && !special[static_cast<unsigned char>(*p)]) {
+					error = "Unexpected character after a closing quote";
+					record_line = line + newlines;
+					return FAILED;
+				}
+			} else {
+				const char* start = p;
+				while (p < end && !special[static_cast<unsigned char>(*p)]) ++p;
+				field.data = start;
+				field.length = p - start;
+			}
+			fields.push_back(field);
+
+			if (p == end) {
+				if (!eof) return NEED_MORE;
+				break;
+			}
+			if (*p == delimiter) {
+				++p;
+				continue;
+			}
+			if (*p == '\r') {
+				if (p + 1 == end && !eof) return NEED_MORE;
+				if (p + 1 < end && p[1] == '\n') ++p;
+			}
+			++p;
+			newlines += 1;
+			break;
+		}
+
+		bytes_read += p - begin;
+		begin = p;
+		record_line = line;
+		line += newlines;
+		return RECORD;
+	}
+
+	// Reads more data from the file, keeping any unconsumed data.
+	bool Refill() {
+		if (eof) return false;
+		size_t remaining = end - begin;
+		if (remaining > 0 && begin != buffer.data()) {
+			memmove(buffer.data(), begin, remaining);
+		}
+		if (buffer.size() - remaining < CHUNK_SIZE) {
+			buffer.resize(std::max(buffer.size() * 2, remaining + CHUNK_SIZE));
+		}
+		size_t count = fread(buffer.data() + remaining, 1, buffer.size() - remaining, file);
+		if (count == 0) {
+			if (ferror(file)) {
+				error = "Failed to read the file";
+				return false;
+			}
+			eof = true;
+		}
+		begin = buffer.data();
+		end = begin + remaining + count;
+		return true;
+	}
+
+	FILE* const file;
+	std::vector<char> buffer;
+	const char* begin;
+	const char* end;
+	bool eof;
+	bool started;
+	const char delimiter;
+	const char quote;
+	size_t line;
+	size_t record_line;
+	size_t bytes_read;
+	const char* error;
+	std::vector<Field> fields;
+	std::string unescaped;
+	bool special[256];
+};
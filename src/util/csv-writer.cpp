@@ -0,0 +1,96 @@
+// Serializes result rows as CSV (RFC 4180, but with LF line endings). Every
+// column is written, in order, regardless of the statement's mode. NULL is
+// written as an empty field, while an empty string is written as "" so that
+// the two can be told apart (see Database#importCSV). Numbers are formatted
+// like Number.prototype.toString(), and BLOBs are written as hexadecimal text.
+class CsvWriter {
+public:
+
+	static void WriteHeader(std::string& out, sqlite3_stmt* handle) {
+		int column_count = sqlite3_column_count(handle);
+		for (int i = 0; i < column_count; ++i) {
+			if (i) out += ',';
+			const char* name = sqlite3_column_name(handle, i);
+			WriteField(out, name, strlen(name));
+		}
+		out += '\n';
+	}
+
+	static void WriteRow(std::string& out, sqlite3_stmt* handle, bool safe_ints) {
+		int column_count = sqlite3_column_count(handle);
+		for (int i = 0; i < column_count; ++i) {
+			if (i) out += ',';
+			switch (sqlite3_column_type(handle, i)) {
+				case SQLITE_INTEGER:
+					JsonWriter::WriteInteger(out, sqlite3_column_int64(handle, i), safe_ints);
+					break;
+				case SQLITE_FLOAT:
+					WriteReal(out, sqlite3_column_double(handle, i));
+					break;
+				case SQLITE_TEXT:
+					WriteField(
+						out,
+						reinterpret_cast<const char*>(sqlite3_column_text(handle, i)),
+						sqlite3_column_bytes(handle, i)
+					);
+					break;
+				case SQLITE_BLOB:
+					WriteHex(
+						out,
+						static_cast<const unsigned char*>(sqlite3_column_blob(handle, i)),
+						sqlite3_column_bytes(handle, i)
+					);
+					break;
+				default:
+					assert(sqlite3_column_type(handle, i) == SQLITE_NULL);
+			}
+		}
+		out += '\n';
+	}
+
+	// Writes a number the same way String(value) would.
+	static void WriteReal(std::string& out, double value) {
+		if (std::isnan(value)) out += "NaN";
+		else if (std::isinf(value)) out += value > 0 ? "Infinity" : "-Infinity";
+		else JsonWriter::WriteNumber(out, value);
+	}
+
+private:
+
+	// Quotes the field if it's empty or if it contains any special characters.
+	static void WriteField(std::string& out, const char* data, size_t length) {
+		size_t special = 0;
+		while (special < length && !IsSpecial(data[special])) ++special;
+		if (special == length && length > 0) {
+			out.append(data, length);
+			return;
+		}
+		out += '"';
+		const char* end = data + length;
+		for (const char* p = data; p < end;) {
+			const char* quote = static_cast<const char*>(memchr(p, '"', end - p));
+			if (quote == NULL) {
+				out.append(p, end);
+				break;
+			}
+			out.append(p, quote + 1);
+			out += '"';
+			p = quote + 1;
+		}
+		out += '"';
+	}
+
+	static void WriteHex(std::string& out, const unsigned char* data, int length) {
+		static const char hex[] = "0123456789abcdef";
+		size_t offset = out.size();
+		out.resize(offset + static_cast<size_t>(length) * 2);
+		for (int i = 0; i < length; ++i) {
+			out[offset++] = hex[data[i] >> 4];
+			out[offset++] = hex[data[i] & 0xf];
+		}
+	}
+
+	static inline bool IsSpecial(char c) {
+		return c == ',' || c == '"' || c == '\n' || c == '\r';
+	}
+};
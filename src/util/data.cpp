@@ -69,8 +69,17 @@ namespace Data {
 	static const char PLUCK = 1;
 	static const char EXPAND = 2;
 	static const char RAW = 3;
+	static const char LAZY = 4;
 
-	Napi::Value GetValueJS(Napi::Env env, sqlite3_stmt* handle, int column, bool safe_ints) {
+	Napi::Value GetValueJS(Napi::Env env, sqlite3_stmt* handle, int column, bool safe_ints, StringCache* strings) {
+		if (strings != NULL && sqlite3_column_type(handle, column) == SQLITE_TEXT) {
+			return strings->Get(
+				env,
+				column,
+				reinterpret_cast<const char*>(sqlite3_column_text(handle, column)),
+				sqlite3_column_bytes(handle, column)
+			);
+		}
 		SQLITE_VALUE_TO_JS(column, env, safe_ints, handle, column);
 	}
 
@@ -78,38 +87,32 @@ namespace Data {
 		SQLITE_VALUE_TO_JS(value, env, safe_ints, value);
 	}
 
-	Napi::Value GetExpandedRowJS(Napi::Env env, sqlite3_stmt* handle, bool safe_ints) {
-		Napi::Object row = Napi::Object::New(env);
-		int column_count = sqlite3_column_count(handle);
-		for (int i = 0; i < column_count; ++i) {
-			const char* table_raw = sqlite3_column_table_name(handle, i);
-			Napi::String table = InternalizedFromUtf8(env, table_raw == NULL ? "$" : table_raw, -1);
-			Napi::String column = InternalizedFromUtf8(env, sqlite3_column_name(handle, i), -1);
-			Napi::Value value = Data::GetValueJS(env, handle, i, safe_ints);
-			if (row.HasOwnProperty(table)) {
-				row.Get(table).As<Napi::Object>().Set(column, value);
-			} else {
-				Napi::Object nested = Napi::Object::New(env);
-				row.Set(table, nested);
-				nested.Set(column, value);
-			}
-		}
-		return row;
+	Napi::Value GetExpandedRowJS(Napi::Env env, Statement* stmt, sqlite3_stmt* handle, bool safe_ints) {
+		return stmt->GetRowBuilder().GetExpandedRowJS(env, handle, safe_ints, stmt->GetStringCache());
 	}
 
 	Napi::Value GetFlatRowJS(Napi::Env env, Statement* stmt, sqlite3_stmt* handle, bool safe_ints) {
-		return stmt->GetRowBuilder().GetRowJS(env, handle, safe_ints);
+		return stmt->GetRowBuilder().GetRowJS(env, handle, safe_ints, stmt->GetStringCache());
 	}
 
 	Napi::Value GetRawRowJS(Napi::Env env, Statement* stmt, sqlite3_stmt* handle, bool safe_ints) {
-		return stmt->GetRowBuilder().GetRawRowJS(env, handle, safe_ints);
+		return stmt->GetRowBuilder().GetRawRowJS(env, handle, safe_ints, stmt->GetStringCache());
+	}
+
+	Napi::Value GetLazyRowJS(Napi::Env env, Statement* stmt, sqlite3_stmt* handle, bool safe_ints) {
+		RowBuffer* buffer = new RowBuffer(sqlite3_column_count(handle), safe_ints);
+		buffer->AppendRow(handle);
+		Napi::Value rows = stmt->GetRowBuilder().GetLazyRowsJS(env, handle, buffer);
+		if (rows.IsEmpty()) return rows;
+		return SafeGetElement(env, rows.As<Napi::Object>(), 0);
 	}
 
 	Napi::Value GetRowJS(Napi::Env env, Statement* stmt, sqlite3_stmt* handle, bool safe_ints, char mode) {
 		if (mode == Data::FLAT) return GetFlatRowJS(env, stmt, handle, safe_ints);
-		if (mode == PLUCK) return GetValueJS(env, handle, 0, safe_ints);
-		if (mode == EXPAND) return GetExpandedRowJS(env, handle, safe_ints);
+		if (mode == PLUCK) return GetValueJS(env, handle, 0, safe_ints, stmt->GetStringCache());
+		if (mode == EXPAND) return GetExpandedRowJS(env, stmt, handle, safe_ints);
 		if (mode == RAW) return GetRawRowJS(env, stmt, handle, safe_ints);
+		if (mode == LAZY) return GetLazyRowJS(env, stmt, handle, safe_ints);
 		assert(false);
 		return Napi::Value();
 	}
@@ -126,6 +129,84 @@ namespace Data {
 		return value.IsBigInt() ? SQLITE_TOOBIG : -1;
 	}
 
+	// Binds the array of a Database.carray() wrapper to a parameter that's used
+	// as the first argument of carray() (e.g., "WHERE id IN carray(?)"), so that
+	// lists of any length can be used with the same prepared statement. An
+	// Int32Array, BigInt64Array, or Float64Array is bound as it is. The elements
+	// of other arrays must be all strings, or all numbers and bigints, which are
+	// bound as 64-bit integers unless a number isn't an integer. SQLite copies
+	// the data, so the array can be modified after it's bound. If the elements
+	// can't be bound together, -2 is returned.
+	int BindArrayFromJS(Napi::Env env, sqlite3_stmt* handle, int index, Napi::Value value) {
+		static sqlite3_int64 empty;
+		if (value.IsTypedArray()) {
+			Napi::TypedArray array = value.As<Napi::TypedArray>();
+			napi_typedarray_type type = array.TypedArrayType();
+			if (type != napi_int32_array && type != napi_bigint64_array && type != napi_float64_array) return -1;
+			size_t length = array.ElementLength();
+			if (length > INT_MAX) return SQLITE_TOOBIG;
+			if (length == 0) return sqlite3_carray_bind(handle, index, &empty, 0, SQLITE_CARRAY_INT64, SQLITE_STATIC);
+			int flags = type == napi_int32_array ? SQLITE_CARRAY_INT32 : type == napi_bigint64_array ? SQLITE_CARRAY_INT64 : SQLITE_CARRAY_DOUBLE;
+			void* data = static_cast<char*>(array.ArrayBuffer().Data()) + array.ByteOffset();
+			return sqlite3_carray_bind(handle, index, data, static_cast<int>(length), flags, SQLITE_TRANSIENT);
+		}
+
+		// SQLite can't copy an empty array, but it doesn't need to.
+		if (!value.IsArray()) return -1;
+		Napi::Array array = value.As<Napi::Array>();
+		uint32_t length = array.Length();
+		if (length > INT_MAX) return SQLITE_TOOBIG;
+		if (length == 0) return sqlite3_carray_bind(handle, index, &empty, 0, SQLITE_CARRAY_INT64, SQLITE_STATIC);
+		Napi::Value first = SafeGetElement(env, array, 0);
+		if (first.IsEmpty()) return -1;
+
+		if (first.IsString()) {
+			std::vector<std::string> strings;
+			strings.reserve(length);
+			for (uint32_t i = 0; i < length; ++i) {
+				Napi::Value element = i == 0 ? first : SafeGetElement(env, array, i);
+				if (element.IsEmpty()) return -1;
+				if (!element.IsString()) return -2;
+				strings.push_back(element.As<Napi::String>().Utf8Value());
+			}
+			std::vector<const char*> pointers;
+			pointers.reserve(length);
+			for (const std::string& string : strings) pointers.push_back(string.c_str());
+			return sqlite3_carray_bind(handle, index, pointers.data(), static_cast<int>(length), SQLITE_CARRAY_TEXT, SQLITE_TRANSIENT);
+		}
+
+		std::vector<sqlite3_int64> integers;
+		std::vector<double> reals;
+		integers.reserve(length);
+		reals.reserve(length);
+		bool has_bigints = false;
+		bool integral = true;
+		for (uint32_t i = 0; i < length; ++i) {
+			Napi::Value element = i == 0 ? first : SafeGetElement(env, array, i);
+			if (element.IsEmpty()) return -1;
+			if (element.IsNumber()) {
+				double number = element.As<Napi::Number>().DoubleValue();
+				integral = integral && std::trunc(number) == number && number >= -9223372036854775808.0 && number < 9223372036854775808.0;
+				integers.push_back(integral ? static_cast<sqlite3_int64>(number) : 0);
+				reals.push_back(number);
+			} else if (element.IsBigInt()) {
+				bool lossless;
+				int64_t number = element.As<Napi::BigInt>().Int64Value(&lossless);
+				if (!lossless) return SQLITE_TOOBIG;
+				has_bigints = true;
+				integers.push_back(number);
+				reals.push_back(static_cast<double>(number));
+			} else {
+				return -2;
+			}
+		}
+		if (integral) {
+			return sqlite3_carray_bind(handle, index, integers.data(), static_cast<int>(length), SQLITE_CARRAY_INT64, SQLITE_TRANSIENT);
+		}
+		if (has_bigints) return -2;
+		return sqlite3_carray_bind(handle, index, reals.data(), static_cast<int>(length), SQLITE_CARRAY_DOUBLE, SQLITE_TRANSIENT);
+	}
+
 	void ResultValueFromJS(Napi::Env env, sqlite3_context* invocation, Napi::Value value, DataConverter* converter) {
 		JS_VALUE_TO_SQLITE(result, value, env, invocation);
 		converter->ThrowDataConversionError(env, invocation, value.IsBigInt());
@@ -0,0 +1,103 @@
+// Creates a string whose characters live in native memory owned by the string
+// itself, rather than on the JavaScript heap. The text is copied exactly once
+// (transcoded to UTF-16 if it contains non-ASCII characters), and the engine
+// never copies it again. Falls back to StringFromUtf8 when Node-API doesn't
+// support external strings, or when they can't be created.
+class ExternalString {
+public:
+
+	static Napi::Value New(Napi::Env env, const char* data, size_t length) {
+#if NAPI_VERSION >= 10
+		napi_value value;
+		bool copied;
+		if (IsAscii(data, length)) {
+			char* latin1 = static_cast<char*>(malloc(length));
+			if (latin1 != NULL) {
+				memcpy(latin1, data, length);
+				if (node_api_create_external_string_latin1(env, latin1, length, Finalize, NULL, &value, &copied) == napi_ok) {
+					return Napi::Value(env, value);
+				}
+				free(latin1);
+			}
+		} else {
+			char16_t* utf16 = static_cast<char16_t*>(malloc(length * sizeof(char16_t)));
+			if (utf16 != NULL) {
+				size_t utf16_length = TranscodeUtf8(utf16, data, length);
+				if (node_api_create_external_string_utf16(env, utf16, utf16_length, Finalize, NULL, &value, &copied) == napi_ok) {
+					return Napi::Value(env, value);
+				}
+				free(utf16);
+			}
+		}
+#endif
+		return StringFromUtf8(env, data, static_cast<int>(length));
+	}
+
+private:
+
+	// If the engine decides to copy the string anyway, this is invoked before
+	// the string is returned, so it's always safe to simply free the memory.
+	static void Finalize(node_api_basic_env env, void* data, void* hint) {
+		free(data);
+	}
+
+	// Converts UTF-8 to UTF-16, replacing each maximal invalid subsequence with
+	// U+FFFD, as specified by the WHATWG Encoding Standard (and as implemented by
+	// the engine itself). The output never has more code units than the input has
+	// bytes, so the output buffer must be able to hold at least that many.
+	static size_t TranscodeUtf8(char16_t* out, const char* data, size_t length) {
+		const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+		size_t count = 0;
+		char32_t code_point = 0;
+		int bytes_needed = 0;
+		int bytes_seen = 0;
+		unsigned char lower = 0x80;
+		unsigned char upper = 0xbf;
+		for (size_t i = 0; i < length;) {
+			unsigned char byte = bytes[i];
+			if (bytes_needed == 0) {
+				++i;
+				if (byte < 0x80) {
+					out[count++] = byte;
+				} else if (byte >= 0xc2 && byte <= 0xdf) {
+					bytes_needed = 1;
+					code_point = byte & 0x1f;
+				} else if (byte >= 0xe0 && byte <= 0xef) {
+					if (byte == 0xe0) lower = 0xa0;
+					if (byte == 0xed) upper = 0x9f;
+					bytes_needed = 2;
+					code_point = byte & 0xf;
+				} else if (byte >= 0xf0 && byte <= 0xf4) {
+					if (byte == 0xf0) lower = 0x90;
+					if (byte == 0xf4) upper = 0x8f;
+					bytes_needed = 3;
+					code_point = byte & 0x7;
+				} else {
+					out[count++] = 0xfffd;
+				}
+				continue;
+			}
+			bool valid = byte >= lower && byte <= upper;
+			lower = 0x80;
+			upper = 0xbf;
+			if (!valid) {
+				// The invalid byte is not consumed; it may start a new sequence.
+				bytes_needed = bytes_seen = 0;
+				out[count++] = 0xfffd;
+				continue;
+			}
+			++i;
+			code_point = (code_point << 6) | (byte & 0x3f);
+			if (++bytes_seen != bytes_needed) continue;
+			if (code_point > 0xffff) {
+				out[count++] = static_cast<char16_t>(0xd7c0 + (code_point >> 10));
+				out[count++] = static_cast<char16_t>(0xdc00 | (code_point & 0x3ff));
+			} else {
+				out[count++] = static_cast<char16_t>(code_point);
+			}
+			bytes_needed = bytes_seen = 0;
+		}
+		if (bytes_needed != 0) out[count++] = 0xfffd;
+		return count;
+	}
+};
@@ -1,6 +1,36 @@
+// Returns whether the given bytes are all 7-bit ASCII. Bytes are examined a
+// word at a time, which is much faster than a byte-by-byte loop on long text.
+inline bool IsAscii(const char* data, size_t length) {
+	const uint64_t high_bits = 0x8080808080808080ULL;
+	const char* end = data + length;
+	while (end - data >= 32) {
+		uint64_t words[4];
+		memcpy(words, data, 32);
+		if ((words[0] | words[1] | words[2] | words[3]) & high_bits) return false;
+		data += 32;
+	}
+	uint64_t bits = 0;
+	while (end - data >= 8) {
+		uint64_t word;
+		memcpy(&word, data, 8);
+		bits |= word;
+		data += 8;
+	}
+	while (data < end) bits |= static_cast<unsigned char>(*data++);
+	return (bits & high_bits) == 0;
+}
+
+// ASCII text is also valid Latin-1, which the engine can copy directly into a
+// one-byte string without decoding it as UTF-8.
 inline Napi::String StringFromUtf8(Napi::Env env, const char* data, int length) {
-	if (length < 0) return Napi::String::New(env, data);
-	return Napi::String::New(env, data, length);
+	size_t byte_length = length < 0 ? strlen(data) : static_cast<size_t>(length);
+	if (IsAscii(data, byte_length)) {
+		napi_value value;
+		if (napi_create_string_latin1(env, data, byte_length, &value) == napi_ok) {
+			return Napi::String(env, value);
+		}
+	}
+	return Napi::String::New(env, data, byte_length);
 }
 
 // Node-API has no equivalent of V8's internalized strings, so these are simple
@@ -179,6 +209,17 @@ inline bool IS_SKIPPED(char c) {
 	return c == ' ' || c == ';' || (c >= '\t' && c <= '\r');
 }
 
+// Quotes an SQL identifier, escaping any double quotes within it.
+inline std::string QuoteIdentifier(const std::string& name) {
+	std::string quoted = "\"";
+	for (char c : name) {
+		if (c == '"') quoted += '"';
+		quoted += c;
+	}
+	quoted += '"';
+	return quoted;
+}
+
 // Allocates an empty array, without calling constructors/initializers.
 template<class T> inline T* ALLOC_ARRAY(size_t count) {
 	return static_cast<T*>(::operator new[](count * sizeof(T)));
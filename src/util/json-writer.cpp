@@ -0,0 +1,312 @@
+JsonWriter::JsonWriter() :
+	flat_members(),
+	expanded_members(),
+	flat_reprepare_count(-1),
+	expanded_reprepare_count(-1) {}
+
+// Steps through the statement, writing each row until there are no more
+// rows or an error occurs. Rows are written as a JSON array or, if
+// newline_delimited is true, as a sequence of newline-terminated values.
+void JsonWriter::WriteRows(std::string& out, sqlite3_stmt* handle, bool safe_ints, char mode, bool newline_delimited) {
+	const std::vector<Member>* members = GetMembers(handle, mode);
+	bool first = true;
+	if (!newline_delimited) out += '[';
+	while (sqlite3_step(handle) == SQLITE_ROW) {
+		if (!newline_delimited && !first) out += ',';
+		first = false;
+		WriteRow(out, handle, safe_ints, mode, members);
+		if (newline_delimited) out += '\n';
+	}
+	if (!newline_delimited) out += ']';
+}
+
+// Writes the current row of a statement that has already been stepped.
+void JsonWriter::WriteRow(std::string& out, sqlite3_stmt* handle, bool safe_ints, char mode) {
+	WriteRow(out, handle, safe_ints, mode, GetMembers(handle, mode));
+}
+
+void JsonWriter::WriteRow(std::string& out, sqlite3_stmt* handle, bool safe_ints, char mode, const std::vector<Member>* members) {
+	if (mode == Data::PLUCK) {
+		WriteValue(out, handle, 0, safe_ints);
+	} else if (mode == Data::RAW) {
+		int column_count = sqlite3_column_count(handle);
+		out += '[';
+		for (int i = 0; i < column_count; ++i) {
+			if (i) out += ',';
+			WriteValue(out, handle, i, safe_ints);
+		}
+		out += ']';
+	} else {
+		WriteObject(out, handle, safe_ints, *members);
+	}
+}
+
+const std::vector<JsonWriter::Member>* JsonWriter::GetMembers(sqlite3_stmt* handle, char mode) {
+	if (mode == Data::FLAT || mode == Data::LAZY) return &GetFlatMembers(handle);
+	if (mode == Data::EXPAND) return &GetExpandedMembers(handle);
+	return NULL;
+}
+
+const std::vector<JsonWriter::Member>& JsonWriter::GetFlatMembers(sqlite3_stmt* handle) {
+	int current_reprepare_count = sqlite3_stmt_status(handle, SQLITE_STMTSTATUS_REPREPARE, false);
+	if (current_reprepare_count != flat_reprepare_count) {
+		flat_members.clear();
+		int column_count = sqlite3_column_count(handle);
+		for (int i = 0; i < column_count; ++i) {
+			AddMember(flat_members, sqlite3_column_name(handle, i), i);
+		}
+		OrderMembers(flat_members);
+		flat_reprepare_count = current_reprepare_count;
+	}
+	return flat_members;
+}
+
+const std::vector<JsonWriter::Member>& JsonWriter::GetExpandedMembers(sqlite3_stmt* handle) {
+	int current_reprepare_count = sqlite3_stmt_status(handle, SQLITE_STMTSTATUS_REPREPARE, false);
+	if (current_reprepare_count != expanded_reprepare_count) {
+		expanded_members.clear();
+		int column_count = sqlite3_column_count(handle);
+		for (int i = 0; i < column_count; ++i) {
+			const char* table = sqlite3_column_table_name(handle, i);
+			Member* nested = AddMember(expanded_members, table == NULL ? "$" : table, -1);
+			if (nested != NULL) AddMember(nested->members, sqlite3_column_name(handle, i), i);
+		}
+		OrderMembers(expanded_members);
+		for (Member& nested : expanded_members) OrderMembers(nested.members);
+		expanded_reprepare_count = current_reprepare_count;
+	}
+	return expanded_members;
+}
+
+// Adds a member the same way that assigning a property would. If the key
+// already exists, its value is replaced, but it keeps its position. Keys
+// named "__proto__" would not create own properties, so they're skipped.
+JsonWriter::Member* JsonWriter::AddMember(std::vector<Member>& members, const char* key, int column) {
+	if (strcmp(key, "__proto__") == 0) return NULL;
+	std::string prefix;
+	WriteString(prefix, key, strlen(key));
+	prefix += ':';
+	for (Member& member : members) {
+		if (member.prefix == prefix) {
+			if (column >= 0) member.column = column;
+			return &member;
+		}
+	}
+	members.push_back({ std::move(prefix), column, {} });
+	return &members.back();
+}
+
+// JavaScript objects list integer-like keys first, in ascending order,
+// followed by all other keys in insertion order.
+void JsonWriter::OrderMembers(std::vector<Member>& members) {
+	std::stable_sort(members.begin(), members.end(), [](const Member& a, const Member& b) {
+		double a_index = GetArrayIndex(a.prefix);
+		double b_index = GetArrayIndex(b.prefix);
+		return a_index < b_index;
+	});
+}
+
+// Returns the numeric value of an escaped key if it's a valid array index,
+// or infinity otherwise (so that other keys sort after all array indexes).
+double JsonWriter::GetArrayIndex(const std::string& prefix) {
+	const char* digits = prefix.c_str() + 1;
+	size_t length = prefix.length() - 3;
+	if (length == 0 || length > 10 || (digits[0] == '0' && length > 1)) return INFINITY;
+	double value = 0;
+	for (size_t i = 0; i < length; ++i) {
+		if (digits[i] < '0' || digits[i] > '9') return INFINITY;
+		value = value * 10 + (digits[i] - '0');
+	}
+	return value < 4294967295.0 ? value : INFINITY;
+}
+
+void JsonWriter::WriteObject(std::string& out, sqlite3_stmt* handle, bool safe_ints, const std::vector<Member>& members) {
+	out += '{';
+	bool first = true;
+	for (const Member& member : members) {
+		if (!first) out += ',';
+		first = false;
+		out += member.prefix;
+		if (member.column < 0) WriteObject(out, handle, safe_ints, member.members);
+		else WriteValue(out, handle, member.column, safe_ints);
+	}
+	out += '}';
+}
+
+void JsonWriter::WriteValue(std::string& out, sqlite3_stmt* handle, int column, bool safe_ints) {
+	switch (sqlite3_column_type(handle, column)) {
+		case SQLITE_INTEGER:
+			WriteInteger(out, sqlite3_column_int64(handle, column), safe_ints);
+			break;
+		case SQLITE_FLOAT:
+			WriteNumber(out, sqlite3_column_double(handle, column));
+			break;
+		case SQLITE_TEXT:
+			WriteString(
+				out,
+				reinterpret_cast<const char*>(sqlite3_column_text(handle, column)),
+				sqlite3_column_bytes(handle, column)
+			);
+			break;
+		case SQLITE_BLOB:
+			WriteBuffer(
+				out,
+				static_cast<const unsigned char*>(sqlite3_column_blob(handle, column)),
+				sqlite3_column_bytes(handle, column)
+			);
+			break;
+		default:
+			assert(sqlite3_column_type(handle, column) == SQLITE_NULL);
+			out += "null";
+	}
+}
+
+void JsonWriter::WriteInteger(std::string& out, sqlite3_int64 value, bool safe_ints) {
+	const sqlite3_int64 max_safe_integer = 9007199254740991;
+	if (!safe_ints && (value > max_safe_integer || value < -max_safe_integer)) {
+		WriteNumber(out, static_cast<double>(value));
+		return;
+	}
+	char buffer[24];
+	std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), static_cast<int64_t>(value));
+	out.append(buffer, result.ptr);
+}
+
+// Replicates Number.prototype.toString(), which JSON.stringify() uses.
+void JsonWriter::WriteNumber(std::string& out, double value) {
+	if (!std::isfinite(value)) {
+		out += "null";
+		return;
+	}
+	if (value == 0) {
+		out += '0';
+		return;
+	}
+	if (value < 0) {
+		out += '-';
+		value = -value;
+	}
+
+	// Get the shortest round-trip digits, in the form "d.ddde[+-]xx".
+	char buffer[32];
+	std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::scientific);
+	char* exponent_start = std::find(buffer, result.ptr, 'e');
+	char digits[20];
+	int k = 0;
+	for (char* c = buffer; c < exponent_start; ++c) {
+		if (*c != '.') digits[k++] = *c;
+	}
+	int exponent = 0;
+	const char* exponent_digits = exponent_start + 1;
+	if (*exponent_digits == '+') ++exponent_digits;
+	std::from_chars(exponent_digits, result.ptr, exponent);
+	int n = exponent + 1;
+
+	if (k <= n && n <= 21) {
+		out.append(digits, k);
+		out.append(n - k, '0');
+	} else if (0 < n && n <= 21) {
+		out.append(digits, n);
+		out += '.';
+		out.append(digits + n, k - n);
+	} else if (-6 < n && n <= 0) {
+		out += "0.";
+		out.append(-n, '0');
+		out.append(digits, k);
+	} else {
+		out += digits[0];
+		if (k > 1) {
+			out += '.';
+			out.append(digits + 1, k - 1);
+		}
+		out += n - 1 < 0 ? "e-" : "e+";
+		out += std::to_string(std::abs(n - 1));
+	}
+}
+
+// Writes a quoted and escaped string. Invalid UTF-8 sequences are replaced
+// with U+FFFD, just like they are when SQLite text is converted to a string.
+void JsonWriter::WriteString(std::string& out, const char* data, size_t length) {
+	static const char hex[] = "0123456789abcdef";
+	const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+	out.reserve(out.size() + length + 2);
+	out += '"';
+	size_t i = 0;
+	while (i < length) {
+		size_t start = i;
+		while (i < length && bytes[i] >= 0x20 && bytes[i] < 0x80 && bytes[i] != '"' && bytes[i] != '\\') ++i;
+		out.append(data + start, i - start);
+		if (i == length) break;
+		unsigned char byte = bytes[i];
+		if (byte < 0x80) {
+			++i;
+			switch (byte) {
+				case '"': out += "\\\""; break;
+				case '\\': out += "\\\\"; break;
+				case '\b': out += "\\b"; break;
+				case '\f': out += "\\f"; break;
+				case '\n': out += "\\n"; break;
+				case '\r': out += "\\r"; break;
+				case '\t': out += "\\t"; break;
+				default:
+					out += "\\u00";
+					out += hex[byte >> 4];
+					out += hex[byte & 0xf];
+			}
+			continue;
+		}
+		size_t sequence_length = GetUtf8SequenceLength(bytes + i, length - i);
+		if (sequence_length > 0) {
+			out.append(data + i, sequence_length);
+			i += sequence_length;
+		} else {
+			out += "\xef\xbf\xbd";
+			i += GetInvalidUtf8Length(bytes + i, length - i);
+		}
+	}
+	out += '"';
+}
+
+// Returns the length of the valid UTF-8 sequence that starts with a non-ASCII
+// byte at the given position, or 0 if the sequence is invalid.
+size_t JsonWriter::GetUtf8SequenceLength(const unsigned char* bytes, size_t available) {
+	size_t invalid_length = GetInvalidUtf8Length(bytes, available);
+	return invalid_length == 0 ? GetExpectedUtf8Length(bytes[0]) : 0;
+}
+
+// Returns how many bytes make up the maximal invalid subsequence that starts
+// at the given position (as defined by the WHATWG Encoding Standard), or 0
+// if the sequence is valid.
+size_t JsonWriter::GetInvalidUtf8Length(const unsigned char* bytes, size_t available) {
+	unsigned char lead = bytes[0];
+	size_t expected = GetExpectedUtf8Length(lead);
+	if (expected == 0) return 1;
+	unsigned char lower = lead == 0xe0 ? 0xa0 : lead == 0xf0 ? 0x90 : 0x80;
+	unsigned char upper = lead == 0xed ? 0x9f : lead == 0xf4 ? 0x8f : 0xbf;
+	for (size_t j = 1; j < expected; ++j) {
+		if (j >= available || bytes[j] < lower || bytes[j] > upper) return j;
+		lower = 0x80;
+		upper = 0xbf;
+	}
+	return 0;
+}
+
+size_t JsonWriter::GetExpectedUtf8Length(unsigned char lead) {
+	if (lead >= 0xc2 && lead <= 0xdf) return 2;
+	if (lead >= 0xe0 && lead <= 0xef) return 3;
+	if (lead >= 0xf0 && lead <= 0xf4) return 4;
+	return 0;
+}
+
+// Replicates Buffer.prototype.toJSON().
+void JsonWriter::WriteBuffer(std::string& out, const unsigned char* data, int length) {
+	out += "{\"type\":\"Buffer\",\"data\":[";
+	for (int i = 0; i < length; ++i) {
+		if (i) out += ',';
+		unsigned char byte = data[i];
+		if (byte >= 100) out += static_cast<char>('0' + byte / 100);
+		if (byte >= 10) out += static_cast<char>('0' + byte / 10 % 10);
+		out += static_cast<char>('0' + byte % 10);
+	}
+	out += "]}";
+}
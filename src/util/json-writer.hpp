@@ -0,0 +1,50 @@
+// Serializes result rows directly to JSON text, without creating intermediate
+// JavaScript values. The output is identical to what JSON.stringify() would
+// produce for the rows returned by Statement#all() in the same mode (except
+// that safe integers are written as exact integer literals, since BigInts have
+// no JSON representation). The layout of row objects (i.e., the escaped keys
+// and their order) is computed once and reused for every row/query, and it's
+// rebuilt if SQLite reparses the statement after a schema change.
+class JsonWriter {
+public:
+
+	explicit JsonWriter();
+
+	void WriteRows(std::string& out, sqlite3_stmt* handle, bool safe_ints, char mode, bool newline_delimited);
+	void WriteRow(std::string& out, sqlite3_stmt* handle, bool safe_ints, char mode);
+
+	// These are also used by CsvWriter.
+	static void WriteInteger(std::string& out, sqlite3_int64 value, bool safe_ints);
+	static void WriteNumber(std::string& out, double value);
+
+private:
+
+	// A property of a row object. If column is negative, the property's value
+	// is a nested object (as in expanded rows), described by members.
+	struct Member {
+		std::string prefix; // The escaped key, including the quotes and colon.
+		int column;
+		std::vector<Member> members;
+	};
+
+	const std::vector<Member>* GetMembers(sqlite3_stmt* handle, char mode);
+	const std::vector<Member>& GetFlatMembers(sqlite3_stmt* handle);
+	const std::vector<Member>& GetExpandedMembers(sqlite3_stmt* handle);
+	static Member* AddMember(std::vector<Member>& members, const char* key, int column);
+	static void OrderMembers(std::vector<Member>& members);
+	static double GetArrayIndex(const std::string& prefix);
+
+	static void WriteRow(std::string& out, sqlite3_stmt* handle, bool safe_ints, char mode, const std::vector<Member>* members);
+	static void WriteObject(std::string& out, sqlite3_stmt* handle, bool safe_ints, const std::vector<Member>& members);
+	static void WriteValue(std::string& out, sqlite3_stmt* handle, int column, bool safe_ints);
+	static void WriteString(std::string& out, const char* data, size_t length);
+	static void WriteBuffer(std::string& out, const unsigned char* data, int length);
+	static size_t GetUtf8SequenceLength(const unsigned char* bytes, size_t available);
+	static size_t GetInvalidUtf8Length(const unsigned char* bytes, size_t available);
+	static size_t GetExpectedUtf8Length(unsigned char lead);
+
+	std::vector<Member> flat_members;
+	std::vector<Member> expanded_members;
+	int flat_reprepare_count;
+	int expanded_reprepare_count;
+};
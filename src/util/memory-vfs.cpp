@@ -0,0 +1,405 @@
+// An in-memory VFS whose files are shared by every connection in the process
+// (including connections in other worker threads), keyed by filename. Unlike
+// ":memory:" databases, a database opened through this VFS can be used by many
+// connections at once. Unlike SQLite's built-in "memdb" VFS, it implements the
+// shared-memory methods, so it supports WAL mode, allowing readers to run
+// concurrently with a writer. A database (along with its journal and WAL) is
+// discarded when its last connection is closed.
+class MemoryVFS {
+public:
+
+	static constexpr const char* NAME = "memory";
+
+	// Registers the VFS with SQLite. This is safe to call more than once.
+	static void Register() {
+		static std::once_flag init_flag;
+		std::call_once(init_flag, [](){
+			static sqlite3_vfs vfs = {};
+			vfs.iVersion = 2;
+			vfs.szOsFile = sizeof(File);
+			vfs.mxPathname = 512;
+			vfs.zName = NAME;
+			vfs.pAppData = sqlite3_vfs_find(NULL);
+			vfs.xOpen = Open;
+			vfs.xDelete = Delete;
+			vfs.xAccess = Access;
+			vfs.xFullPathname = FullPathname;
+			vfs.xRandomness = Randomness;
+			vfs.xSleep = Sleep;
+			vfs.xCurrentTime = CurrentTime;
+			vfs.xGetLastError = GetLastError;
+			vfs.xCurrentTimeInt64 = CurrentTimeInt64;
+			assert(vfs.pAppData != NULL);
+			int status = sqlite3_vfs_register(&vfs, 0);
+			assert(status == SQLITE_OK); ((void)status);
+		});
+	}
+
+private:
+
+	// The contents and lock state of a file, shared by all of its handles.
+	// Contents are guarded by a reader-writer lock so that many connections can
+	// read at once. Everything else is guarded by lock_mutex.
+	struct Storage {
+		Storage() : shared(0), reserved(false), pending(false), exclusive(false), open_count(0), shm_count(0), shm_shared(), shm_exclusive() {}
+		~Storage() { FreeRegions(); }
+
+		void FreeRegions() {
+			for (char* region : regions) delete[] region;
+			regions.clear();
+		}
+
+		std::shared_mutex contents_mutex;
+		std::vector<char> contents;
+		std::mutex lock_mutex;
+		int shared;
+		bool reserved;
+		bool pending;
+		bool exclusive;
+		int open_count; // Guarded by registry_mutex instead of lock_mutex.
+		int shm_count;
+		int shm_shared[SQLITE_SHM_NLOCK];
+		bool shm_exclusive[SQLITE_SHM_NLOCK];
+		std::vector<char*> regions;
+	};
+
+	// The state of a single file handle. SQLite allocates the memory, so this
+	// is constructed and destroyed manually by Open() and Close().
+	struct File {
+		sqlite3_file base;
+		std::shared_ptr<Storage> storage;
+		std::string name;
+		int lock;
+		bool holds_reserved;
+		bool is_main_db;
+		bool delete_on_close;
+		bool shm_mapped;
+		uint16_t shm_shared_mask;
+		uint16_t shm_exclusive_mask;
+	};
+
+	static std::mutex registry_mutex;
+	static std::map<std::string, std::shared_ptr<Storage>>& Registry() {
+		static std::map<std::string, std::shared_ptr<Storage>> registry;
+		return registry;
+	}
+
+	static inline Storage* GetStorage(sqlite3_file* file) {
+		return reinterpret_cast<File*>(file)->storage.get();
+	}
+
+	static inline sqlite3_vfs* DefaultVFS(sqlite3_vfs* vfs) {
+		return static_cast<sqlite3_vfs*>(vfs->pAppData);
+	}
+
+	static int Open(sqlite3_vfs* vfs, const char* name, sqlite3_file* file, int flags, int* out_flags) {
+		std::shared_ptr<Storage> storage;
+		if (name == NULL) {
+			storage = std::make_shared<Storage>();
+		} else {
+			std::lock_guard<std::mutex> guard(registry_mutex);
+			auto it = Registry().find(name);
+			if (it == Registry().end()) {
+				if (!(flags & SQLITE_OPEN_CREATE)) return SQLITE_CANTOPEN;
+				storage = std::make_shared<Storage>();
+				Registry()[name] = storage;
+			} else {
+				if (flags & SQLITE_OPEN_EXCLUSIVE) return SQLITE_CANTOPEN;
+				storage = it->second;
+			}
+			storage->open_count += 1;
+		}
+
+		static const sqlite3_io_methods methods = {
+			2,
+			Close,
+			Read,
+			Write,
+			Truncate,
+			Sync,
+			FileSize,
+			Lock,
+			Unlock,
+			CheckReservedLock,
+			FileControl,
+			SectorSize,
+			DeviceCharacteristics,
+			ShmMap,
+			ShmLock,
+			ShmBarrier,
+			ShmUnmap,
+			NULL,
+			NULL,
+		};
+		File* f = new (file) File();
+		f->base.pMethods = &methods;
+		f->storage = std::move(storage);
+		f->name = name != NULL ? name : "";
+		f->lock = SQLITE_LOCK_NONE;
+		f->holds_reserved = false;
+		f->is_main_db = (flags & SQLITE_OPEN_MAIN_DB) != 0;
+		f->delete_on_close = name != NULL && (flags & SQLITE_OPEN_DELETEONCLOSE) != 0;
+		if (out_flags != NULL) *out_flags = flags;
+		return SQLITE_OK;
+	}
+
+	static int Close(sqlite3_file* file) {
+		File* f = reinterpret_cast<File*>(file);
+		Unlock(file, SQLITE_LOCK_NONE);
+		ShmUnmap(file, 0);
+		if (!f->name.empty()) {
+			std::lock_guard<std::mutex> guard(registry_mutex);
+			f->storage->open_count -= 1;
+			if (f->delete_on_close) {
+				Unregister(f->name, f->storage.get());
+			} else if (f->is_main_db && f->storage->open_count == 0) {
+				Unregister(f->name, f->storage.get());
+				Unregister(f->name + "-journal", NULL);
+				Unregister(f->name + "-wal", NULL);
+			}
+		}
+		f->~File();
+		return SQLITE_OK;
+	}
+
+	// Removes a file from the registry (if it's the given file, or any file if
+	// NULL is given). Handles that are still open keep their contents alive.
+	static void Unregister(const std::string& name, Storage* storage) {
+		auto it = Registry().find(name);
+		if (it != Registry().end() && (storage == NULL || it->second.get() == storage)) {
+			Registry().erase(it);
+		}
+	}
+
+	static int Read(sqlite3_file* file, void* buffer, int amount, sqlite3_int64 offset) {
+		Storage* s = GetStorage(file);
+		std::shared_lock<std::shared_mutex> guard(s->contents_mutex);
+		size_t size = s->contents.size();
+		size_t start = static_cast<size_t>(offset);
+		size_t available = start < size ? std::min(size - start, static_cast<size_t>(amount)) : 0;
+		if (available > 0) memcpy(buffer, s->contents.data() + start, available);
+		if (available == static_cast<size_t>(amount)) return SQLITE_OK;
+		memset(static_cast<char*>(buffer) + available, 0, amount - available);
+		return SQLITE_IOERR_SHORT_READ;
+	}
+
+	static int Write(sqlite3_file* file, const void* buffer, int amount, sqlite3_int64 offset) {
+		Storage* s = GetStorage(file);
+		std::unique_lock<std::shared_mutex> guard(s->contents_mutex);
+		size_t end = static_cast<size_t>(offset) + static_cast<size_t>(amount);
+		if (end > s->contents.size()) s->contents.resize(end);
+		memcpy(s->contents.data() + offset, buffer, amount);
+		return SQLITE_OK;
+	}
+
+	static int Truncate(sqlite3_file* file, sqlite3_int64 size) {
+		Storage* s = GetStorage(file);
+		std::unique_lock<std::shared_mutex> guard(s->contents_mutex);
+		if (static_cast<size_t>(size) < s->contents.size()) s->contents.resize(size);
+		return SQLITE_OK;
+	}
+
+	static int Sync(sqlite3_file* file, int flags) {
+		return SQLITE_OK;
+	}
+
+	static int FileSize(sqlite3_file* file, sqlite3_int64* size) {
+		Storage* s = GetStorage(file);
+		std::shared_lock<std::shared_mutex> guard(s->contents_mutex);
+		*size = static_cast<sqlite3_int64>(s->contents.size());
+		return SQLITE_OK;
+	}
+
+	// These implement SQLite's file locking protocol among the handles of a
+	// file, with the same semantics as the POSIX advisory locks used by the
+	// default VFS. SQLite never requests a PENDING lock directly.
+	static int Lock(sqlite3_file* file, int level) {
+		File* f = reinterpret_cast<File*>(file);
+		Storage* s = f->storage.get();
+		std::lock_guard<std::mutex> guard(s->lock_mutex);
+		if (f->lock >= level) return SQLITE_OK;
+		switch (level) {
+			case SQLITE_LOCK_SHARED:
+				if (s->pending || s->exclusive) return SQLITE_BUSY;
+				s->shared += 1;
+				break;
+			case SQLITE_LOCK_RESERVED:
+				if (s->reserved) return SQLITE_BUSY;
+				s->reserved = true;
+				f->holds_reserved = true;
+				break;
+			case SQLITE_LOCK_EXCLUSIVE:
+				if (f->lock < SQLITE_LOCK_PENDING) {
+					if (s->pending || (s->reserved && !f->holds_reserved)) return SQLITE_BUSY;
+					s->pending = true;
+					f->lock = SQLITE_LOCK_PENDING;
+				}
+				if (s->shared > 1) return SQLITE_BUSY;
+				s->exclusive = true;
+				break;
+			default:
+				return SQLITE_MISUSE;
+		}
+		f->lock = level;
+		return SQLITE_OK;
+	}
+
+	static int Unlock(sqlite3_file* file, int level) {
+		File* f = reinterpret_cast<File*>(file);
+		Storage* s = f->storage.get();
+		std::lock_guard<std::mutex> guard(s->lock_mutex);
+		if (f->lock <= level) return SQLITE_OK;
+		if (f->lock >= SQLITE_LOCK_PENDING) s->pending = false;
+		if (f->lock == SQLITE_LOCK_EXCLUSIVE) s->exclusive = false;
+		if (f->holds_reserved) {
+			s->reserved = false;
+			f->holds_reserved = false;
+		}
+		if (level == SQLITE_LOCK_NONE) s->shared -= 1;
+		f->lock = level;
+		return SQLITE_OK;
+	}
+
+	static int CheckReservedLock(sqlite3_file* file, int* result) {
+		Storage* s = GetStorage(file);
+		std::lock_guard<std::mutex> guard(s->lock_mutex);
+		*result = s->reserved || s->pending || s->exclusive;
+		return SQLITE_OK;
+	}
+
+	static int FileControl(sqlite3_file* file, int op, void* arg) {
+		if (op == SQLITE_FCNTL_VFSNAME) {
+			*static_cast<char**>(arg) = sqlite3_mprintf("%s", NAME);
+			return SQLITE_OK;
+		}
+		return SQLITE_NOTFOUND;
+	}
+
+	static int SectorSize(sqlite3_file* file) {
+		return 4096;
+	}
+
+	static int DeviceCharacteristics(sqlite3_file* file) {
+		return SQLITE_IOCAP_ATOMIC | SQLITE_IOCAP_SAFE_APPEND | SQLITE_IOCAP_SEQUENTIAL | SQLITE_IOCAP_POWERSAFE_OVERWRITE;
+	}
+
+	// Shared memory for WAL mode. Regions are allocated separately so that the
+	// pointers given to SQLite remain valid as more regions are added. They're
+	// freed when the last handle unmaps them, at which point SQLite considers
+	// the wal-index to be rebuildable anyway.
+	static int ShmMap(sqlite3_file* file, int index, int region_size, int extend, void volatile** result) {
+		File* f = reinterpret_cast<File*>(file);
+		Storage* s = f->storage.get();
+		std::lock_guard<std::mutex> guard(s->lock_mutex);
+		if (!f->shm_mapped) {
+			f->shm_mapped = true;
+			s->shm_count += 1;
+		}
+		if (static_cast<size_t>(index) >= s->regions.size()) {
+			if (!extend) {
+				*result = NULL;
+				return SQLITE_OK;
+			}
+			while (s->regions.size() <= static_cast<size_t>(index)) {
+				s->regions.push_back(new char[region_size]());
+			}
+		}
+		*result = s->regions[index];
+		return SQLITE_OK;
+	}
+
+	static int ShmLock(sqlite3_file* file, int offset, int n, int flags) {
+		File* f = reinterpret_cast<File*>(file);
+		Storage* s = f->storage.get();
+		std::lock_guard<std::mutex> guard(s->lock_mutex);
+		const uint16_t mask = static_cast<uint16_t>(((1 << n) - 1) << offset);
+		if (flags & SQLITE_SHM_UNLOCK) {
+			for (int i = offset; i < offset + n; ++i) {
+				if (f->shm_shared_mask & (1 << i)) s->shm_shared[i] -= 1;
+				if (f->shm_exclusive_mask & (1 << i)) s->shm_exclusive[i] = false;
+			}
+			f->shm_shared_mask &= ~mask;
+			f->shm_exclusive_mask &= ~mask;
+		} else if (flags & SQLITE_SHM_SHARED) {
+			assert(n == 1);
+			if (f->shm_shared_mask & mask) return SQLITE_OK;
+			if (s->shm_exclusive[offset]) return SQLITE_BUSY;
+			s->shm_shared[offset] += 1;
+			f->shm_shared_mask |= mask;
+		} else {
+			for (int i = offset; i < offset + n; ++i) {
+				if (f->shm_exclusive_mask & (1 << i)) continue;
+				if (s->shm_exclusive[i] || s->shm_shared[i] > 0) return SQLITE_BUSY;
+			}
+			for (int i = offset; i < offset + n; ++i) s->shm_exclusive[i] = true;
+			f->shm_exclusive_mask |= mask;
+		}
+		return SQLITE_OK;
+	}
+
+	static void ShmBarrier(sqlite3_file* file) {
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+	}
+
+	static int ShmUnmap(sqlite3_file* file, int delete_flag) {
+		File* f = reinterpret_cast<File*>(file);
+		if (!f->shm_mapped) return SQLITE_OK;
+		if (f->shm_shared_mask | f->shm_exclusive_mask) ShmLock(file, 0, SQLITE_SHM_NLOCK, SQLITE_SHM_UNLOCK);
+		Storage* s = f->storage.get();
+		std::lock_guard<std::mutex> guard(s->lock_mutex);
+		f->shm_mapped = false;
+		if (--s->shm_count == 0) s->FreeRegions();
+		return SQLITE_OK;
+	}
+
+	static int Delete(sqlite3_vfs* vfs, const char* name, int sync_dir) {
+		std::lock_guard<std::mutex> guard(registry_mutex);
+		Unregister(name, NULL);
+		return SQLITE_OK;
+	}
+
+	// Like the default VFS, empty files are reported as nonexistent.
+	static int Access(sqlite3_vfs* vfs, const char* name, int flags, int* result) {
+		std::lock_guard<std::mutex> guard(registry_mutex);
+		auto it = Registry().find(name);
+		*result = 0;
+		if (it != Registry().end()) {
+			if (flags != SQLITE_ACCESS_EXISTS) {
+				*result = 1;
+			} else {
+				std::shared_lock<std::shared_mutex> contents_guard(it->second->contents_mutex);
+				*result = !it->second->contents.empty();
+			}
+		}
+		return SQLITE_OK;
+	}
+
+	static int FullPathname(sqlite3_vfs* vfs, const char* name, int length, char* result) {
+		size_t name_length = strlen(name);
+		if (name_length >= static_cast<size_t>(length)) return SQLITE_CANTOPEN;
+		memcpy(result, name, name_length + 1);
+		return SQLITE_OK;
+	}
+
+	static int Randomness(sqlite3_vfs* vfs, int length, char* result) {
+		return DefaultVFS(vfs)->xRandomness(DefaultVFS(vfs), length, result);
+	}
+
+	static int Sleep(sqlite3_vfs* vfs, int microseconds) {
+		return DefaultVFS(vfs)->xSleep(DefaultVFS(vfs), microseconds);
+	}
+
+	static int CurrentTime(sqlite3_vfs* vfs, double* result) {
+		return DefaultVFS(vfs)->xCurrentTime(DefaultVFS(vfs), result);
+	}
+
+	static int GetLastError(sqlite3_vfs* vfs, int length, char* result) {
+		return DefaultVFS(vfs)->xGetLastError(DefaultVFS(vfs), length, result);
+	}
+
+	static int CurrentTimeInt64(sqlite3_vfs* vfs, sqlite3_int64* result) {
+		return DefaultVFS(vfs)->xCurrentTimeInt64(DefaultVFS(vfs), result);
+	}
+};
+
+std::mutex MemoryVFS::registry_mutex;
@@ -0,0 +1,234 @@
+// A page cache for SQLite (SQLITE_CONFIG_PCACHE2) with a single memory budget
+// for the whole process. Instead of each connection keeping up to its own
+// cache_size worth of pages, the unpinned pages of every connection share one
+// LRU list, and the least recently used pages are evicted (from whichever
+// connection they belong to) whenever the budget would be exceeded. This lets
+// busy connections use the memory that idle connections aren't using.
+// Non-purgeable caches (used by in-memory databases) hold their pages until
+// they're discarded, so they're not counted against the budget.
+class PageCache {
+public:
+
+	struct Stats {
+		sqlite3_int64 budget;
+		sqlite3_int64 bytes_in_use;
+		sqlite3_uint64 evictions;
+	};
+
+	// Installs the page cache. This must be invoked before SQLite is
+	// initialized.
+	static bool Install(sqlite3_int64 budget) {
+		static const sqlite3_pcache_methods2 methods = {
+			1,
+			NULL,
+			[](void*) { return SQLITE_OK; },
+			[](void*) {},
+			Create,
+			CacheSize,
+			PageCount,
+			Fetch,
+			Unpin,
+			Rekey,
+			Truncate,
+			Destroy,
+			Shrink,
+		};
+		if (sqlite3_config(SQLITE_CONFIG_PCACHE2, &methods) != SQLITE_OK) return false;
+		PageCache::budget = budget;
+		installed = true;
+		return true;
+	}
+
+	static inline bool IsInstalled() { return installed; }
+
+	static Stats GetStats() {
+		std::lock_guard<std::mutex> guard(mutex);
+		return { budget, bytes_in_use, evictions };
+	}
+
+private:
+
+	struct Cache;
+
+	// The page's content and its extra bytes are stored immediately after
+	// this struct.
+	struct Page {
+		sqlite3_pcache_page base;
+		Cache* cache;
+		unsigned int key;
+		bool pinned;
+		Page* lru_prev;
+		Page* lru_next;
+	};
+
+	struct Cache {
+		int page_size;
+		int extra_size;
+		bool purgeable;
+		std::unordered_map<unsigned int, Page*> pages;
+
+		inline sqlite3_int64 PageBytes() const {
+			return static_cast<sqlite3_int64>(sizeof(Page)) + page_size + extra_size;
+		}
+	};
+
+	static std::mutex mutex;
+	static sqlite3_int64 budget;
+	static sqlite3_int64 bytes_in_use;
+	static sqlite3_uint64 evictions;
+	static Page lru; // The sentinel of the circular LRU list (most recent first).
+	static bool installed;
+
+	static inline Cache* ToCache(sqlite3_pcache* cache) {
+		return reinterpret_cast<Cache*>(cache);
+	}
+
+	static inline Page* ToPage(sqlite3_pcache_page* page) {
+		return reinterpret_cast<Page*>(page);
+	}
+
+	static void LinkLRU(Page* page) {
+		if (lru.lru_next == NULL) lru.lru_next = lru.lru_prev = &lru;
+		page->lru_prev = &lru;
+		page->lru_next = lru.lru_next;
+		lru.lru_next->lru_prev = page;
+		lru.lru_next = page;
+	}
+
+	static void UnlinkLRU(Page* page) {
+		if (page->lru_next == NULL) return;
+		page->lru_prev->lru_next = page->lru_next;
+		page->lru_next->lru_prev = page->lru_prev;
+		page->lru_prev = page->lru_next = NULL;
+	}
+
+	// Removes the page from its cache and frees it. The mutex must be held.
+	static void RemovePage(Page* page) {
+		Cache* cache = page->cache;
+		UnlinkLRU(page);
+		cache->pages.erase(page->key);
+		if (cache->purgeable) bytes_in_use -= cache->PageBytes();
+		free(page);
+	}
+
+	// Evicts unpinned pages, least recently used first, until the given number
+	// of bytes fits within the budget. The mutex must be held.
+	static bool MakeRoom(sqlite3_int64 bytes) {
+		while (bytes_in_use + bytes > budget) {
+			if (lru.lru_prev == NULL || lru.lru_prev == &lru) return false;
+			RemovePage(lru.lru_prev);
+			evictions += 1;
+		}
+		return true;
+	}
+
+	static sqlite3_pcache* Create(int page_size, int extra_size, int purgeable) {
+		Cache* cache = new (std::nothrow) Cache();
+		if (cache == NULL) return NULL;
+		cache->page_size = page_size;
+		cache->extra_size = extra_size;
+		cache->purgeable = purgeable != 0;
+		return reinterpret_cast<sqlite3_pcache*>(cache);
+	}
+
+	// The budget replaces each connection's own cache_size limit.
+	static void CacheSize(sqlite3_pcache* cache, int max_pages) {}
+
+	static int PageCount(sqlite3_pcache* cache) {
+		std::lock_guard<std::mutex> guard(mutex);
+		return static_cast<int>(ToCache(cache)->pages.size());
+	}
+
+	static sqlite3_pcache_page* Fetch(sqlite3_pcache* _cache, unsigned int key, int create_flag) {
+		Cache* cache = ToCache(_cache);
+		std::lock_guard<std::mutex> guard(mutex);
+		auto element = cache->pages.find(key);
+		if (element != cache->pages.end()) {
+			Page* page = element->second;
+			UnlinkLRU(page);
+			page->pinned = true;
+			return &page->base;
+		}
+		if (create_flag == 0) return NULL;
+
+		// When create_flag is 1, SQLite prefers to spill its dirty pages rather
+		// than exceed the budget, and then asks again with create_flag 2.
+		sqlite3_int64 bytes = cache->PageBytes();
+		if (cache->purgeable && !MakeRoom(bytes) && create_flag == 1) return NULL;
+		Page* page = static_cast<Page*>(malloc(static_cast<size_t>(bytes)));
+		if (page == NULL) return NULL;
+		char* buffer = reinterpret_cast<char*>(page + 1);
+		page->base.pBuf = buffer;
+		page->base.pExtra = buffer + cache->page_size;
+		page->cache = cache;
+		page->key = key;
+		page->pinned = true;
+		page->lru_prev = page->lru_next = NULL;
+		memset(page->base.pExtra, 0, static_cast<size_t>(cache->extra_size));
+		cache->pages.emplace(key, page);
+		if (cache->purgeable) bytes_in_use += bytes;
+		return &page->base;
+	}
+
+	static void Unpin(sqlite3_pcache* cache, sqlite3_pcache_page* _page, int discard) {
+		Page* page = ToPage(_page);
+		std::lock_guard<std::mutex> guard(mutex);
+		if (discard) {
+			RemovePage(page);
+			return;
+		}
+		page->pinned = false;
+		if (ToCache(cache)->purgeable) {
+			LinkLRU(page);
+			MakeRoom(0);
+		}
+	}
+
+	static void Rekey(sqlite3_pcache* _cache, sqlite3_pcache_page* _page, unsigned int old_key, unsigned int new_key) {
+		Cache* cache = ToCache(_cache);
+		Page* page = ToPage(_page);
+		std::lock_guard<std::mutex> guard(mutex);
+		auto element = cache->pages.find(new_key);
+		if (element != cache->pages.end()) RemovePage(element->second);
+		cache->pages.erase(old_key);
+		page->key = new_key;
+		cache->pages.emplace(new_key, page);
+	}
+
+	// Discards every page whose key is greater than or equal to the limit.
+	static void Truncate(sqlite3_pcache* _cache, unsigned int limit) {
+		Cache* cache = ToCache(_cache);
+		std::lock_guard<std::mutex> guard(mutex);
+		for (auto element = cache->pages.begin(); element != cache->pages.end();) {
+			Page* page = element->second;
+			++element;
+			if (page->key >= limit) RemovePage(page);
+		}
+	}
+
+	static void Destroy(sqlite3_pcache* _cache) {
+		Cache* cache = ToCache(_cache);
+		{
+			std::lock_guard<std::mutex> guard(mutex);
+			while (!cache->pages.empty()) RemovePage(cache->pages.begin()->second);
+		}
+		delete cache;
+	}
+
+	static void Shrink(sqlite3_pcache* _cache) {
+		Cache* cache = ToCache(_cache);
+		std::lock_guard<std::mutex> guard(mutex);
+		for (auto element = cache->pages.begin(); element != cache->pages.end();) {
+			Page* page = element->second;
+			++element;
+			if (!page->pinned) RemovePage(page);
+		}
+	}
+};
+
+std::mutex PageCache::mutex;
+sqlite3_int64 PageCache::budget = 0;
+sqlite3_int64 PageCache::bytes_in_use = 0;
+sqlite3_uint64 PageCache::evictions = 0;
+PageCache::Page PageCache::lru = {};
+bool PageCache::installed = false;
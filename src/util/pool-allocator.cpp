@@ -0,0 +1,211 @@
+// A size-class pool allocator for SQLite's memory (SQLITE_CONFIG_MALLOC). Each
+// thread keeps its own free lists of recently freed blocks, so allocations made
+// by connections in different worker threads don't contend on the system
+// allocator's locks. Blocks larger than the largest size class bypass the
+// pools. A block can be freed by any thread, in which case it joins that
+// thread's pool. Statistics are kept per thread and summed on demand.
+class PoolAllocator {
+public:
+
+	struct Stats {
+		sqlite3_uint64 allocations;
+		sqlite3_uint64 frees;
+		sqlite3_uint64 pool_hits;
+		sqlite3_int64 bytes_in_use;
+		sqlite3_int64 bytes_pooled;
+	};
+
+	// Installs the allocator. This must be invoked before SQLite is initialized.
+	static bool Install() {
+		static const sqlite3_mem_methods methods = {
+			Malloc,
+			Free,
+			Realloc,
+			Size,
+			Roundup,
+			[](void*) { return SQLITE_OK; },
+			[](void*) {},
+			NULL,
+		};
+		installed = sqlite3_config(SQLITE_CONFIG_MALLOC, &methods) == SQLITE_OK;
+		return installed;
+	}
+
+	static inline bool IsInstalled() { return installed; }
+
+	static Stats GetStats() {
+		std::lock_guard<std::mutex> guard(registry_mutex);
+		Stats stats = retired;
+		for (ThreadPool* pool : Registry()) pool->AddTo(stats);
+		return stats;
+	}
+
+private:
+
+	static constexpr int CLASS_COUNT = 20;
+	static constexpr int CLASS_SIZES[CLASS_COUNT] = {
+		16, 32, 48, 64, 96, 128, 192, 256, 384, 512, 768,
+		1024, 1536, 2048, 3072, 4096, 4608, 5120, 6144, 8192,
+	};
+	static constexpr int LARGE = -1;
+	static constexpr size_t MAX_POOLED_BYTES_PER_CLASS = 256 * 1024;
+
+	// Precedes every block. Its size keeps the payload 16-byte aligned.
+	struct alignas(16) Header {
+		sqlite3_int64 size;
+		int size_class;
+		Header* next;
+	};
+
+	// Counters are only written by the owning thread, but may be read by any
+	// thread (in GetStats()), so they're atomic with relaxed ordering, which
+	// costs no more than plain loads and stores.
+	struct Counter {
+		std::atomic<sqlite3_int64> value{0};
+		inline void Add(sqlite3_int64 n) { value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed); }
+		inline sqlite3_int64 Get() const { return value.load(std::memory_order_relaxed); }
+	};
+
+	struct ThreadPool {
+		Header* free_lists[CLASS_COUNT] = {};
+		int free_counts[CLASS_COUNT] = {};
+		Counter allocations;
+		Counter frees;
+		Counter pool_hits;
+		Counter bytes_in_use;
+		Counter bytes_pooled;
+
+		void AddTo(Stats& stats) const {
+			stats.allocations += allocations.Get();
+			stats.frees += frees.Get();
+			stats.pool_hits += pool_hits.Get();
+			stats.bytes_in_use += bytes_in_use.Get();
+			stats.bytes_pooled += bytes_pooled.Get();
+		}
+
+		~ThreadPool() {
+			for (int i = 0; i < CLASS_COUNT; ++i) {
+				for (Header* block = free_lists[i]; block != NULL;) {
+					Header* next = block->next;
+					free(block);
+					block = next;
+				}
+			}
+			bytes_pooled.Add(-bytes_pooled.Get());
+			std::lock_guard<std::mutex> guard(registry_mutex);
+			AddTo(retired);
+			Registry().erase(this);
+			thread_pool = NULL;
+			thread_exited = true;
+		}
+	};
+
+	// The pointer is trivially destructible, so it remains usable while other
+	// thread-local objects are being destroyed; after the pool itself is
+	// destroyed, blocks go straight to the system allocator.
+	static thread_local ThreadPool* thread_pool;
+	static thread_local bool thread_exited;
+	static std::mutex registry_mutex;
+	static Stats retired;
+	static bool installed;
+
+	static std::set<ThreadPool*>& Registry() {
+		static std::set<ThreadPool*> registry;
+		return registry;
+	}
+
+	static ThreadPool* GetThreadPool() {
+		if (thread_pool == NULL && !thread_exited) {
+			static thread_local ThreadPool pool;
+			thread_pool = &pool;
+			std::lock_guard<std::mutex> guard(registry_mutex);
+			Registry().insert(&pool);
+		}
+		return thread_pool;
+	}
+
+	static inline int GetSizeClass(int size) {
+		if (size > CLASS_SIZES[CLASS_COUNT - 1]) return LARGE;
+		int size_class = 0;
+		while (CLASS_SIZES[size_class] < size) ++size_class;
+		return size_class;
+	}
+
+	static void* Malloc(int size) {
+		if (size < 1) size = 1;
+		ThreadPool* pool = GetThreadPool();
+		int size_class = GetSizeClass(size);
+		sqlite3_int64 usable = size_class == LARGE ? size : CLASS_SIZES[size_class];
+		Header* block = NULL;
+		if (pool != NULL) {
+			if (size_class != LARGE && pool->free_lists[size_class] != NULL) {
+				block = pool->free_lists[size_class];
+				pool->free_lists[size_class] = block->next;
+				pool->free_counts[size_class] -= 1;
+				pool->pool_hits.Add(1);
+				pool->bytes_pooled.Add(-usable);
+			}
+			pool->allocations.Add(1);
+			pool->bytes_in_use.Add(usable);
+		}
+		if (block == NULL) {
+			block = static_cast<Header*>(malloc(sizeof(Header) + static_cast<size_t>(usable)));
+			if (block == NULL) {
+				if (pool != NULL) {
+					pool->allocations.Add(-1);
+					pool->bytes_in_use.Add(-usable);
+				}
+				return NULL;
+			}
+			block->size = usable;
+			block->size_class = size_class;
+		}
+		return block + 1;
+	}
+
+	static void Free(void* ptr) {
+		if (ptr == NULL) return;
+		Header* block = static_cast<Header*>(ptr) - 1;
+		ThreadPool* pool = GetThreadPool();
+		if (pool == NULL) {
+			free(block);
+			return;
+		}
+		pool->frees.Add(1);
+		pool->bytes_in_use.Add(-block->size);
+		int size_class = block->size_class;
+		if (size_class != LARGE && static_cast<size_t>(pool->free_counts[size_class]) * block->size < MAX_POOLED_BYTES_PER_CLASS) {
+			block->next = pool->free_lists[size_class];
+			pool->free_lists[size_class] = block;
+			pool->free_counts[size_class] += 1;
+			pool->bytes_pooled.Add(block->size);
+		} else {
+			free(block);
+		}
+	}
+
+	static void* Realloc(void* ptr, int size) {
+		Header* block = static_cast<Header*>(ptr) - 1;
+		if (size <= block->size && GetSizeClass(size) == block->size_class) return ptr;
+		void* result = Malloc(size);
+		if (result == NULL) return NULL;
+		memcpy(result, ptr, static_cast<size_t>(std::min(block->size, static_cast<sqlite3_int64>(size))));
+		Free(ptr);
+		return result;
+	}
+
+	static int Size(void* ptr) {
+		return static_cast<int>((static_cast<Header*>(ptr) - 1)->size);
+	}
+
+	static int Roundup(int size) {
+		int size_class = GetSizeClass(size);
+		return size_class == LARGE ? (size + 7) & ~7 : CLASS_SIZES[size_class];
+	}
+};
+
+thread_local PoolAllocator::ThreadPool* PoolAllocator::thread_pool = NULL;
+thread_local bool PoolAllocator::thread_exited = false;
+std::mutex PoolAllocator::registry_mutex;
+PoolAllocator::Stats PoolAllocator::retired = {};
+bool PoolAllocator::installed = false;
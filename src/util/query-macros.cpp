@@ -1,6 +1,6 @@
-#define STATEMENT_BIND(handle)                                                 \
+#define STATEMENT_BIND(handle, argc)                                           \
 	Binder binder(handle);                                                     \
-	if (!binder.Bind(info, info.Length(), stmt)) {                             \
+	if (!binder.Bind(info, (argc), stmt)) {                                    \
 		sqlite3_clear_bindings(handle);                                        \
 		return info.Env().Undefined();                                         \
 	} ((void)0)
@@ -17,6 +17,15 @@
 
 #define STATEMENT_START_LOGIC(RETURNS_DATA_CHECK, MUTATE_CHECK)                \
 	UNWRAP_OR_RETURN(Statement, stmt, info.This());                            \
+	STATEMENT_ENTER_LOGIC(RETURNS_DATA_CHECK, MUTATE_CHECK)
+
+// These are the same as the _START variants, except that they use an existing
+// "stmt" variable instead of unwrapping the receiver (see Statement#compile()).
+// The _ARGS variants only bind the first "argc" arguments, which allows the
+// remaining arguments to be used as options (see Statement#arrow()).
+#define STATEMENT_ENTER_LOGIC(RETURNS_DATA_CHECK, MUTATE_CHECK)                \
+	STATEMENT_ENTER_ARGS_LOGIC(RETURNS_DATA_CHECK, MUTATE_CHECK, info.Length())
+#define STATEMENT_ENTER_ARGS_LOGIC(RETURNS_DATA_CHECK, MUTATE_CHECK, argc)     \
 	RETURNS_DATA_CHECK();                                                      \
 	sqlite3_stmt* handle = stmt->handle;                                       \
 	Database* db = stmt->db;                                                   \
@@ -25,17 +34,27 @@
 	MUTATE_CHECK();                                                            \
 	const bool bound = stmt->bound;                                            \
 	if (!bound) {                                                              \
-		STATEMENT_BIND(handle);                                                \
-	} else if (info.Length() > 0) {                                            \
+		STATEMENT_BIND(handle, argc);                                          \
+	} else if ((argc) > 0) {                                                   \
 		return ThrowTypeError(info.Env(), "This statement already has bound parameters"); \
 	} ((void)0)
 
 
-#define STATEMENT_THROW() db->GetState()->busy = false; STATEMENT_THROW_LOGIC()
+#define STATEMENT_THROW()                                                      \
+	db->GetState()->busy = false;                                              \
+	db->DiscardFailedChanges(_change_mark);                                    \
+	STATEMENT_THROW_LOGIC()
 #define STATEMENT_RETURN(x) db->GetState()->busy = false; STATEMENT_RETURN_LOGIC(x)
 #define STATEMENT_START(x, y)                                                  \
-	STATEMENT_START_LOGIC(x, y);                                               \
+	UNWRAP_OR_RETURN(Statement, stmt, info.This());                            \
+	STATEMENT_ENTER(x, y)
+#define STATEMENT_ENTER(x, y)                                                  \
+	STATEMENT_ENTER_ARGS(x, y, info.Length())
+#define STATEMENT_ENTER_ARGS(x, y, argc)                                       \
+	STATEMENT_ENTER_ARGS_LOGIC(x, y, argc);                                    \
 	db->GetState()->busy = true;                                               \
+	const Database::ChangeMark _change_mark = db->MarkChanges();               \
+	Database::TimeLimit _time_limit(db, stmt->extras->time_limit);             \
 	UseIsolate;                                                                \
 	if (db->Log(env, handle)) {                                                \
 		STATEMENT_THROW();                                                     \
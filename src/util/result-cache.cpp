@@ -0,0 +1,155 @@
+// Caches the results of a read-only Statement, keyed by its bound parameters.
+// Cached results are frozen, so the same JavaScript values can be returned
+// every time. The whole cache is discarded whenever the data might have
+// changed, which is detected by comparing a Version taken before each lookup.
+class ResultCache {
+public:
+
+	// Identifies the state of a connection's data (see Database::GetDataVersion).
+	struct Version {
+		sqlite3_int64 total_changes; // Changes made by this connection
+		unsigned int file_version; // Changes committed by this connection
+		int data_version; // Changes committed by other connections
+		bool operator==(const Version& other) const = default;
+	};
+
+	// The kinds of results that are cached separately.
+	static const char GET = 'g';
+	static const char ALL = 'a';
+
+	explicit ResultCache() : version(), enabled(false) {}
+
+	inline bool IsEnabled() const { return enabled; }
+
+	void SetEnabled(bool enabled) {
+		this->enabled = enabled;
+		if (!enabled) entries.clear();
+	}
+
+	// Returns the string that the parameters should be written to while they're
+	// being bound, or NULL if the cache is disabled.
+	std::string* StartKey() {
+		if (!enabled) return NULL;
+		key.clear();
+		return &key;
+	}
+
+	// Records a bound parameter in the key. Arrays that were bound for carray()
+	// are marked, so they can't be confused with typed arrays bound as blobs.
+	static void AppendKey(Napi::Env env, std::string& key, int index, Napi::Value value, bool carray) {
+		AppendBytes(key, &index, sizeof(index));
+		if (carray) key.push_back('c');
+		AppendValue(env, key, value);
+	}
+
+	// Looks up the result for the most recently bound parameters. The kind of
+	// result, the row mode, and the safe integers setting are part of the key.
+	bool Get(Napi::Env env, const Version& version, char kind, char mode, bool safe_ints, Napi::Value& result) {
+		if (!(version == this->version)) {
+			entries.clear();
+			this->version = version;
+		}
+		lookup_key.assign(key);
+		lookup_key.push_back(kind);
+		lookup_key.push_back(mode);
+		lookup_key.push_back(safe_ints ? '1' : '0');
+		auto entry = entries.find(lookup_key);
+		if (entry == entries.end()) return false;
+		result = entry->second.IsEmpty() ? env.Undefined() : entry->second.Value();
+		return true;
+	}
+
+	// Freezes and stores the result for the key of the last lookup. If the
+	// rows contain nested objects (see Statement#expand()), those are frozen
+	// too. Buffers can't be frozen, so they're shared as is.
+	void Set(Napi::Env env, Napi::Value result, char kind, bool nested) {
+		if (entries.size() >= MAX_ENTRIES) entries.clear();
+		if (kind == ALL) {
+			Napi::Array rows = result.As<Napi::Array>();
+			for (uint32_t i = 0, length = rows.Length(); i < length; ++i) {
+				FreezeRow(env, rows.Get(i), nested);
+			}
+			Freeze(env, result);
+		} else {
+			FreezeRow(env, result, nested);
+		}
+		entries[lookup_key] = result.IsUndefined() ? Napi::Reference<Napi::Value>() : Napi::Persistent(result);
+	}
+
+private:
+
+	static const size_t MAX_ENTRIES = 256;
+
+	static inline void AppendBytes(std::string& key, const void* data, size_t length) {
+		key.append(static_cast<const char*>(data), length);
+	}
+
+	static void AppendValue(Napi::Env env, std::string& key, Napi::Value value) {
+		if (value.IsNumber()) {
+			double number = value.As<Napi::Number>().DoubleValue();
+			key.push_back('n');
+			AppendBytes(key, &number, sizeof(number));
+		} else if (value.IsBigInt()) {
+			bool lossless;
+			int64_t number = value.As<Napi::BigInt>().Int64Value(&lossless);
+			key.push_back('i');
+			AppendBytes(key, &number, sizeof(number));
+		} else if (value.IsString()) {
+			std::string utf8 = value.As<Napi::String>().Utf8Value();
+			size_t length = utf8.length();
+			key.push_back('s');
+			AppendBytes(key, &length, sizeof(length));
+			key.append(utf8);
+		} else if (value.IsArray()) {
+			// Only arrays bound for carray() get here (see Data::BindArrayFromJS).
+			Napi::Array array = value.As<Napi::Array>();
+			uint32_t length = array.Length();
+			key.push_back('a');
+			AppendBytes(key, &length, sizeof(length));
+			for (uint32_t i = 0; i < length; ++i) {
+				Napi::Value element = SafeGetElement(env, array, i);
+				if (element.IsEmpty()) break;
+				AppendValue(env, key, element);
+			}
+		} else if (value.IsTypedArray()) {
+			Napi::TypedArray array = value.As<Napi::TypedArray>();
+			napi_typedarray_type type = array.TypedArrayType();
+			size_t length = array.ByteLength();
+			key.push_back('t');
+			AppendBytes(key, &type, sizeof(type));
+			AppendBytes(key, &length, sizeof(length));
+			key.append(static_cast<const char*>(array.ArrayBuffer().Data()) + array.ByteOffset(), length);
+		} else if (value.IsBuffer()) {
+			Napi::Buffer<char> buffer = value.As<Napi::Buffer<char>>();
+			size_t length = buffer.Length();
+			key.push_back('b');
+			AppendBytes(key, &length, sizeof(length));
+			key.append(buffer.Data(), length);
+		} else {
+			key.push_back('z');
+		}
+	}
+
+	static inline void Freeze(Napi::Env env, Napi::Value value) {
+		if (value.IsObject() && !value.IsTypedArray() && !value.IsArrayBuffer()) {
+			napi_object_freeze(env, value);
+		}
+	}
+
+	static void FreezeRow(Napi::Env env, Napi::Value row, bool nested) {
+		if (nested && row.IsObject()) {
+			Napi::Object object = row.As<Napi::Object>();
+			Napi::Array names = object.GetPropertyNames();
+			for (uint32_t i = 0, length = names.Length(); i < length; ++i) {
+				Freeze(env, object.Get(names.Get(i)));
+			}
+		}
+		Freeze(env, row);
+	}
+
+	std::unordered_map<std::string, Napi::Reference<Napi::Value>> entries;
+	std::string key;
+	std::string lookup_key;
+	Version version;
+	bool enabled;
+};
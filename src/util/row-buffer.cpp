@@ -0,0 +1,119 @@
+// Holds a copy of one or more result rows in native memory, so that lazy row
+// objects can defer converting each column to JavaScript until it's accessed.
+// Instances are owned by a type-tagged Node-API external, which is referenced
+// by every row object created from it (see RowBuilder::GetLazyRowsJS).
+class RowBuffer {
+public:
+
+	explicit RowBuffer(int column_count, bool safe_ints) :
+		cells(),
+		data(),
+		column_count(column_count),
+		safe_ints(safe_ints) {}
+
+	// Copies the current row of the given statement into the buffer.
+	void AppendRow(sqlite3_stmt* handle) {
+		for (int i = 0; i < column_count; ++i) {
+			Cell cell;
+			cell.type = sqlite3_column_type(handle, i);
+			cell.length = 0;
+			switch (cell.type) {
+				case SQLITE_INTEGER:
+					cell.integer = sqlite3_column_int64(handle, i);
+					break;
+				case SQLITE_FLOAT:
+					cell.real = sqlite3_column_double(handle, i);
+					break;
+				case SQLITE_TEXT:
+				case SQLITE_BLOB: {
+					const char* bytes = cell.type == SQLITE_TEXT
+						? reinterpret_cast<const char*>(sqlite3_column_text(handle, i))
+						: static_cast<const char*>(sqlite3_column_blob(handle, i));
+					cell.length = sqlite3_column_bytes(handle, i);
+					cell.offset = data.size();
+					if (cell.length) data.insert(data.end(), bytes, bytes + cell.length);
+					break;
+				}
+				default:
+					assert(cell.type == SQLITE_NULL);
+			}
+			cells.push_back(cell);
+		}
+	}
+
+	inline size_t GetRowCount() {
+		return column_count ? cells.size() / column_count : 0;
+	}
+
+	// Wraps the buffer in an external, which takes ownership of it.
+	Napi::Value Wrap(Napi::Env env) {
+		napi_value external;
+		if (napi_create_external(env, this, Finalize, NULL, &external) != napi_ok) {
+			delete this;
+			return Napi::Value();
+		}
+		napi_status status = napi_type_tag_object(env, external, &TYPE_TAG);
+		assert(status == napi_ok || status == napi_cannot_run_js); ((void)status);
+		return Napi::Value(env, external);
+	}
+
+	// Converts a single cell to JavaScript. The cell is identified by its
+	// index within the buffer (row index * column count + column index).
+	static NODE_METHOD(JS_read) {
+		if (info.Length() < 2 || !IsInstanceOf<RowBuffer>(info.Env(), info[0]) || !info[1].IsNumber()) {
+			return ThrowTypeError(info.Env(), "Expected a row buffer and a cell index");
+		}
+		UseIsolate;
+		void* data;
+		napi_status status = napi_get_value_external(env, info[0], &data);
+		assert(status == napi_ok); ((void)status);
+		RowBuffer* buffer = static_cast<RowBuffer*>(data);
+		double index = info[1].As<Napi::Number>().DoubleValue();
+		if (!(index >= 0 && index < static_cast<double>(buffer->cells.size()))) {
+			return ThrowRangeError(env, "Cell index out of range");
+		}
+		return buffer->GetValueJS(env, buffer->cells[static_cast<size_t>(index)]);
+	}
+
+	// Identifies externals that hold a RowBuffer (see IsInstanceOf).
+	static const napi_type_tag TYPE_TAG;
+
+private:
+
+	struct Cell {
+		int type;
+		int length;
+		union {
+			sqlite3_int64 integer;
+			double real;
+			size_t offset;
+		};
+	};
+
+	Napi::Value GetValueJS(Napi::Env env, const Cell& cell) {
+		switch (cell.type) {
+			case SQLITE_INTEGER:
+				if (safe_ints) return Napi::BigInt::New(env, (int64_t)cell.integer);
+				return Napi::Number::New(env, (double)cell.integer);
+			case SQLITE_FLOAT:
+				return Napi::Number::New(env, cell.real);
+			case SQLITE_TEXT:
+				return StringFromUtf8(env, cell.length ? data.data() + cell.offset : "", cell.length);
+			case SQLITE_BLOB:
+				return Napi::Buffer<char>::Copy(env, cell.length ? data.data() + cell.offset : "", cell.length);
+			default:
+				return env.Null();
+		}
+	}
+
+	static void Finalize(napi_env env, void* data, void* hint) {
+		delete static_cast<RowBuffer*>(data);
+	}
+
+	std::vector<Cell> cells;
+	std::vector<char> data;
+	const int column_count;
+	const bool safe_ints;
+};
+
+const napi_type_tag RowBuffer::TYPE_TAG = RandomTypeTag();
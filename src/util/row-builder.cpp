@@ -1,28 +1,84 @@
 RowBuilder::RowBuilder(
 	Napi::Env env,
 	Napi::Function row_factory,
-	Napi::Function array_factory
+	Napi::Function array_factory,
+	Napi::Function lazy_row_factory,
+	Napi::Function expanded_row_factory
 ) :
 	row_factory(Napi::Persistent(row_factory)),
 	array_factory(Napi::Persistent(array_factory)),
+	lazy_row_factory(Napi::Persistent(lazy_row_factory)),
+	expanded_row_factory(Napi::Persistent(expanded_row_factory)),
 	column_count(-1),
-	reprepare_count(-1) {}
+	reprepare_count(-1),
+	lazy_reprepare_count(-1),
+	expanded_reprepare_count(-1) {}
 
-Napi::Value RowBuilder::GetRowJS(Napi::Env env, sqlite3_stmt* handle, bool safe_ints) {
+Napi::Value RowBuilder::GetRowJS(Napi::Env env, sqlite3_stmt* handle, bool safe_ints, StringCache* strings) {
 	int current_reprepare_count = sqlite3_stmt_status(handle, SQLITE_STMTSTATUS_REPREPARE, false);
 	if (current_reprepare_count != reprepare_count) {
-		column_count = sqlite3_column_count(handle);
-		std::vector<napi_value> keys(column_count);
-		for (int i = 0; i < column_count; ++i) {
-			keys[i] = InternalizedFromUtf8(env, sqlite3_column_name(handle, i), -1);
-		}
+		std::vector<napi_value> keys = GetColumnNames(env, handle);
 		create_row = Napi::Persistent(
 			SafeCall(env, row_factory.Value(), env.Undefined(), column_count, keys.data())
 				.As<Napi::Function>()
 		);
 		reprepare_count = current_reprepare_count;
 	}
+	return CallWithValues(env, create_row.Value(), handle, safe_ints, strings);
+}
+
+Napi::Value RowBuilder::GetRawRowJS(Napi::Env env, sqlite3_stmt* handle, bool safe_ints, StringCache* strings) {
+	column_count = sqlite3_column_count(handle);
+	return CallWithValues(env, array_factory.Value(), handle, safe_ints, strings);
+}
 
+// Expanded rows group their columns by table (see Statement#expand()). The
+// grouping is computed once, and then each row is built by a single call to
+// a generated function, like flat rows.
+Napi::Value RowBuilder::GetExpandedRowJS(Napi::Env env, sqlite3_stmt* handle, bool safe_ints, StringCache* strings) {
+	int current_reprepare_count = sqlite3_stmt_status(handle, SQLITE_STMTSTATUS_REPREPARE, false);
+	if (current_reprepare_count != expanded_reprepare_count) {
+		std::vector<napi_value> keys = GetColumnNames(env, handle);
+		Napi::Array tables = Napi::Array::New(env, column_count);
+		Napi::Array columns = Napi::Array::New(env, column_count);
+		for (int i = 0; i < column_count; ++i) {
+			const char* table = sqlite3_column_table_name(handle, i);
+			tables.Set(static_cast<uint32_t>(i), InternalizedFromUtf8(env, table == NULL ? "$" : table, -1));
+			columns.Set(static_cast<uint32_t>(i), keys[i]);
+		}
+		napi_value args[2] = { tables, columns };
+		Napi::Value fn = SafeCall(env, expanded_row_factory.Value(), env.Undefined(), 2, args);
+		if (fn.IsEmpty()) return fn;
+		create_expanded_row = Napi::Persistent(fn.As<Napi::Function>());
+		expanded_reprepare_count = current_reprepare_count;
+	}
+	return CallWithValues(env, create_expanded_row.Value(), handle, safe_ints, strings);
+}
+
+// Creates an array of lazy row objects, which are backed by the given buffer.
+// Ownership of the buffer is transferred to the returned rows.
+Napi::Value RowBuilder::GetLazyRowsJS(Napi::Env env, sqlite3_stmt* handle, RowBuffer* buffer) {
+	int current_reprepare_count = sqlite3_stmt_status(handle, SQLITE_STMTSTATUS_REPREPARE, false);
+	if (current_reprepare_count != lazy_reprepare_count) {
+		std::vector<napi_value> keys = GetColumnNames(env, handle);
+		Napi::Value fn = SafeCall(env, lazy_row_factory.Value(), env.Undefined(), column_count, keys.data());
+		if (fn.IsEmpty()) {
+			delete buffer;
+			return fn;
+		}
+		create_lazy_rows = Napi::Persistent(fn.As<Napi::Function>());
+		lazy_reprepare_count = current_reprepare_count;
+	}
+
+	napi_value args[2];
+	args[1] = Napi::Number::New(env, static_cast<double>(buffer->GetRowCount()));
+	args[0] = buffer->Wrap(env);
+	if (args[0] == NULL) return Napi::Value();
+	return SafeCall(env, create_lazy_rows.Value(), env.Undefined(), 2, args);
+}
+
+// Invokes the given function with the values of the current row.
+Napi::Value RowBuilder::CallWithValues(Napi::Env env, Napi::Function fn, sqlite3_stmt* handle, bool safe_ints, StringCache* strings) {
 	napi_value value_storage[16];
 	std::vector<napi_value> extra_values;
 	napi_value* values = value_storage;
@@ -31,23 +87,16 @@ Napi::Value RowBuilder::GetRowJS(Napi::Env env, sqlite3_stmt* handle, bool safe_
 		values = extra_values.data();
 	}
 	for (int i = 0; i < column_count; ++i) {
-		values[i] = Data::GetValueJS(env, handle, i, safe_ints);
+		values[i] = Data::GetValueJS(env, handle, i, safe_ints, strings);
 	}
-
-	return SafeCall(env, create_row.Value(), env.Undefined(), column_count, values);
+	return SafeCall(env, fn, env.Undefined(), column_count, values);
 }
 
-Napi::Value RowBuilder::GetRawRowJS(Napi::Env env, sqlite3_stmt* handle, bool safe_ints) {
+std::vector<napi_value> RowBuilder::GetColumnNames(Napi::Env env, sqlite3_stmt* handle) {
 	column_count = sqlite3_column_count(handle);
-	napi_value arg_storage[16];
-	std::vector<napi_value> extra_args;
-	napi_value* args = arg_storage;
-	if (column_count > 16) {
-		extra_args.resize(column_count);
-		args = extra_args.data();
-	}
+	std::vector<napi_value> keys(column_count);
 	for (int i = 0; i < column_count; ++i) {
-		args[i] = Data::GetValueJS(env, handle, i, safe_ints);
+		keys[i] = InternalizedFromUtf8(env, sqlite3_column_name(handle, i), -1);
 	}
-	return SafeCall(env, array_factory.Value(), env.Undefined(), column_count, args);
+	return keys;
 }
@@ -1,22 +1,39 @@
 // Builds row objects efficiently by utilizing a factory function in JS land.
 // The column names are initialized only once and reused for every row/query.
 // The cache is rebuilt if SQLite reparses the statement after a schema change.
+// Building rows through Node-API instead (napi_define_properties, or
+// napi_set_element for raw rows) is several times slower in every supported
+// version of Node.js, because each property is set through a separate call
+// (see benchmark/materialize).
 class RowBuilder {
 public:
 
 	explicit RowBuilder(
 		Napi::Env env,
 		Napi::Function row_factory,
-		Napi::Function array_factory
+		Napi::Function array_factory,
+		Napi::Function lazy_row_factory,
+		Napi::Function expanded_row_factory
 	);
 
-	Napi::Value GetRowJS(Napi::Env env, sqlite3_stmt* handle, bool safe_ints);
-	Napi::Value GetRawRowJS(Napi::Env env, sqlite3_stmt* handle, bool safe_ints);
+	Napi::Value GetRowJS(Napi::Env env, sqlite3_stmt* handle, bool safe_ints, StringCache* strings);
+	Napi::Value GetRawRowJS(Napi::Env env, sqlite3_stmt* handle, bool safe_ints, StringCache* strings);
+	Napi::Value GetExpandedRowJS(Napi::Env env, sqlite3_stmt* handle, bool safe_ints, StringCache* strings);
+	Napi::Value GetLazyRowsJS(Napi::Env env, sqlite3_stmt* handle, RowBuffer* buffer);
 
 private:
+	std::vector<napi_value> GetColumnNames(Napi::Env env, sqlite3_stmt* handle);
+	Napi::Value CallWithValues(Napi::Env env, Napi::Function fn, sqlite3_stmt* handle, bool safe_ints, StringCache* strings);
+
 	Napi::FunctionReference row_factory;
 	Napi::FunctionReference create_row;
 	Napi::FunctionReference array_factory;
+	Napi::FunctionReference lazy_row_factory;
+	Napi::FunctionReference create_lazy_rows;
+	Napi::FunctionReference expanded_row_factory;
+	Napi::FunctionReference create_expanded_row;
 	int column_count;
 	int reprepare_count;
+	int lazy_reprepare_count;
+	int expanded_reprepare_count;
 };
@@ -0,0 +1,97 @@
+// Converts TEXT values that are read from a statement's result set, applying
+// the statement's optional string optimizations:
+//   - Interning: each distinct short value is only converted to a JavaScript
+//     string once, and then the same string is handed out every time the value
+//     occurs again, which saves both time and memory for low-cardinality columns
+//     (e.g., status codes). Each column caches its own values, and columns that
+//     turn out to have too many distinct values stop being cached, which also
+//     releases the values they had cached.
+//   - Externalizing: large values are converted to external strings, which
+//     avoids copying them onto the JavaScript heap (see ExternalString).
+class StringCache {
+public:
+
+	explicit StringCache() : columns(), entry_count(0), interning(false), externalizing(false) {}
+
+	Napi::Value Get(Napi::Env env, int column, const char* data, int length) {
+		if (length > MAX_LENGTH) {
+			if (externalizing && length >= EXTERNAL_MIN_LENGTH) {
+				return ExternalString::New(env, data, static_cast<size_t>(length));
+			}
+			return StringFromUtf8(env, data, length);
+		}
+		if (!interning) return StringFromUtf8(env, data, length);
+		if (static_cast<size_t>(column) >= columns.size()) columns.resize(column + 1);
+		Column& cache = columns[column];
+		if (cache.disabled) return StringFromUtf8(env, data, length);
+
+		cache.lookups += 1;
+		auto element = cache.strings.find(std::string_view(data, length));
+		if (element != cache.strings.end()) return element->second.Value();
+
+		cache.misses += 1;
+		if (cache.lookups >= PROBATION_PERIOD && cache.misses * 2 > cache.lookups) {
+			entry_count -= cache.strings.size();
+			cache.strings = decltype(cache.strings)();
+			cache.disabled = true;
+			return StringFromUtf8(env, data, length);
+		}
+		Napi::String value = StringFromUtf8(env, data, length);
+		if (cache.strings.size() < MAX_COLUMN_ENTRIES && entry_count < MAX_ENTRIES) {
+			cache.strings.emplace(std::string(data, length), Napi::Persistent(value));
+			entry_count += 1;
+		}
+		return value;
+	}
+
+	inline bool IsEnabled() {
+		return interning || externalizing;
+	}
+
+	void SetInterning(bool use) {
+		interning = use;
+		if (!use) {
+			columns.clear();
+			entry_count = 0;
+		}
+	}
+
+	void SetExternalizing(bool use) {
+		externalizing = use;
+	}
+
+private:
+
+	// Only strings up to this many bytes are cached.
+	static const int MAX_LENGTH = 64;
+
+	// The maximum number of distinct strings cached per statement, and per
+	// column. A column that's still on probation can't fill the whole cache.
+	static const size_t MAX_ENTRIES = 1024;
+	static const size_t MAX_COLUMN_ENTRIES = 256;
+
+	// The number of lookups before a column's hit rate is evaluated.
+	static const unsigned int PROBATION_PERIOD = 256;
+
+	// Only strings of at least this many bytes are externalized.
+	static const int EXTERNAL_MIN_LENGTH = 64 * 1024;
+
+	struct Hash {
+		using is_transparent = void;
+		inline size_t operator()(std::string_view str) const {
+			return std::hash<std::string_view>()(str);
+		}
+	};
+
+	struct Column {
+		std::unordered_map<std::string, Napi::Reference<Napi::String>, Hash, std::equal_to<>> strings;
+		unsigned int lookups = 0;
+		unsigned int misses = 0;
+		bool disabled = false;
+	};
+
+	std::vector<Column> columns;
+	size_t entry_count;
+	bool interning;
+	bool externalizing;
+};
@@ -1,5 +1,6 @@
 'use strict';
 const fs = require('fs-extra');
+const { execFileSync } = require('child_process');
 const path = require('path');
 const os = require('os');
 const chai = require('chai');
@@ -13,6 +14,13 @@ global.util = {
 	current: () => path.join(tempDir, `${dbId}.db`),
 	next: () => (++dbId, global.util.current()),
 	itUnix: isWindows ? it.skip : it,
+	// Runs a script in a separate process, with the given environment variables
+	// added, and returns the JSON that it wrote to stdout.
+	runScript: (source, env = {}) => JSON.parse(execFileSync(process.execPath, ['-e', source], {
+		cwd: __dirname,
+		env: { ...process.env, ...env },
+		encoding: 'utf8',
+	})),
 };
 
 before(function () {
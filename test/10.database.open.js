@@ -117,6 +117,66 @@ describe('new Database()', function () {
 		expect(() => (this.db = new Database(util.current(), { timeout: 75.01 }))).to.throw(TypeError);
 		expect(() => (this.db = new Database(util.current(), { timeout: 0x80000000 }))).to.throw(RangeError);
 	});
+	it('should accept the "vfs" option', function () {
+		expect(() => (this.db = new Database(util.next(), { vfs: 123 }))).to.throw(TypeError);
+		expect(() => (this.db = new Database(util.current(), { vfs: '' }))).to.throw(TypeError);
+		expect(() => (this.db = new Database(':memory:', { vfs: 'memory' }))).to.throw(TypeError);
+		expect(() => (this.db = new Database(util.current(), { vfs: 'nonexistent' }))).to.throw(Database.SqliteError);
+		this.db = new Database(util.current(), { vfs: null });
+		expect(this.db.memory).to.be.false;
+		expect(fs.existsSync(util.current())).to.be.true;
+	});
+	it('should share databases opened with the "memory" vfs', function () {
+		const name = `shared-${util.next()}`;
+		expect(() => new Database(name, { vfs: 'memory', fileMustExist: true })).to.throw(Database.SqliteError).with.property('code', 'SQLITE_CANTOPEN');
+		const db = this.db = new Database(name, { vfs: 'memory' });
+		expect(db.memory).to.be.true;
+		expect(db.name).to.equal(name);
+		expect(fs.existsSync(name)).to.be.false;
+		expect(db.pragma('journal_mode = WAL', { simple: true })).to.equal('wal');
+		db.exec('CREATE TABLE data (x); INSERT INTO data VALUES (1), (2)');
+
+		const reader = new Database(name, { vfs: 'memory', readonly: true });
+		try {
+			db.exec('BEGIN IMMEDIATE; INSERT INTO data VALUES (3)');
+			expect(reader.prepare('SELECT x FROM data').pluck().all()).to.deep.equal([1, 2]);
+			db.exec('COMMIT');
+			expect(reader.prepare('SELECT x FROM data').pluck().all()).to.deep.equal([1, 2, 3]);
+			expect(() => reader.exec('INSERT INTO data VALUES (4)')).to.throw(Database.SqliteError);
+		} finally {
+			reader.close();
+		}
+		const other = new Database(`other-${name}`, { vfs: 'memory' });
+		expect(other.prepare('SELECT count(*) FROM sqlite_master').pluck().get()).to.equal(0);
+		other.close();
+
+		db.close();
+		this.db = new Database(name, { vfs: 'memory' });
+		expect(this.db.prepare('SELECT count(*) FROM sqlite_master').pluck().get()).to.equal(0);
+	});
+	it('should accept the "mmap" option', function () {
+		expect(() => (this.db = new Database(util.next(), { mmap: -1 }))).to.throw(TypeError);
+		expect(() => (this.db = new Database(util.current(), { mmap: 1.5 }))).to.throw(TypeError);
+		expect(() => (this.db = new Database(util.current(), { mmap: '4096' }))).to.throw(TypeError);
+		const setup = new Database(util.current());
+		setup.exec("CREATE TABLE data (x); INSERT INTO data WITH RECURSIVE temp(x) AS (SELECT 1 UNION ALL SELECT x + 1 FROM temp LIMIT 500) SELECT randomblob(1000) FROM temp");
+		expect(setup.mmapStats()).to.deep.equal({ size: 0, mappedReads: null, fileReads: null });
+		setup.close();
+
+		const db = this.db = new Database(util.current(), { mmap: 1 << 28 });
+		expect(db.pragma('mmap_size', { simple: true })).to.equal(1 << 28);
+		expect(db.prepare('SELECT count(*) FROM data').pluck().get()).to.equal(500);
+		const stats = db.mmapStats();
+		expect(stats.size).to.equal(1 << 28);
+		expect(stats.mappedReads).to.be.above(100);
+		expect(stats.fileReads).to.be.below(10);
+		db.close();
+
+		this.db = new Database(util.current(), { mmap: 0 });
+		this.db.prepare('SELECT count(*) FROM data').pluck().get();
+		expect(this.db.mmapStats().mappedReads).to.equal(0);
+		expect(this.db.mmapStats().fileReads).to.be.above(100);
+	});
 	it('should accept the "nativeBinding" option', function () {
 		this.slow(500);
 		const configuration = fs.existsSync(path.resolve('build/Debug/better_sqlite3.node')) ? 'Debug' : 'Release';
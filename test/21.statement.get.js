@@ -70,6 +70,15 @@ describe('Statement#get()', function () {
 		expect(stmt.expand(true).get()).to.deep.equal(expanded);
 		expect(stmt.get()).to.deep.equal(expanded);
 	});
+	it('should not return stale expanded rows after being recompiled', function () {
+		const stmt = this.db.prepare("SELECT b, 1 AS \"'\", * FROM entries ORDER BY rowid").expand();
+		const entries = { b: 1, a: 'foo', c: 3.14, d: Buffer.alloc(4).fill(0xdd), e: null };
+		expect(stmt.get()).to.deep.equal({ entries, $: { "'": 1 } });
+		this.db.prepare("ALTER TABLE entries ADD COLUMN __proto__ TEXT DEFAULT 'bar'").run();
+		const row = stmt.get(); // Recompile
+		expect(row).to.deep.equal({ entries, $: { "'": 1 } });
+		expect(Object.getPrototypeOf(row.entries)).to.equal(Object.prototype);
+	});
 	it('should return undefined when no rows were found', function () {
 		const stmt = this.db.prepare("SELECT * FROM entries WHERE b == 999");
 		expect(stmt.get()).to.be.undefined;
@@ -90,6 +90,60 @@ describe('Statement#all()', function () {
 		expect(stmt.expand(true).all()).to.deep.equal(expanded);
 		expect(stmt.all()).to.deep.equal(expanded);
 	});
+	it('should return lazily decoded rows when lazy mode is on', function () {
+		const stmt = this.db.prepare("SELECT *, 2 + 3.5 AS c FROM entries ORDER BY rowid").lazy();
+		const rows = stmt.all();
+		expect(rows).to.be.an('array');
+		expect(rows.length).to.equal(10);
+		rows.forEach((row, i) => {
+			expect(row.a).to.equal('foo');
+			expect(row.b).to.equal(i + 1);
+			expect(row.c).to.equal(5.5);
+			expect(row.d).to.deep.equal(Buffer.alloc(4).fill(0xdd));
+			expect(row.d).to.equal(row.d);
+			expect(row.e).to.be.null;
+			expect(row.toJSON()).to.deep.equal({ a: 'foo', b: i + 1, c: 5.5, d: Buffer.alloc(4).fill(0xdd), e: null });
+		});
+		expect(Object.keys(rows[0])).to.deep.equal([]);
+		expect(JSON.parse(JSON.stringify(rows[0])).b).to.equal(1);
+		expect(stmt.safeIntegers().all()[9].b).to.equal(10n);
+		expect(stmt.lazy(false).all()[0]).to.deep.equal({ a: 'foo', b: 1n, c: 5.5, d: Buffer.alloc(4).fill(0xdd), e: null });
+		expect(stmt.lazy().pluck().all()[0]).to.equal('foo');
+		expect(this.db.prepare("SELECT * FROM entries WHERE b == 999").lazy().all()).to.deep.equal([]);
+	});
+	it('should return the same values when internStrings is on', function () {
+		this.db.prepare('CREATE TABLE statuses (id INTEGER PRIMARY KEY, status TEXT, note TEXT)').run();
+		const insert = this.db.prepare('INSERT INTO statuses (status, note) VALUES (?, ?)');
+		for (let i = 0; i < 1000; ++i) insert.run(['new', 'open', 'closed'][i % 3], `note #${i}`);
+		const stmt = this.db.prepare('SELECT * FROM statuses ORDER BY id');
+		const rows = stmt.all();
+		expect(stmt.internStrings().all()).to.deep.equal(rows);
+		expect(stmt.all()).to.deep.equal(rows);
+		expect(stmt.raw().all()).to.deep.equal(rows.map(x => Object.values(x)));
+		expect(stmt.raw(false).expand().all()).to.deep.equal(rows.map(x => ({ statuses: x })));
+		expect(stmt.expand(false).pluck().all()).to.deep.equal(rows.map(x => x.id));
+		expect(stmt.pluck(false).internStrings(false).all()).to.deep.equal(rows);
+		expect(this.db.prepare('SELECT status FROM statuses').pluck().internStrings().all()).to.deep.equal(rows.map(x => x.status));
+	});
+	it('should return the same values when externalStrings is on', function () {
+		this.db.prepare('CREATE TABLE documents (id INTEGER PRIMARY KEY, body TEXT)').run();
+		const insert = this.db.prepare('INSERT INTO documents (body) VALUES (?)');
+		const bodies = [
+			'short',
+			'a'.repeat(64 * 1024),
+			JSON.stringify({ text: 'ünïcödé 😀 '.repeat(10000) }),
+			`${'x'.repeat(100000)}€`,
+		];
+		for (const body of bodies) insert.run(body);
+		this.db.prepare("INSERT INTO documents (body) VALUES (CAST(x'41c3' || zeroblob(70000) || x'ed9f80eda080f09f988000' AS TEXT))").run();
+		const stmt = this.db.prepare('SELECT body FROM documents ORDER BY id').pluck();
+		const rows = stmt.all();
+		expect(rows.slice(0, 4)).to.deep.equal(bodies);
+		expect(stmt.externalStrings().all()).to.deep.equal(rows);
+		expect(stmt.pluck(false).all()).to.deep.equal(rows.map(body => ({ body })));
+		expect(stmt.internStrings().raw().all()).to.deep.equal(rows.map(body => [body]));
+		expect(stmt.externalStrings(false).raw(false).all()).to.deep.equal(rows.map(body => ({ body })));
+	});
 	it('should return an empty array when no rows were found', function () {
 		const stmt = this.db.prepare("SELECT * FROM entries WHERE b == 999");
 		expect(stmt.all()).to.deep.equal([]);
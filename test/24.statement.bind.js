@@ -144,4 +144,53 @@ describe('Statement#bind()', function () {
 		expect(result).to.be.a('string');
 		expect(result.length).to.equal(0);
 	});
+	it('should bind arrays and typed arrays wrapped by Database.carray()', function () {
+		this.db.prepare("INSERT INTO entries VALUES ('foo', 1, NULL), ('bar', 2, NULL), ('baz', 3, NULL)").run();
+		const byNumber = this.db.prepare('SELECT a FROM entries WHERE b IN carray(?) ORDER BY rowid').pluck();
+		const byName = this.db.prepare('SELECT b FROM entries WHERE a IN carray(@names) ORDER BY rowid').pluck();
+		expect(byNumber.all(Database.carray([1, 3]))).to.deep.equal(['foo', 'baz']);
+		expect(byNumber.all([Database.carray([2, 3n, 4])])).to.deep.equal(['bar', 'baz']);
+		expect(byNumber.all(Database.carray([]))).to.deep.equal([]);
+		expect(byNumber.all(Database.carray(new Int32Array([3, 1])))).to.deep.equal(['foo', 'baz']);
+		expect(byNumber.all(Database.carray(new BigInt64Array([2n])))).to.deep.equal(['bar']);
+		expect(byNumber.all(Database.carray(new Float64Array([1, 2.5, 3])))).to.deep.equal(['foo', 'baz']);
+		expect(byName.all({ names: Database.carray(['bar', 'qux', 'foo']) })).to.deep.equal([1, 2]);
+		expect(byName.all({ names: Database.carray([]) })).to.deep.equal([]);
+		const values = this.db.prepare('SELECT value FROM carray(?)').pluck();
+		expect(values.all(Database.carray([1, 2.5]))).to.deep.equal([1, 2.5]);
+		expect(values.safeIntegers().all(Database.carray([1, 2n]))).to.deep.equal([1n, 2n]);
+	});
+	it('should copy arrays bound for carray()', function () {
+		this.db.prepare("INSERT INTO entries VALUES ('foo', 1, NULL), ('bar', 2, NULL)").run();
+		const ids = [1];
+		const typed = new Int32Array([2]);
+		const stmt1 = this.db.prepare('SELECT a FROM entries WHERE b IN carray(?)').pluck().bind(Database.carray(ids));
+		const stmt2 = this.db.prepare('SELECT a FROM entries WHERE b IN carray(?)').pluck().bind(Database.carray(typed));
+		ids[0] = 2;
+		typed[0] = 1;
+		expect(stmt1.all()).to.deep.equal(['foo']);
+		expect(stmt2.all()).to.deep.equal(['bar']);
+	});
+	it('should still bind typed arrays as blobs, and reject nested arrays', function () {
+		const stmt = this.db.prepare('INSERT INTO entries VALUES (?, ?, ?)');
+		stmt.run('foo', 1, new Int32Array([1, 2]));
+		stmt.run('bar', 2, new Float64Array([0.5]));
+		const blobs = this.db.prepare('SELECT c FROM entries ORDER BY rowid').pluck().all();
+		expect(blobs).to.deep.equal([Buffer.from(new Int32Array([1, 2]).buffer), Buffer.from(new Float64Array([0.5]).buffer)]);
+		expect(() => stmt.run('baz', 3, [[1, 2]])).to.throw(TypeError);
+		expect(() => stmt.run({ a: 'baz', b: 3, c: [1, 2] })).to.throw(TypeError);
+		expect(this.db.prepare('SELECT count(*) FROM entries').pluck().get()).to.equal(2);
+	});
+	it('should throw an exception when the elements of an array cannot be bound together', function () {
+		const stmt = this.db.prepare('SELECT value FROM carray(?)');
+		expect(() => stmt.all(Database.carray(['foo', 1]))).to.throw(TypeError);
+		expect(() => stmt.all(Database.carray([1, 'foo']))).to.throw(TypeError);
+		expect(() => stmt.all(Database.carray([1.5, 1n]))).to.throw(TypeError);
+		expect(() => stmt.all(Database.carray([null]))).to.throw(TypeError);
+		expect(() => stmt.all(Database.carray([Buffer.alloc(4)]))).to.throw(TypeError);
+		expect(() => stmt.all(Database.carray([[1]]))).to.throw(TypeError);
+		expect(() => stmt.all(Database.carray([2n ** 64n]))).to.throw(RangeError);
+		expect(() => Database.carray(new Uint8Array(4))).to.throw(TypeError);
+		expect(() => Database.carray('foo')).to.throw(TypeError);
+	});
 });
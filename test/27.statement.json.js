@@ -0,0 +1,79 @@
+'use strict';
+const Database = require('../.');
+
+describe('Statement#json()', function () {
+	beforeEach(function () {
+		this.db = new Database(util.next());
+		this.db.prepare('CREATE TABLE entries (a TEXT, b INTEGER, c REAL, d BLOB, e TEXT)').run();
+		this.db.prepare("INSERT INTO entries WITH RECURSIVE temp(a, b, c, d, e) AS (SELECT 'foo', 1, 3.14, x'dddddddd', NULL UNION ALL SELECT a, b + 1, c, d, e FROM temp LIMIT 10) SELECT * FROM temp").run();
+	});
+	afterEach(function () {
+		this.db.close();
+	});
+
+	it('should throw an exception when used on a statement that returns no data', function () {
+		let stmt = this.db.prepare("INSERT INTO entries VALUES ('foo', 1, 3.14, x'dddddddd', NULL)");
+		expect(stmt.reader).to.be.false;
+		expect(() => stmt.json()).to.throw(TypeError);
+		expect(() => stmt.ndjson()).to.throw(TypeError);
+	});
+	it('should return the same text as JSON.stringify(stmt.all())', function () {
+		const stmt = this.db.prepare('SELECT * FROM entries ORDER BY rowid');
+		expect(stmt.json()).to.equal(JSON.stringify(stmt.all()));
+		expect(JSON.parse(stmt.json())[0]).to.deep.equal({ a: 'foo', b: 1, c: 3.14, d: { type: 'Buffer', data: [221, 221, 221, 221] }, e: null });
+		expect(this.db.prepare('SELECT * FROM entries WHERE b == 999').json()).to.equal('[]');
+	});
+	it('should respect the statement mode', function () {
+		const stmt = this.db.prepare('SELECT *, b + 1 AS f FROM entries ORDER BY rowid');
+		expect(stmt.pluck().json()).to.equal(JSON.stringify(stmt.all()));
+		expect(stmt.expand().json()).to.equal(JSON.stringify(stmt.all()));
+		expect(stmt.raw().json()).to.equal(JSON.stringify(stmt.all()));
+		expect(stmt.lazy().json()).to.equal(JSON.stringify(stmt.all()));
+		expect(stmt.lazy(false).json()).to.equal(JSON.stringify(stmt.all()));
+	});
+	it('should order and deduplicate keys like a JavaScript object would', function () {
+		const stmt = this.db.prepare('SELECT 1 AS x, 2 AS "10", 3 AS "2", 4 AS "01", 5 AS x, 6 AS "__proto__", 7 AS "4294967295", 8 AS "4294967294", 9 AS "-1", 10 AS "a\\"b\n"');
+		expect(stmt.json()).to.equal(JSON.stringify(stmt.all()));
+		expect(stmt.expand().json()).to.equal(JSON.stringify(stmt.all()));
+		expect(stmt.raw().json()).to.equal(JSON.stringify(stmt.all()));
+	});
+	it('should format numbers and strings like JSON.stringify()', function () {
+		const values = [
+			0, -0, 1, -1, 0.1, 1e21, 1e20, 1.5e-7, 1e-6, 5e-324, 1.7976931348623157e308, 9007199254740991, -2.5e-10,
+			'', 'foo', '"quoted" \\ back\\slash', '\b\f\n\r\t\u0000\u001f\u007f', 'ünïcödé 😀 €', '  ',
+		];
+		this.db.prepare('CREATE TABLE v (x)').run();
+		const insert = this.db.prepare('INSERT INTO v VALUES (?)');
+		for (const value of values) insert.run(value);
+		this.db.prepare("INSERT INTO v VALUES (9007199254740993), (-9223372036854775808), (1e999), (-1e999)").run();
+		this.db.prepare("INSERT INTO v VALUES (CAST(x'41c3' || x'ed9f80eda080f09f9880f4908080ff' || x'e282' AS TEXT))").run();
+		const stmt = this.db.prepare('SELECT x FROM v ORDER BY rowid');
+		expect(stmt.json()).to.equal(JSON.stringify(stmt.all()));
+		expect(stmt.pluck().json()).to.equal(JSON.stringify(stmt.all()));
+	});
+	it('should write safe integers as exact integer literals', function () {
+		const stmt = this.db.prepare('SELECT 9007199254740993 AS x, -9223372036854775808 AS y, 1.5 AS z').safeIntegers();
+		expect(stmt.json()).to.equal('[{"x":9007199254740993,"y":-9223372036854775808,"z":1.5}]');
+		expect(stmt.safeIntegers(false).json()).to.equal('[{"x":9007199254740992,"y":-9223372036854776000,"z":1.5}]');
+	});
+	it('should return newline-delimited JSON from ndjson()', function () {
+		const stmt = this.db.prepare('SELECT * FROM entries ORDER BY rowid');
+		expect(stmt.ndjson()).to.equal(stmt.all().map(row => JSON.stringify(row) + '\n').join(''));
+		expect(stmt.raw().ndjson()).to.equal(stmt.all().map(row => JSON.stringify(row) + '\n').join(''));
+		expect(this.db.prepare('SELECT * FROM entries WHERE b == 999').ndjson()).to.equal('');
+	});
+	it('should accept bind parameters', function () {
+		const SQL = 'SELECT * FROM entries WHERE a=? AND b=?';
+		expect(this.db.prepare(SQL).json('foo', 1)).to.equal(JSON.stringify(this.db.prepare(SQL).all('foo', 1)));
+		expect(this.db.prepare(SQL).ndjson('foo', 1)).to.equal(JSON.stringify(this.db.prepare(SQL).get('foo', 1)) + '\n');
+		expect(() => this.db.prepare(SQL).json('foo')).to.throw(RangeError);
+		expect(() => this.db.prepare(SQL).bind('foo', 1).json('foo', 1)).to.throw(TypeError);
+	});
+	it('should reflect schema changes', function () {
+		const stmt = this.db.prepare('SELECT * FROM entries ORDER BY rowid LIMIT 1');
+		expect(stmt.json()).to.equal(JSON.stringify(stmt.all()));
+		this.db.prepare('ALTER TABLE entries ADD COLUMN f TEXT DEFAULT \'bar\'').run();
+		expect(stmt.json()).to.equal(JSON.stringify(stmt.all()));
+		expect(JSON.parse(stmt.json())[0].f).to.equal('bar');
+	});
+});
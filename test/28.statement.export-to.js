@@ -0,0 +1,175 @@
+'use strict';
+const { Writable } = require('stream');
+const Database = require('../.');
+
+describe('Statement#exportTo()', function () {
+	beforeEach(function () {
+		this.db = new Database(util.next());
+		this.db.prepare('CREATE TABLE entries (a TEXT, b INTEGER, c REAL, d BLOB, e TEXT)').run();
+		this.db.prepare("INSERT INTO entries WITH RECURSIVE temp(a, b, c, d, e) AS (SELECT 'foo', 1, 3.14, x'dddddddd', NULL UNION ALL SELECT a, b + 1, c, d, e FROM temp LIMIT 10) SELECT * FROM temp").run();
+	});
+	afterEach(function () {
+		this.db.close();
+	});
+
+	const collect = (options = {}) => {
+		const chunks = [];
+		const stream = new Writable({
+			highWaterMark: options.highWaterMark || 16384,
+			write(chunk, encoding, callback) {
+				chunks.push(chunk);
+				if (options.fail) callback(new Error('write failed'));
+				else setImmediate(callback);
+			},
+		});
+		stream.text = () => Buffer.concat(chunks).toString();
+		stream.chunks = chunks;
+		return stream;
+	};
+	const rejectsWith = (type, p) => {
+		const shouldReject = () => { throw new Error('Promise should have been rejected') };
+		const reasonIs = (reason) => { if (!(reason instanceof type)) throw reason; }
+		return p.then(shouldReject, reasonIs);
+	};
+
+	it('should be a method of every statement, like the other methods', async function () {
+		const stmt = this.db.prepare('SELECT * FROM entries');
+		const proto = Object.getPrototypeOf(stmt);
+		const { value, ...attributes } = Object.getOwnPropertyDescriptor(proto, 'exportTo');
+		const { value: all, ...expected } = Object.getOwnPropertyDescriptor(proto, 'all');
+		expect(value).to.be.a('function');
+		expect(attributes).to.deep.equal(expected);
+		expect(Object.keys(stmt)).to.not.include('exportTo');
+		expect(() => value.call({}, collect())).to.throw(TypeError);
+		const db2 = new Database(util.current());
+		try {
+			expect(db2.prepare('SELECT * FROM entries').exportTo).to.equal(value);
+			const stream = collect();
+			expect(await value.call(db2.prepare('SELECT b FROM entries LIMIT 2'), stream, { format: 'ndjson' })).to.equal(16);
+			expect(stream.text()).to.equal('{"b":1}\n{"b":2}\n');
+		} finally {
+			db2.close();
+		}
+	});
+	it('should not add any methods to statement iterators', function () {
+		const iterator = this.db.prepare('SELECT * FROM entries').iterate();
+		expect(Object.getOwnPropertyNames(Object.getPrototypeOf(iterator)).sort()).to.deep.equal(['constructor', 'next', 'return']);
+		iterator.return();
+	});
+	it('should be rejected when used on a statement that returns no data', async function () {
+		const stmt = this.db.prepare("INSERT INTO entries VALUES ('foo', 1, 3.14, x'dddddddd', NULL)");
+		await rejectsWith(TypeError, stmt.exportTo(collect()));
+	});
+	it('should be rejected when given invalid arguments', async function () {
+		const stmt = this.db.prepare('SELECT * FROM entries');
+		await rejectsWith(TypeError, stmt.exportTo());
+		await rejectsWith(TypeError, stmt.exportTo({}));
+		await rejectsWith(TypeError, stmt.exportTo('foo.csv'));
+		await rejectsWith(TypeError, stmt.exportTo(collect(), 'csv'));
+		await rejectsWith(TypeError, stmt.exportTo(collect(), { format: 'json' }));
+		await rejectsWith(TypeError, stmt.exportTo(collect(), { header: 1 }));
+		await rejectsWith(TypeError, stmt.exportTo(collect(), { end: 'false' }));
+		await rejectsWith(TypeError, stmt.exportTo(collect(), { chunkSize: 0 }));
+		await rejectsWith(TypeError, stmt.exportTo(collect(), { chunkSize: 1.5 }));
+		await rejectsWith(RangeError, stmt.exportTo(collect(), { chunkSize: 0x80000000 }));
+		expect(stmt.busy).to.be.false;
+	});
+	it('should write rows as CSV', async function () {
+		this.db.prepare("INSERT INTO entries VALUES ('a,b', -2, 0.5, x'', 'say \"hi\"\nbye'), ('', 9007199254740993, 1e21, NULL, '\r')").run();
+		const stream = collect();
+		const bytes = await this.db.prepare('SELECT * FROM entries WHERE rowid IN (1, 11, 12) ORDER BY rowid').exportTo(stream);
+		expect(stream.text()).to.equal(
+			'a,b,c,d,e\n'
+			+ 'foo,1,3.14,dddddddd,\n'
+			+ '"a,b",-2,0.5,"","say ""hi""\nbye"\n'
+			+ '"",9007199254740992,1e+21,,"\r"\n'
+		);
+		expect(bytes).to.equal(Buffer.byteLength(stream.text()));
+		expect(stream.writableFinished).to.be.true;
+	});
+	it('should write rows as NDJSON, respecting the statement mode', async function () {
+		const stmt = this.db.prepare('SELECT *, b + 1 AS f FROM entries ORDER BY rowid');
+		for (const mode of ['pluck', 'expand', 'raw', 'lazy']) {
+			stmt[mode]();
+			const stream = collect();
+			await stmt.exportTo(stream, { format: 'ndjson' });
+			expect(stream.text()).to.equal(stmt.ndjson());
+		}
+	});
+	it('should respect safe integers', async function () {
+		const stmt = this.db.prepare('SELECT 9007199254740993 AS x').safeIntegers();
+		const csv = collect();
+		const ndjson = collect();
+		await stmt.exportTo(csv);
+		await stmt.exportTo(ndjson, { format: 'ndjson' });
+		expect(csv.text()).to.equal('x\n9007199254740993\n');
+		expect(ndjson.text()).to.equal('{"x":9007199254740993}\n');
+	});
+	it('should accept the "header" and "end" options', async function () {
+		const stmt = this.db.prepare('SELECT a, b FROM entries WHERE b <= 2 ORDER BY rowid');
+		const stream = collect();
+		await stmt.exportTo(stream, { header: false, end: false });
+		expect(stream.text()).to.equal('foo,1\nfoo,2\n');
+		expect(stream.writableEnded).to.be.false;
+		await stmt.exportTo(stream, { header: false });
+		expect(stream.text()).to.equal('foo,1\nfoo,2\nfoo,1\nfoo,2\n');
+		expect(stream.writableEnded).to.be.true;
+
+		const empty = collect();
+		await this.db.prepare('SELECT a, b FROM entries WHERE b > 99').exportTo(empty);
+		expect(empty.text()).to.equal('a,b\n');
+	});
+	it('should respect backpressure', async function () {
+		this.db.prepare("INSERT INTO entries WITH RECURSIVE temp(x) AS (SELECT 1 UNION ALL SELECT x + 1 FROM temp LIMIT 5000) SELECT 'bar', x, x / 7.0, randomblob(16), NULL FROM temp").run();
+		const stmt = this.db.prepare('SELECT * FROM entries ORDER BY rowid');
+		const stream = collect({ highWaterMark: 1024 });
+		let drains = 0;
+		stream.on('drain', () => { drains += 1; });
+		const promise = stmt.exportTo(stream, { format: 'ndjson', chunkSize: 1000 });
+		expect(stmt.busy).to.be.true;
+		expect(() => this.db.prepare('DELETE FROM entries').run()).to.throw(TypeError);
+		await promise;
+		expect(stmt.busy).to.be.false;
+		expect(drains).to.be.above(10);
+		expect(stream.chunks.length).to.be.above(10);
+		expect(stream.text()).to.equal(stmt.ndjson());
+	});
+	it('should round-trip through Database#importCSV()', async function () {
+		this.db.prepare("INSERT INTO entries VALUES ('a,b', -2, 0.5, NULL, 'say \"hi\"\nbye'), ('', 0, -1.25, NULL, NULL)").run();
+		this.db.prepare('CREATE TABLE copy (a TEXT, b INTEGER, c REAL, e TEXT)').run();
+		const stream = collect();
+		await this.db.prepare('SELECT a, b, c, e FROM entries').exportTo(stream);
+		this.db.importCSV('copy', Buffer.concat(stream.chunks), { infer: true });
+		expect(this.db.prepare('SELECT * FROM copy').all()).to.deep.equal(this.db.prepare('SELECT a, b, c, e FROM entries').all());
+	});
+	it('should be rejected if the stream fails', async function () {
+		const stmt = this.db.prepare('SELECT * FROM entries');
+		const stream = collect({ fail: true });
+		stream.on('error', () => {});
+		await rejectsWith(Error, stmt.exportTo(stream, { chunkSize: 1 }));
+		expect(stmt.busy).to.be.false;
+		expect(stmt.all().length).to.equal(10);
+
+		const closed = collect({ highWaterMark: 1 });
+		const promise = stmt.exportTo(closed, { chunkSize: 1 });
+		closed.destroy();
+		await rejectsWith(Error, promise);
+		expect(stmt.busy).to.be.false;
+		this.db.prepare('DELETE FROM entries').run();
+	});
+	it('should be rejected if the statement fails', async function () {
+		const stmt = this.db.prepare('SELECT b, abs(CASE WHEN b < 8 THEN b ELSE -9223372036854775808 END) FROM entries ORDER BY rowid');
+		const stream = collect();
+		await rejectsWith(Database.SqliteError, stmt.exportTo(stream));
+		expect(stmt.busy).to.be.false;
+		expect(stream.writableEnded).to.be.false;
+		this.db.prepare('DELETE FROM entries').run();
+	});
+	it('should use parameters bound by .bind()', async function () {
+		const stmt = this.db.prepare('SELECT b FROM entries WHERE b > ? ORDER BY rowid').bind(8);
+		const stream = collect();
+		await stmt.exportTo(stream);
+		expect(stream.text()).to.equal('b\n9\n10\n');
+		await rejectsWith(RangeError, this.db.prepare('SELECT b FROM entries WHERE b > ?').exportTo(collect()));
+	});
+});
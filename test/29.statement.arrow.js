@@ -0,0 +1,131 @@
+'use strict';
+const Database = require('../.');
+
+describe('Statement#arrow()', function () {
+	beforeEach(function () {
+		this.db = new Database(util.next());
+		this.db.prepare('CREATE TABLE entries (a TEXT, b INTEGER, c REAL, d BLOB, e TEXT)').run();
+		this.db.prepare("INSERT INTO entries WITH RECURSIVE temp(a, b, c, d, e) AS (SELECT 'foo', 1, 3.14, x'dddddddd', NULL UNION ALL SELECT a, b + 1, c, d, e FROM temp LIMIT 10) SELECT * FROM temp").run();
+	});
+	afterEach(function () {
+		this.db.close();
+	});
+
+	// Decodes just enough of the Arrow IPC stream format to check its layout.
+	const TYPES = { 2: 'int', 3: 'float', 4: 'binary', 5: 'utf8' };
+	const decode = (buffer) => {
+		const table = (position) => {
+			const vtable = position - buffer.readInt32LE(position);
+			return (id) => {
+				const offset = 4 + id * 2 < buffer.readUInt16LE(vtable) ? buffer.readUInt16LE(vtable + 4 + id * 2) : 0;
+				return offset ? position + offset : 0;
+			};
+		};
+		const deref = position => position + buffer.readUInt32LE(position);
+		const schema = [];
+		const batches = [];
+		let offset = 0;
+		for (;;) {
+			expect(buffer.readUInt32LE(offset)).to.equal(0xffffffff);
+			const metadataLength = buffer.readInt32LE(offset + 4);
+			offset += 8;
+			if (metadataLength === 0) break;
+			expect(metadataLength % 8).to.equal(0);
+			const message = table(deref(offset));
+			expect(buffer.readInt16LE(message(0))).to.equal(4);
+			const headerType = buffer.readUInt8(message(1));
+			const header = table(deref(message(2)));
+			const bodyLength = Number(buffer.readBigInt64LE(message(3)));
+			if (headerType === 1) {
+				const fields = deref(header(1));
+				for (let i = 0; i < buffer.readUInt32LE(fields); ++i) {
+					const field = table(deref(fields + 4 + i * 4));
+					const name = deref(field(0));
+					schema.push({
+						name: buffer.toString('utf8', name + 4, name + 4 + buffer.readUInt32LE(name)),
+						type: TYPES[buffer.readUInt8(field(2))],
+					});
+				}
+			} else {
+				expect(headerType).to.equal(3);
+				const nodes = deref(header(1));
+				const nullCounts = [];
+				for (let i = 0; i < buffer.readUInt32LE(nodes); ++i) {
+					nullCounts.push(Number(buffer.readBigInt64LE(nodes + 12 + i * 16)));
+				}
+				batches.push({ length: Number(buffer.readBigInt64LE(header(0))), nullCounts, body: buffer.subarray(offset + metadataLength, offset + metadataLength + bodyLength) });
+			}
+			offset += metadataLength + bodyLength;
+		}
+		expect(offset).to.equal(buffer.length);
+		return { schema, batches };
+	};
+
+	it('should throw an exception when used on a statement that returns no data', function () {
+		const stmt = this.db.prepare("INSERT INTO entries VALUES ('foo', 1, 3.14, x'dddddddd', NULL)");
+		expect(() => stmt.arrow()).to.throw(TypeError);
+	});
+	it('should throw an exception when given an invalid batch size', function () {
+		const stmt = this.db.prepare('SELECT * FROM entries');
+		expect(() => stmt.arrow({ batchSize: null })).to.throw(TypeError);
+		expect(() => stmt.arrow({ batchSize: '10' })).to.throw(TypeError);
+		expect(() => stmt.arrow({ batchSize: 1.5 })).to.throw(TypeError);
+		expect(() => stmt.arrow({ batchSize: 0 })).to.throw(RangeError);
+		expect(() => stmt.arrow({ batchSize: -1 })).to.throw(RangeError);
+		expect(() => stmt.arrow(10)).to.throw(RangeError);
+		expect(stmt.arrow()).to.be.an.instanceof(Buffer);
+	});
+	it('should return a stream with a schema and record batches', function () {
+		const { schema, batches } = decode(this.db.prepare('SELECT * FROM entries').arrow());
+		expect(schema).to.deep.equal([
+			{ name: 'a', type: 'utf8' },
+			{ name: 'b', type: 'int' },
+			{ name: 'c', type: 'float' },
+			{ name: 'd', type: 'binary' },
+			{ name: 'e', type: 'utf8' },
+		]);
+		expect(batches.length).to.equal(1);
+		expect(batches[0].length).to.equal(10);
+		expect(batches[0].nullCounts).to.deep.equal([0, 0, 0, 0, 10]);
+	});
+	it('should split the rows into batches of the given size', function () {
+		const stmt = this.db.prepare('SELECT b FROM entries ORDER BY rowid');
+		expect(decode(stmt.arrow({ batchSize: 3 })).batches.map(batch => batch.length)).to.deep.equal([3, 3, 3, 1]);
+		expect(decode(stmt.arrow({ batchSize: 10 })).batches.map(batch => batch.length)).to.deep.equal([10]);
+		const { batches } = decode(stmt.arrow({ batchSize: 4 }));
+		expect(batches[1].body.readBigInt64LE(0)).to.equal(5n);
+		expect(batches[1].body.readBigInt64LE(24)).to.equal(8n);
+	});
+	it('should choose column types that fit every value', function () {
+		this.db.prepare("INSERT INTO entries VALUES (NULL, 2.5, 7, 'text', NULL)").run();
+		const { schema } = decode(this.db.prepare('SELECT b, c, d, a, b || 1 AS f, NULL AS g FROM entries').arrow());
+		expect(schema.map(field => field.type)).to.deep.equal(['float', 'float', 'binary', 'utf8', 'utf8', 'utf8']);
+		const { body } = decode(this.db.prepare('SELECT b FROM entries WHERE c = 7').arrow()).batches[0];
+		expect(body.readDoubleLE(0)).to.equal(2.5);
+	});
+	it('should use declared types for columns without values', function () {
+		const { schema, batches } = decode(this.db.prepare('SELECT * FROM entries WHERE b > 99').arrow());
+		expect(schema.map(field => field.type)).to.deep.equal(['utf8', 'int', 'float', 'binary', 'utf8']);
+		expect(batches).to.deep.equal([]);
+	});
+	it('should accept bind parameters', function () {
+		const stmt = this.db.prepare('SELECT b FROM entries WHERE b > ? ORDER BY rowid');
+		expect(() => stmt.arrow()).to.throw(RangeError);
+		expect(decode(stmt.arrow(7)).batches[0].length).to.equal(3);
+		expect(decode(stmt.arrow([7])).batches[0].length).to.equal(3);
+		expect(decode(stmt.arrow(4, { batchSize: 2 })).batches.map(batch => batch.length)).to.deep.equal([2, 2, 2]);
+		expect(() => stmt.arrow(7, 8)).to.throw(RangeError);
+
+		const named = this.db.prepare('SELECT b FROM entries WHERE b > @min AND b < @max');
+		expect(decode(named.arrow({ min: 2, max: 9 })).batches[0].length).to.equal(6);
+		expect(decode(named.arrow({ min: 2, max: 9 }, { batchSize: 4 })).batches.map(batch => batch.length)).to.deep.equal([4, 2]);
+		expect(() => named.arrow({ min: 2 })).to.throw(RangeError);
+	});
+	it('should use parameters bound by .bind()', function () {
+		const stmt = this.db.prepare('SELECT b FROM entries WHERE b > ?');
+		expect(() => stmt.arrow()).to.throw(RangeError);
+		expect(decode(stmt.bind(7).arrow()).batches[0].length).to.equal(3);
+		expect(decode(stmt.arrow({ batchSize: 1 })).batches.length).to.equal(3);
+		expect(() => stmt.arrow(7)).to.throw(TypeError);
+	});
+});
@@ -153,5 +153,40 @@ describe('Database#transaction()', function () {
 			expect(() => insertMany(40, 50, 10)).to.throw(Database.SqliteError).with.property('code', 'SQLITE_CONSTRAINT_UNIQUE');
 			expect(this.db.prepare('SELECT x FROM data').pluck().all()).to.deep.equal([1, 2, 3, 10, 20, 30]);
 		});
+		it('should report the statements it runs to the verbose logger', function () {
+			const calls = [];
+			const db = new Database(util.next(), { verbose: sql => calls.push(sql) });
+			try {
+				db.prepare('CREATE TABLE data (x UNIQUE)').run();
+				const stmt = db.prepare('INSERT INTO data VALUES (?)');
+				const insertOne = db.transaction(x => stmt.run(x));
+				const insertMany = db.transaction((...values) => values.forEach(insertOne));
+				calls.length = 0;
+				insertMany.immediate(1);
+				expect(() => insertOne.exclusive(1)).to.throw(Database.SqliteError);
+				expect(calls).to.deep.equal([
+					'BEGIN IMMEDIATE',
+					'SAVEPOINT `\t_bs3.\t`',
+					'INSERT INTO data VALUES (1)',
+					'RELEASE `\t_bs3.\t`',
+					'COMMIT',
+					'BEGIN EXCLUSIVE',
+					'INSERT INTO data VALUES (1)',
+					'ROLLBACK',
+				]);
+			} finally {
+				db.close();
+			}
+		});
+		it('should throw if a transaction control statement fails', function () {
+			const trx = this.db.transaction(() => {
+				this.db.prepare('COMMIT').run();
+			});
+			expect(() => trx()).to.throw(Database.SqliteError);
+			expect(this.db.inTransaction).to.be.false;
+			const closing = this.db.transaction(() => this.db.close());
+			expect(() => closing()).to.throw(TypeError);
+			this.db = new Database(util.current());
+		});
 	});
 });
@@ -0,0 +1,153 @@
+'use strict';
+const fs = require('fs');
+const Database = require('../.');
+
+describe('Database#importCSV()', function () {
+	beforeEach(function () {
+		this.db = new Database(util.next());
+		this.db.prepare('CREATE TABLE entries (a TEXT, b INTEGER, c REAL, d TEXT)').run();
+		this.csvFile = `${util.current()}.csv`;
+		this.all = () => this.db.prepare('SELECT * FROM entries ORDER BY rowid').all();
+	});
+	afterEach(function () {
+		this.db.close();
+	});
+
+	it('should throw an exception if the arguments are invalid', function () {
+		const csv = Buffer.from('a,b\n1,2\n');
+		expect(() => this.db.importCSV()).to.throw(TypeError);
+		expect(() => this.db.importCSV(123, csv)).to.throw(TypeError);
+		expect(() => this.db.importCSV('', csv)).to.throw(TypeError);
+		expect(() => this.db.importCSV('entries')).to.throw(TypeError);
+		expect(() => this.db.importCSV('entries', 123)).to.throw(TypeError);
+		expect(() => this.db.importCSV('entries', '')).to.throw(TypeError);
+		expect(() => this.db.importCSV('entries', csv, 'options')).to.throw(TypeError);
+		expect(() => this.db.importCSV('entries', csv, { delimiter: ';;' })).to.throw(TypeError);
+		expect(() => this.db.importCSV('entries', csv, { delimiter: '\n' })).to.throw(TypeError);
+		expect(() => this.db.importCSV('entries', csv, { delimiter: 'é' })).to.throw(TypeError);
+		expect(() => this.db.importCSV('entries', csv, { quote: ',' })).to.throw(TypeError);
+		expect(() => this.db.importCSV('entries', csv, { header: 1 })).to.throw(TypeError);
+		expect(() => this.db.importCSV('entries', csv, { infer: 'yes' })).to.throw(TypeError);
+		expect(() => this.db.importCSV('entries', csv, { columns: 'a' })).to.throw(TypeError);
+		expect(() => this.db.importCSV('entries', csv, { columns: [] })).to.throw(TypeError);
+		expect(() => this.db.importCSV('entries', csv, { columns: ['a', ''] })).to.throw(TypeError);
+		expect(() => this.db.importCSV('entries', csv, { batchSize: 0 })).to.throw(TypeError);
+		expect(() => this.db.importCSV('entries', csv, { batchSize: 1.5 })).to.throw(TypeError);
+		expect(() => this.db.importCSV('entries', csv, { attached: '' })).to.throw(TypeError);
+		expect(this.all()).to.deep.equal([]);
+	});
+	it('should import records from a buffer', function () {
+		const csv = Buffer.from('a,b,c,d\nfoo,1,3.14,\n"bar, ""baz""",2,2.5,"multi\r\nline"\r\n\n,3,,x\n');
+		const result = this.db.importCSV('entries', csv);
+		expect(result).to.be.an('object');
+		expect(result.rows).to.equal(3);
+		expect(result.bytes).to.equal(csv.length);
+		expect(result.duration).to.be.a('number');
+		expect(this.all()).to.deep.equal([
+			{ a: 'foo', b: 1, c: 3.14, d: '' },
+			{ a: 'bar, "baz"', b: 2, c: 2.5, d: 'multi\r\nline' },
+			{ a: '', b: 3, c: '', d: 'x' },
+		]);
+	});
+	it('should import records from a file', function () {
+		const lines = ['d,c,b,a'];
+		for (let i = 0; i < 50000; ++i) lines.push(`"text ${i}",${i / 2},${i},"row ""${i}"""`);
+		fs.writeFileSync(this.csvFile, '﻿' + lines.join('\r\n'));
+		const result = this.db.importCSV('entries', this.csvFile, { batchSize: 999 });
+		expect(result.rows).to.equal(50000);
+		expect(result.bytes).to.equal(fs.statSync(this.csvFile).size);
+		const rows = this.all();
+		expect(rows.length).to.equal(50000);
+		expect(rows[0]).to.deep.equal({ a: 'row "0"', b: 0, c: 0, d: 'text 0' });
+		expect(rows[49999]).to.deep.equal({ a: 'row "49999"', b: 49999, c: 24999.5, d: 'text 49999' });
+		expect(() => this.db.importCSV('entries', `${this.csvFile}.missing`)).to.throw(Error, /Cannot open file/);
+	});
+	it('should respect the header, columns, delimiter, and quote options', function () {
+		this.db.importCSV('entries', Buffer.from("foo\t1\t'x\ty'\t''''\n"), { header: false, delimiter: '\t', quote: "'" });
+		this.db.importCSV('entries', Buffer.from('bar|2\n'), { header: false, delimiter: '|', columns: ['a', 'b'] });
+		this.db.importCSV('entries', Buffer.from('x,y\nbaz,3\n'), { columns: ['d', 'b'] });
+		expect(this.all()).to.deep.equal([
+			{ a: 'foo', b: 1, c: 'x\ty', d: "'" },
+			{ a: 'bar', b: 2, c: null, d: null },
+			{ a: null, b: 3, c: null, d: 'baz' },
+		]);
+	});
+	it('should infer numbers and nulls when the infer option is true', function () {
+		this.db.prepare('CREATE TABLE untyped (x, y, z)').run();
+		const csv = Buffer.from('x,y,z\n1,-2.5,\n007,"42",1e3\n-0,0.5,abc\n99999999999999999999,1.,-\n');
+		this.db.importCSV('untyped', csv, { infer: true });
+		this.db.importCSV('untyped', csv);
+		const rows = this.db.prepare('SELECT x, y, z FROM untyped ORDER BY rowid').raw().all();
+		expect(rows).to.deep.equal([
+			[1, -2.5, null],
+			['007', '42', 1000],
+			[0, 0.5, 'abc'],
+			[1e20, 1, '-'],
+			['1', '-2.5', ''],
+			['007', '42', '1e3'],
+			['-0', '0.5', 'abc'],
+			['99999999999999999999', '1.', '-'],
+		]);
+	});
+	it('should throw an exception for malformed records', function () {
+		expect(() => this.db.importCSV('entries', Buffer.from('a,b\n1,2\n3\n'))).to.throw(RangeError, /^Expected 2 fields on line 3, but found 1$/);
+		expect(() => this.db.importCSV('entries', Buffer.from('a,b\n1,2\n"3,4\n'))).to.throw(Error, /^Unterminated quoted field on line 3$/);
+		expect(() => this.db.importCSV('entries', Buffer.from('a,b\n"1"x,2\n'))).to.throw(Error, /^Unexpected character after a closing quote on line 2$/);
+		expect(() => this.db.importCSV('entries', Buffer.from('a,b\r\n\r\n"x\ny",2\r\n"1"x,2\r\n'))).to.throw(Error, /^Unexpected character after a closing quote on line 5$/);
+		expect(() => this.db.importCSV('entries', Buffer.from('"a,b\n'))).to.throw(Error, /^Unterminated quoted field on line 1$/);
+		fs.writeFileSync(this.csvFile, 'a,b\n1,2\n\n"1"x,2\n');
+		expect(() => this.db.importCSV('entries', this.csvFile)).to.throw(Error, /^Unexpected character after a closing quote on line 4$/);
+		expect(this.all()).to.deep.equal([]);
+	});
+	it('should throw an exception if the buffer is detached during the import', function () {
+		let detach = () => {};
+		this.db.function('detach', () => { detach(); return null; });
+		this.db.prepare('CREATE TRIGGER detacher AFTER INSERT ON entries BEGIN SELECT detach(); END').run();
+		const copy = new Uint8Array(Buffer.from('a,b\nfoo,1\nbar,2\nbaz,3\n'));
+		const csv = Buffer.from(copy.buffer);
+		detach = () => { if (csv.length) structuredClone(copy.buffer, { transfer: [copy.buffer] }); };
+		expect(() => this.db.importCSV('entries', csv)).to.throw(RangeError);
+		expect(this.all()).to.deep.equal([]);
+		expect(this.db.inTransaction).to.be.false;
+	});
+	it('should not bind fields in place from a buffer that can be detached', function () {
+		const seen = [];
+		let detach = () => {};
+		this.db.function('detach', () => { detach(); return null; });
+		this.db.function('see', (a) => { seen.push(a); return null; });
+		this.db.prepare('CREATE TRIGGER detacher BEFORE INSERT ON entries BEGIN SELECT detach(); SELECT see(NEW.a); END').run();
+		const copy = new Uint8Array(Buffer.from('a,b\nfoo,1\nbar,2\n'));
+		const csv = Buffer.from(copy.buffer);
+		detach = () => { if (csv.length) structuredClone(copy.buffer, { transfer: [copy.buffer] }); };
+		expect(() => this.db.importCSV('entries', csv)).to.throw(RangeError);
+		expect(seen).to.deep.equal(['foo']);
+		expect(this.all()).to.deep.equal([]);
+	});
+	it('should throw an SqliteError if the rows cannot be inserted', function () {
+		expect(() => this.db.importCSV('nonexistent', Buffer.from('a\n1\n'))).to.throw(Database.SqliteError);
+		expect(() => this.db.importCSV('entries', Buffer.from('nonexistent\n1\n'))).to.throw(Database.SqliteError);
+		this.db.prepare('CREATE TABLE strict (x INTEGER NOT NULL, y TEXT)').run();
+		expect(() => this.db.importCSV('strict', Buffer.from('x,y\n1,a\n2,b\n,c\n'), { infer: true, batchSize: 1 }))
+			.to.throw(Database.SqliteError).with.property('code', 'SQLITE_CONSTRAINT_NOTNULL');
+		expect(this.db.prepare('SELECT x FROM strict').pluck().all()).to.deep.equal([1, 2]);
+		expect(this.db.inTransaction).to.be.false;
+	});
+	it('should roll back completely when used within a transaction', function () {
+		this.db.prepare('CREATE TABLE strict (x INTEGER NOT NULL, y TEXT)').run();
+		const trx = this.db.transaction(csv => this.db.importCSV('strict', csv, { infer: true, batchSize: 1 }));
+		expect(() => trx(Buffer.from('x,y\n1,a\n2,b\n,c\n'))).to.throw(Database.SqliteError);
+		expect(this.db.prepare('SELECT x FROM strict').pluck().all()).to.deep.equal([]);
+		expect(trx(Buffer.from('x,y\n1,a\n2,b\n')).rows).to.equal(2);
+		expect(this.db.prepare('SELECT x FROM strict').pluck().all()).to.deep.equal([1, 2]);
+	});
+	it('should quote table and column names', function () {
+		this.db.prepare('CREATE TABLE "weird ""table""" ("col ""1""", "col,2")').run();
+		this.db.importCSV('weird "table"', Buffer.from('"col ""1""","col,2"\nfoo,bar\n'));
+		expect(this.db.prepare('SELECT * FROM "weird ""table"""').raw().all()).to.deep.equal([['foo', 'bar']]);
+	});
+	it('should do nothing for empty input', function () {
+		expect(this.db.importCSV('entries', Buffer.alloc(0)).rows).to.equal(0);
+		expect(this.db.importCSV('entries', Buffer.from('a,b\n')).rows).to.equal(0);
+		expect(this.all()).to.deep.equal([]);
+	});
+});
@@ -0,0 +1,158 @@
+'use strict';
+const Database = require('../.');
+
+describe('Database#insertColumns()', function () {
+	beforeEach(function () {
+		this.db = new Database(util.next());
+		this.db.prepare('CREATE TABLE entries (a TEXT, b INTEGER, c REAL, d BLOB)').run();
+		this.all = () => this.db.prepare('SELECT * FROM entries ORDER BY rowid').all();
+	});
+	afterEach(function () {
+		this.db.close();
+	});
+
+	it('should throw an exception if the arguments are invalid', function () {
+		const columns = { b: [1, 2] };
+		expect(() => this.db.insertColumns()).to.throw(TypeError);
+		expect(() => this.db.insertColumns(123, columns)).to.throw(TypeError);
+		expect(() => this.db.insertColumns('', columns)).to.throw(TypeError);
+		expect(() => this.db.insertColumns('entries')).to.throw(TypeError);
+		expect(() => this.db.insertColumns('entries', null)).to.throw(TypeError);
+		expect(() => this.db.insertColumns('entries', [[1, 2]])).to.throw(TypeError);
+		expect(() => this.db.insertColumns('entries', {})).to.throw(TypeError);
+		expect(() => this.db.insertColumns('entries', { b: 'foo' })).to.throw(TypeError);
+		expect(() => this.db.insertColumns('entries', { b: new DataView(new ArrayBuffer(8)) })).to.throw(TypeError);
+		expect(() => this.db.insertColumns('entries', { b: [1, 2], c: [1] })).to.throw(RangeError);
+		expect(() => this.db.insertColumns('entries', columns, 'options')).to.throw(TypeError);
+		expect(() => this.db.insertColumns('entries', columns, { attached: '' })).to.throw(TypeError);
+		expect(() => this.db.insertColumns('entries', Buffer.from('not arrow'))).to.throw(TypeError);
+		expect(this.all()).to.deep.equal([]);
+	});
+	it('should insert columns of arrays and typed arrays', function () {
+		const result = this.db.insertColumns('entries', {
+			a: ['foo', null, 'baz'],
+			b: new Int32Array([1, -2, 3]),
+			c: new Float64Array([0.5, 1.5, NaN]),
+			d: [Buffer.from([1, 2]), Buffer.alloc(0), undefined],
+		});
+		expect(result.rows).to.equal(3);
+		expect(result.duration).to.be.a('number');
+		expect(this.all()).to.deep.equal([
+			{ a: 'foo', b: 1, c: 0.5, d: Buffer.from([1, 2]) },
+			{ a: null, b: -2, c: 1.5, d: Buffer.alloc(0) },
+			{ a: 'baz', b: 3, c: null, d: null },
+		]);
+	});
+	it('should bind integer typed arrays as integers', function () {
+		this.db.prepare('CREATE TABLE numbers (x ANY) STRICT').run();
+		const insert = (column) => {
+			this.db.prepare('DELETE FROM numbers').run();
+			this.db.insertColumns('numbers', { x: column });
+			return this.db.prepare('SELECT typeof(x) AS type, x FROM numbers ORDER BY rowid').raw().all();
+		};
+		expect(insert(new Uint8Array([255]))).to.deep.equal([['integer', 255]]);
+		expect(insert(new Uint32Array([0xffffffff]))).to.deep.equal([['integer', 0xffffffff]]);
+		expect(insert(new Float32Array([2]))).to.deep.equal([['real', 2]]);
+		expect(insert(new BigInt64Array([-9007199254740993n]))).to.deep.equal([['integer', -9007199254740992]]);
+		expect(insert(new BigUint64Array([9223372036854775807n]))).to.deep.equal([['integer', 9223372036854775807]]);
+		expect(() => insert(new BigUint64Array([9223372036854775808n]))).to.throw(RangeError);
+		expect(insert([1, 2.5, 3n])).to.deep.equal([['integer', 1], ['real', 2.5], ['integer', 3]]);
+	});
+	it('should throw an exception for values that cannot be bound', function () {
+		expect(() => this.db.insertColumns('entries', { a: ['foo', {}] })).to.throw(TypeError);
+		expect(() => this.db.insertColumns('entries', { a: ['foo', () => {}] })).to.throw(TypeError);
+		expect(this.all()).to.deep.equal([]);
+	});
+	it('should round-trip through Statement#arrow()', function () {
+		this.db.prepare("INSERT INTO entries WITH RECURSIVE temp(x) AS (SELECT 1 UNION ALL SELECT x + 1 FROM temp LIMIT 100) SELECT 'foo' || x, x * 1000000000000, x / 8.0, randomblob(x % 4) FROM temp").run();
+		this.db.prepare("INSERT INTO entries VALUES (NULL, NULL, NULL, NULL), ('', -9223372036854775808, -0.5, x'')").run();
+		this.db.prepare('CREATE TABLE copy (a TEXT, b INTEGER, c REAL, d BLOB)').run();
+		const expected = this.all();
+		const { rows } = this.db.insertColumns('copy', this.db.prepare('SELECT * FROM entries ORDER BY rowid').arrow({ batchSize: 7 }));
+		expect(rows).to.equal(102);
+		this.db.defaultSafeIntegers();
+		expect(this.db.prepare('SELECT * FROM copy ORDER BY rowid').all()).to.deep.equal(this.db.prepare('SELECT * FROM entries ORDER BY rowid').all());
+		this.db.defaultSafeIntegers(false);
+		expect(this.db.prepare('SELECT * FROM copy ORDER BY rowid').all()).to.deep.equal(expected);
+	});
+	it('should insert Arrow fields into the columns of the same name', function () {
+		const arrow = this.db.prepare("SELECT 3.5 AS c, 'bar' AS a").arrow();
+		this.db.insertColumns('entries', arrow);
+		expect(this.all()).to.deep.equal([{ a: 'bar', b: null, c: 3.5, d: null }]);
+		expect(() => this.db.insertColumns('entries', this.db.prepare('SELECT 1 AS x').arrow())).to.throw(Database.SqliteError);
+	});
+	it('should throw an exception for malformed Arrow data', function () {
+		const arrow = this.db.prepare("SELECT 'foo' AS a, 1 AS b").arrow();
+		expect(() => this.db.insertColumns('entries', arrow.subarray(0, arrow.length - 20))).to.throw(TypeError);
+		expect(() => this.db.insertColumns('entries', arrow.subarray(0, 16))).to.throw(TypeError);
+		expect(this.all()).to.deep.equal([]);
+	});
+	it('should not insert any rows if a row cannot be inserted', function () {
+		this.db.prepare('CREATE TABLE strict (x INTEGER NOT NULL)').run();
+		expect(() => this.db.insertColumns('strict', { x: [1, 2, null, 4] })).to.throw(Database.SqliteError);
+		expect(this.db.prepare('SELECT count(*) FROM strict').pluck().get()).to.equal(0);
+		expect(this.db.inTransaction).to.be.false;
+
+		this.db.prepare('INSERT INTO strict VALUES (99)').run();
+		this.db.transaction(() => {
+			this.db.prepare('INSERT INTO strict VALUES (100)').run();
+			expect(() => this.db.insertColumns('strict', { x: [1, null] })).to.throw(Database.SqliteError);
+			expect(this.db.inTransaction).to.be.true;
+			this.db.insertColumns('strict', { x: new Int8Array([5]) });
+		})();
+		expect(this.db.prepare('SELECT x FROM strict ORDER BY rowid').pluck().all()).to.deep.equal([99, 100, 5]);
+	});
+	it('should propagate exceptions thrown by user-defined functions', function () {
+		const err = new Error('foo');
+		this.db.function('fail', { deterministic: true }, (x) => { if (x === 2) throw err; return x; });
+		this.db.prepare('CREATE TABLE checked (x INTEGER CHECK (fail(x) = x))').run();
+		expect(() => this.db.insertColumns('checked', { x: [1, 2] })).to.throw(err);
+		expect(this.db.prepare('SELECT count(*) FROM checked').pluck().get()).to.equal(0);
+	});
+	it('should throw an exception if a column buffer is detached during the insert', function () {
+		let detach = () => {};
+		this.db.function('detach', () => { detach(); return null; });
+		this.db.prepare('CREATE TRIGGER detacher AFTER INSERT ON entries BEGIN SELECT detach(); END').run();
+
+		const column = new Int32Array([1, 2, 3]);
+		detach = () => { if (column.length) structuredClone(column.buffer, { transfer: [column.buffer] }); };
+		expect(() => this.db.insertColumns('entries', { b: column })).to.throw(RangeError);
+		expect(this.all()).to.deep.equal([]);
+
+		const copy = new Uint8Array(this.db.prepare("SELECT 'foo' AS a UNION ALL SELECT 'bar'").arrow());
+		const arrow = Buffer.from(copy.buffer);
+		detach = () => { if (arrow.length) structuredClone(copy.buffer, { transfer: [copy.buffer] }); };
+		expect(() => this.db.insertColumns('entries', arrow)).to.throw(RangeError);
+		expect(this.all()).to.deep.equal([]);
+		expect(this.db.inTransaction).to.be.false;
+	});
+	it('should not bind values in place from a buffer that can be detached', function () {
+		const seen = [];
+		let detach = () => {};
+		this.db.function('detach', () => { detach(); return null; });
+		this.db.function('see', (a, d) => { seen.push([a, d]); return null; });
+		this.db.prepare('CREATE TRIGGER detacher BEFORE INSERT ON entries BEGIN SELECT detach(); SELECT see(NEW.a, NEW.d); END').run();
+
+		const copy = new Uint8Array(this.db.prepare("SELECT 'foo' AS a, x'dddd' AS d").arrow());
+		const arrow = Buffer.from(copy.buffer);
+		detach = () => { if (arrow.length) structuredClone(copy.buffer, { transfer: [copy.buffer] }); };
+		expect(() => this.db.insertColumns('entries', arrow)).to.throw(RangeError);
+		expect(seen).to.deep.equal([['foo', Buffer.from([0xdd, 0xdd])]]);
+		expect(this.all()).to.deep.equal([]);
+	});
+	it('should accept the "attached" option', function () {
+		this.db.prepare("ATTACH ':memory:' AS other").run();
+		this.db.prepare('CREATE TABLE other.entries (x INTEGER)').run();
+		this.db.insertColumns('entries', { x: [1, 2] }, { attached: 'other' });
+		expect(this.db.prepare('SELECT x FROM other.entries').pluck().all()).to.deep.equal([1, 2]);
+		expect(this.all()).to.deep.equal([]);
+	});
+	it('should not be allowed while the database is busy', function () {
+		this.db.prepare('INSERT INTO entries VALUES (1, 2, 3, NULL)').run();
+		const iterator = this.db.prepare('SELECT * FROM entries').iterate();
+		iterator.next();
+		expect(() => this.db.insertColumns('entries', { b: [1] })).to.throw(TypeError);
+		iterator.return();
+		this.db.insertColumns('entries', { b: [1] });
+	});
+});
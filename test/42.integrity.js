@@ -104,6 +104,17 @@ describe('integrity checks', function () {
 		});
 	});
 
+	describe('Database#transaction()', function () {
+		specify('while iterating (blocked)', function () {
+			const inner = this.db.transaction(() => this.writer.run());
+			const outer = this.db.transaction(() => whileIterating(this, blocked(() => inner())));
+			whileIterating(this, blocked(() => inner()));
+			normally(allowed(() => outer()));
+			normally(allowed(() => inner()));
+			expect(this.db.inTransaction).to.be.false;
+		});
+	});
+
 	describe('Database#backup()', function () {
 		specify('while iterating (allowed)', async function () {
 			const promises = [];
@@ -127,6 +138,89 @@ describe('integrity checks', function () {
 		});
 	});
 
+	describe('Database#insertColumns()', function () {
+		specify('while iterating (blocked)', function () {
+			whileIterating(this, blocked(() => this.db.insertColumns('entries', { b: [1, 2] })));
+			normally(allowed(() => this.db.insertColumns('entries', { b: [1, 2] })));
+		});
+		specify('while busy (blocked)', function () {
+			whileBusy(this, blocked(() => this.db.insertColumns('entries', { b: [1, 2] })));
+			normally(allowed(() => this.db.insertColumns('entries', { b: [1, 2] })));
+		});
+		specify('while closed (blocked)', function () {
+			whileClosed(this, blocked(() => this.db.insertColumns('entries', { b: [1, 2] })));
+		});
+	});
+
+	describe('Database#batchWrites()', function () {
+		specify('while iterating (allowed)', function () {
+			whileIterating(this, allowed(() => this.db.batchWrites({ maxDelay: 60000 })));
+			normally(allowed(() => this.db.batchWrites(false)));
+		});
+		specify('while busy (blocked)', function () {
+			whileBusy(this, blocked(() => this.db.batchWrites({ maxDelay: 60000 })));
+			normally(allowed(() => this.db.batchWrites(false)));
+		});
+		specify('while closed (blocked)', function () {
+			whileClosed(this, blocked(() => this.db.batchWrites({ maxDelay: 60000 })));
+		});
+	});
+
+	describe('Database#checkpointer()', function () {
+		specify('while iterating (allowed)', function () {
+			whileIterating(this, allowed(() => this.db.checkpointer().checkpointer(false)));
+		});
+		specify('while busy (blocked)', function () {
+			whileBusy(this, blocked(() => this.db.checkpointer()));
+			whileBusy(this, blocked(() => this.db.checkpointer(false)));
+			normally(allowed(() => this.db.checkpointer().checkpointer(false)));
+		});
+		specify('while closed (blocked)', function () {
+			whileClosed(this, blocked(() => this.db.checkpointer()));
+			whileClosed(this, blocked(() => this.db.checkpointer(false)));
+		});
+	});
+
+	describe('Database#onChange()', function () {
+		specify('while iterating (allowed)', function () {
+			whileIterating(this, allowed(() => this.db.onChange(() => {})()));
+		});
+		specify('while busy (blocked)', function () {
+			whileBusy(this, blocked(() => this.db.onChange(() => {})));
+			normally(allowed(() => this.db.onChange(() => {})()));
+		});
+		specify('while closed (blocked)', function () {
+			whileClosed(this, blocked(() => this.db.onChange(() => {})));
+		});
+	});
+
+	describe('Database#createSession()', function () {
+		specify('while iterating (allowed)', function () {
+			whileIterating(this, allowed(() => this.db.createSession().close()));
+		});
+		specify('while busy (blocked)', function () {
+			whileBusy(this, blocked(() => this.db.createSession()));
+			normally(allowed(() => this.db.createSession().close()));
+		});
+		specify('while closed (blocked)', function () {
+			whileClosed(this, blocked(() => this.db.createSession()));
+		});
+	});
+
+	describe('Database#applyChangeset()', function () {
+		specify('while iterating (blocked)', function () {
+			whileIterating(this, blocked(() => this.db.applyChangeset(Buffer.alloc(0))));
+			normally(allowed(() => this.db.applyChangeset(Buffer.alloc(0))));
+		});
+		specify('while busy (blocked)', function () {
+			whileBusy(this, blocked(() => this.db.applyChangeset(Buffer.alloc(0))));
+			normally(allowed(() => this.db.applyChangeset(Buffer.alloc(0))));
+		});
+		specify('while closed (blocked)', function () {
+			whileClosed(this, blocked(() => this.db.applyChangeset(Buffer.alloc(0))));
+		});
+	});
+
 	describe('Database#function()', function () {
 		specify('while iterating (blocked)', function () {
 			let i = 0;
@@ -243,6 +337,31 @@ describe('integrity checks', function () {
 		});
 	});
 
+	describe('Database#timeLimit()', function () {
+		specify('while iterating (allowed)', function () {
+			whileIterating(this, allowed(() => this.db.timeLimit(1000)));
+		});
+		specify('while busy (blocked)', function () {
+			whileBusy(this, blocked(() => this.db.timeLimit(1000)));
+			normally(allowed(() => this.db.timeLimit(1000)));
+		});
+		specify('while closed (blocked)', function () {
+			whileClosed(this, blocked(() => this.db.timeLimit(1000)));
+		});
+	});
+
+	describe('Database#interruptHandle()', function () {
+		specify('while iterating (allowed)', function () {
+			whileIterating(this, allowed(() => this.db.interruptHandle()));
+		});
+		specify('while busy (allowed)', function () {
+			whileBusy(this, allowed(() => this.db.interruptHandle()));
+		});
+		specify('while closed (blocked)', function () {
+			whileClosed(this, blocked(() => this.db.interruptHandle()));
+		});
+	});
+
 	describe('Database#open', function () {
 		specify('while iterating (allowed)', function () {
 			whileIterating(this, allowed(() => expect(this.db.open).to.be.true));
@@ -302,6 +421,36 @@ describe('integrity checks', function () {
 		});
 	});
 
+	describe('Statement#compile()', function () {
+		specify('while iterating (allowed for readers, blocked for writers)', function () {
+			const get = this.reader.compile();
+			const run = this.writer.compile();
+			whileIterating(this, allowed(() => get()));
+			whileIterating(this, blocked(() => run()));
+			normally(allowed(() => get()));
+			normally(allowed(() => run()));
+		});
+		specify('while self-iterating (blocked)', function () {
+			const get = this.iterator.compile();
+			whileIterating(this, blocked(() => get()));
+			normally(allowed(() => get()));
+		});
+		specify('while busy (blocked)', function () {
+			const get = this.reader.compile();
+			const run = this.writer.compile();
+			whileBusy(this, blocked(() => get()));
+			whileBusy(this, blocked(() => run()));
+			normally(allowed(() => get()));
+			normally(allowed(() => run()));
+		});
+		specify('while closed (blocked)', function () {
+			const get = this.reader.compile();
+			const run = this.writer.compile();
+			whileClosed(this, blocked(() => get()));
+			blocked(() => run())();
+		});
+	});
+
 	describe('Statement#all()', function () {
 		specify('while iterating (allowed)', function () {
 			whileIterating(this, allowed(() => this.reader.all()));
@@ -320,6 +469,42 @@ describe('integrity checks', function () {
 		});
 	});
 
+	describe('Statement#json()', function () {
+		specify('while iterating (allowed)', function () {
+			whileIterating(this, allowed(() => this.reader.json()));
+			normally(allowed(() => this.reader.json()));
+		});
+		specify('while self-iterating (blocked)', function () {
+			whileIterating(this, blocked(() => this.iterator.json()));
+			normally(allowed(() => this.iterator.json()));
+		});
+		specify('while busy (blocked)', function () {
+			whileBusy(this, blocked(() => this.reader.json()));
+			normally(allowed(() => this.reader.json()));
+		});
+		specify('while closed (blocked)', function () {
+			whileClosed(this, blocked(() => this.reader.json()));
+		});
+	});
+
+	describe('Statement#arrow()', function () {
+		specify('while iterating (allowed)', function () {
+			whileIterating(this, allowed(() => this.reader.arrow()));
+			normally(allowed(() => this.reader.arrow()));
+		});
+		specify('while self-iterating (blocked)', function () {
+			whileIterating(this, blocked(() => this.iterator.arrow()));
+			normally(allowed(() => this.iterator.arrow()));
+		});
+		specify('while busy (blocked)', function () {
+			whileBusy(this, blocked(() => this.reader.arrow()));
+			normally(allowed(() => this.reader.arrow()));
+		});
+		specify('while closed (blocked)', function () {
+			whileClosed(this, blocked(() => this.reader.arrow()));
+		});
+	});
+
 	describe('Statement#iterate()', function () {
 		specify('while iterating (allowed)', function () {
 			whileIterating(this, allowed(() => Array.from(this.reader.iterate())));
@@ -415,6 +600,78 @@ describe('integrity checks', function () {
 		});
 	});
 
+	describe('Statement#lazy()', function () {
+		specify('while iterating (allowed)', function () {
+			whileIterating(this, allowed(() => this.reader.lazy()));
+			normally(allowed(() => this.reader.lazy()));
+		});
+		specify('while self-iterating (blocked)', function () {
+			whileIterating(this, blocked(() => this.iterator.lazy()));
+			normally(allowed(() => this.iterator.lazy()));
+		});
+		specify('while busy (blocked)', function () {
+			whileBusy(this, blocked(() => this.reader.lazy()));
+			normally(allowed(() => this.reader.lazy()));
+		});
+		specify('while closed (allowed)', function () {
+			whileClosed(this, allowed(() => this.reader.lazy()));
+		});
+	});
+
+	describe('Statement#internStrings()', function () {
+		specify('while iterating (allowed)', function () {
+			whileIterating(this, allowed(() => this.reader.internStrings()));
+			normally(allowed(() => this.reader.internStrings()));
+		});
+		specify('while self-iterating (blocked)', function () {
+			whileIterating(this, blocked(() => this.iterator.internStrings()));
+			normally(allowed(() => this.iterator.internStrings()));
+		});
+		specify('while busy (blocked)', function () {
+			whileBusy(this, blocked(() => this.reader.internStrings()));
+			normally(allowed(() => this.reader.internStrings()));
+		});
+		specify('while closed (allowed)', function () {
+			whileClosed(this, allowed(() => this.reader.internStrings()));
+		});
+	});
+
+	describe('Statement#externalStrings()', function () {
+		specify('while iterating (allowed)', function () {
+			whileIterating(this, allowed(() => this.reader.externalStrings()));
+			normally(allowed(() => this.reader.externalStrings()));
+		});
+		specify('while self-iterating (blocked)', function () {
+			whileIterating(this, blocked(() => this.iterator.externalStrings()));
+			normally(allowed(() => this.iterator.externalStrings()));
+		});
+		specify('while busy (blocked)', function () {
+			whileBusy(this, blocked(() => this.reader.externalStrings()));
+			normally(allowed(() => this.reader.externalStrings()));
+		});
+		specify('while closed (allowed)', function () {
+			whileClosed(this, allowed(() => this.reader.externalStrings()));
+		});
+	});
+
+	describe('Statement#cache()', function () {
+		specify('while iterating (allowed)', function () {
+			whileIterating(this, allowed(() => this.reader.cache()));
+			normally(allowed(() => this.reader.cache()));
+		});
+		specify('while self-iterating (blocked)', function () {
+			whileIterating(this, blocked(() => this.iterator.cache()));
+			normally(allowed(() => this.iterator.cache()));
+		});
+		specify('while busy (blocked)', function () {
+			whileBusy(this, blocked(() => this.reader.cache()));
+			normally(allowed(() => this.reader.cache()));
+		});
+		specify('while closed (allowed)', function () {
+			whileClosed(this, allowed(() => this.reader.cache()));
+		});
+	});
+
 	describe('Statement#safeIntegers()', function () {
 		specify('while iterating (allowed)', function () {
 			whileIterating(this, allowed(() => this.reader.safeIntegers()));
@@ -433,6 +690,24 @@ describe('integrity checks', function () {
 		});
 	});
 
+	describe('Statement#timeLimit()', function () {
+		specify('while iterating (allowed)', function () {
+			whileIterating(this, allowed(() => this.reader.timeLimit(1000)));
+			normally(allowed(() => this.reader.timeLimit(1000)));
+		});
+		specify('while self-iterating (blocked)', function () {
+			whileIterating(this, blocked(() => this.iterator.timeLimit(1000)));
+			normally(allowed(() => this.iterator.timeLimit(1000)));
+		});
+		specify('while busy (blocked)', function () {
+			whileBusy(this, blocked(() => this.reader.timeLimit(1000)));
+			normally(allowed(() => this.reader.timeLimit(1000)));
+		});
+		specify('while closed (allowed)', function () {
+			whileClosed(this, allowed(() => this.reader.timeLimit(1000)));
+		});
+	});
+
 	describe('Statement#columns()', function () {
 		specify('while iterating (allowed)', function () {
 			whileIterating(this, allowed(() => this.reader.columns()));
@@ -42,6 +42,34 @@ if (parseInt(process.versions.node) >= 12) {
 					});
 				});
 			});
+			it('can share databases opened with the "memory" vfs', function () {
+				this.slow(1000);
+				return new Promise((resolve, reject) => {
+					const name = `shared-${util.next()}`;
+					const db = this.db = Database(name, { vfs: 'memory' });
+					db.pragma('journal_mode = WAL');
+					db.exec('create table data (x); insert into data values (1), (2), (3)');
+					const worker = new threads.Worker(__filename);
+					worker.on('exit', code => reject(new Error(`worker exited with code ${code}`)));
+					worker.on('error', reject);
+					worker.on('message', ({ msg, data }) => {
+						try {
+							if (msg === 'hello') {
+								worker.postMessage({ msg: 'memory', filename: name });
+							} else if (msg === 'memory') {
+								expect(data).to.deep.equal([1, 2, 3]);
+								resolve();
+								this.cleanup = worker.terminate();
+							} else {
+								throw new Error('unexpected message from worker');
+							}
+						} catch (err) {
+							reject(err);
+							this.cleanup = worker.terminate();
+						}
+					});
+				});
+			});
 		});
 	} else {
 		const { expect } = require('chai');
@@ -57,6 +85,11 @@ if (parseInt(process.versions.node) >= 12) {
 				expect(info.lastInsertRowid).to.be.a('bigint');
 				expect(data.length).to.equal(2);
 				threads.parentPort.postMessage({ msg: 'success', info, data });
+			} else if (msg === 'memory') {
+				const db = Database(filename, { vfs: 'memory', readonly: true });
+				const data = db.prepare('select x from data order by x').pluck().all();
+				db.close();
+				threads.parentPort.postMessage({ msg: 'memory', data });
 			} else {
 				throw new Error('unexpected message from main thread');
 			}
@@ -33,6 +33,19 @@ describe('miscellaneous', function () {
 			.to.deep.equal([{ x: 1, y: 1 }, { x: 2, y: 100 }, { x: 3, y: 100 }]);
 	});
 
+	it('converts ASCII and non-ASCII text correctly', function () {
+		const strings = [
+			'', 'a', 'hello world', 'x'.repeat(31), 'y'.repeat(32), 'z'.repeat(100000),
+			'é', 'ascii prefix then ümlaut', `${'a'.repeat(40)}\u00ff`, `${'b'.repeat(7)}€${'c'.repeat(33)}`,
+			'日本語', '😀', `${'d'.repeat(64)}😀${'e'.repeat(64)}`, '\x7f\x00\x01',
+		];
+		this.db.prepare("CREATE TABLE foo (x TEXT)").run();
+		const insert = this.db.prepare("INSERT INTO foo VALUES (?)");
+		for (const str of strings) insert.run(str);
+		expect(this.db.prepare("SELECT x FROM foo ORDER BY rowid").pluck().all()).to.deep.equal(strings);
+		expect(this.db.prepare("SELECT x FROM foo ORDER BY rowid").raw().all()).to.deep.equal(strings.map(x => [x]));
+	});
+
 	it('persists non-trivial quantities of reads and writes', function () {
 		const runDuration = 1000;
 		const runUntil = Date.now() + runDuration;
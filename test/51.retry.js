@@ -0,0 +1,89 @@
+'use strict';
+const Database = require('../.');
+
+describe('Database#retry()', function () {
+	beforeEach(function () {
+		this.db = new Database(util.next());
+		this.db.pragma('journal_mode = WAL');
+		this.db.prepare('CREATE TABLE entries (a INTEGER)').run();
+		this.other = new Database(util.current());
+	});
+	afterEach(function () {
+		this.other.close();
+		this.db.close();
+	});
+
+	it('should throw an exception if the correct arguments are not provided', function () {
+		expect(() => this.db.retry()).to.throw(TypeError);
+		expect(() => this.db.retry({})).to.throw(TypeError);
+		expect(() => this.db.retry(() => {}, 123)).to.throw(TypeError);
+		expect(() => this.db.retry(() => {}, { timeout: -1 })).to.throw(TypeError);
+		expect(() => this.db.retry(() => {}, { minDelay: 0 })).to.throw(TypeError);
+		expect(() => this.db.retry(() => {}, { minDelay: 10, maxDelay: 5 })).to.throw(TypeError);
+	});
+	it('should resolve with the return value of the function', async function () {
+		const promise = this.db.retry(function () { return this.prepare('INSERT INTO entries VALUES (1)').run().changes; });
+		expect(this.db.prepare('SELECT count(*) FROM entries').pluck().get()).to.equal(1);
+		expect(await promise).to.equal(1);
+	});
+	it('should reject immediately with errors that are not SQLITE_BUSY', async function () {
+		let calls = 0;
+		const err = await this.db.retry(() => { calls += 1; this.db.prepare('INSERT INTO nothing VALUES (1)'); }).catch(err => err);
+		expect(err).to.be.an.instanceof(Database.SqliteError);
+		expect(err.code).to.equal('SQLITE_ERROR');
+		expect(calls).to.equal(1);
+	});
+	it('should retry without blocking until the lock is released', async function () {
+		this.slow(1000);
+		this.other.exec('BEGIN IMMEDIATE');
+		let calls = 0;
+		let ticks = 0;
+		const interval = setInterval(() => { ticks += 1; }, 1);
+		setTimeout(() => this.other.exec('COMMIT'), 100);
+		const start = Date.now();
+		await this.db.retry(() => { calls += 1; this.db.prepare('INSERT INTO entries VALUES (1)').run(); });
+		clearInterval(interval);
+		expect(Date.now() - start).to.be.at.least(90);
+		expect(calls).to.be.above(1);
+		expect(ticks).to.be.above(10);
+		expect(this.db.prepare('SELECT count(*) FROM entries').pluck().get()).to.equal(1);
+	});
+	it('should reject with SQLITE_BUSY once the timeout has passed', async function () {
+		this.slow(1000);
+		this.other.exec('BEGIN IMMEDIATE');
+		const start = Date.now();
+		const err = await this.db.retry(() => this.db.prepare('INSERT INTO entries VALUES (1)').run(), { timeout: 50 }).catch(err => err);
+		expect(Date.now() - start).to.be.below(1000);
+		expect(err).to.be.an.instanceof(Database.SqliteError);
+		expect(err.code).to.equal('SQLITE_BUSY');
+		this.other.exec('COMMIT');
+	});
+	it('should restore the busy timeout of the connection', async function () {
+		await this.db.retry(() => {
+			expect(this.db.pragma('busy_timeout', { simple: true })).to.equal(0);
+		});
+		expect(this.db.pragma('busy_timeout', { simple: true })).to.equal(5000);
+	});
+	it('should restore a busy timeout that was set with a pragma', async function () {
+		this.db.pragma('busy_timeout = 1234');
+		await this.db.retry(() => {
+			expect(this.db.pragma('busy_timeout', { simple: true })).to.equal(0);
+		});
+		expect(this.db.pragma('busy_timeout', { simple: true })).to.equal(1234);
+	});
+	it('should repeat the side effects of a function that is not a transaction', async function () {
+		this.slow(1000);
+		this.other.exec('BEGIN IMMEDIATE');
+		setTimeout(() => this.other.exec('COMMIT'), 50);
+		this.db.prepare('CREATE TEMP TABLE attempts (n INTEGER)').run();
+		let calls = 0;
+		await this.db.retry(() => {
+			calls += 1;
+			this.db.prepare('INSERT INTO attempts VALUES (?)').run(calls);
+			this.db.prepare('INSERT INTO entries VALUES (?)').run(calls);
+		});
+		expect(calls).to.be.above(1);
+		expect(this.db.prepare('SELECT count(*) FROM attempts').pluck().get()).to.equal(calls);
+		expect(this.db.prepare('SELECT count(*) FROM entries').pluck().get()).to.equal(1);
+	});
+});
@@ -0,0 +1,83 @@
+'use strict';
+const fs = require('fs');
+const Database = require('../.');
+
+describe('Database#checkpointer()', function () {
+	beforeEach(function () {
+		this.db = new Database(util.next());
+		this.db.pragma('journal_mode = WAL');
+		this.db.prepare('CREATE TABLE entries (a BLOB)').run();
+	});
+	afterEach(function () {
+		this.db.close();
+	});
+
+	const wait = ms => new Promise(resolve => setTimeout(resolve, ms));
+	const fill = (db, count) => {
+		const stmt = db.prepare('INSERT INTO entries VALUES (randomblob(1000))');
+		for (let i = 0; i < count; ++i) stmt.run();
+	};
+
+	it('should throw an exception if invalid options are provided', function () {
+		expect(() => this.db.checkpointer(123)).to.throw(TypeError);
+		expect(() => this.db.checkpointer({ mode: 'SOMETIMES' })).to.throw(TypeError);
+		expect(() => this.db.checkpointer({ mode: 2 })).to.throw(TypeError);
+		expect(() => this.db.checkpointer({ intervalMs: 0 })).to.throw(TypeError);
+		expect(() => this.db.checkpointer({ intervalMs: 1.5 })).to.throw(TypeError);
+		expect(() => this.db.checkpointer({ walSizeLimit: -1 })).to.throw(TypeError);
+		expect(this.db.checkpointStats()).to.be.null;
+	});
+	it('should throw an exception for in-memory databases', function () {
+		const db = new Database(':memory:');
+		try {
+			expect(() => db.checkpointer()).to.throw(Database.SqliteError);
+			expect(db.checkpointStats()).to.be.null;
+		} finally {
+			db.close();
+		}
+	});
+	it('should throw an exception for readonly databases', function () {
+		const db = new Database(util.current(), { readonly: true });
+		try {
+			expect(() => db.checkpointer()).to.throw(TypeError);
+			expect(db.checkpointStats()).to.be.null;
+			expect(db.pragma('wal_autocheckpoint', { simple: true })).to.equal(1000);
+		} finally {
+			db.close();
+		}
+	});
+	it('should run checkpoints in the background instead of during writes', async function () {
+		this.slow(1000);
+		expect(this.db.checkpointer({ intervalMs: 60000, walSizeLimit: 0 })).to.equal(this.db);
+		fill(this.db, 2000);
+		const stats = this.db.checkpointStats();
+		expect(stats.walFrames).to.be.above(2000);
+		expect(stats.checkpoints).to.equal(0);
+		this.db.checkpointer({ intervalMs: 10, walSizeLimit: 0 });
+		await wait(200);
+		expect(this.db.checkpointStats().checkpoints).to.equal(1);
+		expect(this.db.checkpointStats().incompleteCheckpoints).to.equal(0);
+	});
+	it('should checkpoint and restart the WAL once it reaches the size limit', async function () {
+		this.slow(1000);
+		this.db.checkpointer({ mode: 'RESTART', intervalMs: 60000, walSizeLimit: 100 });
+		for (let i = 0; i < 20; ++i) {
+			fill(this.db, 50);
+			await wait(5);
+		}
+		const stats = this.db.checkpointStats();
+		expect(stats.checkpoints).to.be.above(0);
+		expect(stats.walFrames).to.be.below(1000);
+		expect(stats.maxDuration).to.be.at.least(stats.lastDuration);
+	});
+	it('should restore automatic checkpoints when stopped', function () {
+		this.db.checkpointer({ intervalMs: 60000, walSizeLimit: 0 });
+		fill(this.db, 1500);
+		expect(this.db.checkpointer(false)).to.equal(this.db);
+		expect(this.db.checkpointStats()).to.be.null;
+		expect(this.db.pragma('wal_autocheckpoint', { simple: true })).to.equal(1000);
+		const size = fs.statSync(`${util.current()}-wal`).size;
+		fill(this.db, 1500);
+		expect(fs.statSync(`${util.current()}-wal`).size).to.equal(size);
+	});
+});
@@ -0,0 +1,148 @@
+'use strict';
+const Database = require('../.');
+
+describe('Database#onChange()', function () {
+	beforeEach(function () {
+		this.db = new Database(util.next());
+		this.db.prepare('CREATE TABLE entries (a TEXT, b INTEGER)').run();
+	});
+	afterEach(function () {
+		this.db.close();
+	});
+
+	const wait = ms => new Promise(resolve => setTimeout(resolve, ms));
+	const nextBatch = (db) => new Promise((resolve) => {
+		const unsubscribe = db.onChange((changes) => {
+			unsubscribe();
+			resolve(changes);
+		});
+	});
+
+	it('should throw an exception if invalid arguments are provided', function () {
+		expect(() => this.db.onChange()).to.throw(TypeError);
+		expect(() => this.db.onChange({})).to.throw(TypeError);
+		expect(() => this.db.onChange(() => {}, 123)).to.throw(TypeError);
+		expect(() => this.db.onChange(() => {}, { batch: 1 })).to.throw(TypeError);
+		this.db.close();
+		expect(() => this.db.onChange(() => {})).to.throw(TypeError);
+	});
+	it('should deliver the changes of each commit asynchronously', async function () {
+		const calls = [];
+		this.db.onChange(changes => calls.push(changes));
+		this.db.prepare("INSERT INTO entries VALUES ('foo', 1), ('bar', 2)").run();
+		this.db.prepare("UPDATE entries SET b = 3 WHERE a = 'foo'").run();
+		this.db.prepare("DELETE FROM entries WHERE a = 'bar'").run();
+		expect(calls).to.deep.equal([]);
+		await wait(20);
+		expect(calls.flat()).to.deep.equal([
+			{ op: 'insert', database: 'main', table: 'entries', rowid: 1 },
+			{ op: 'insert', database: 'main', table: 'entries', rowid: 2 },
+			{ op: 'update', database: 'main', table: 'entries', rowid: 1 },
+			{ op: 'delete', database: 'main', table: 'entries', rowid: 2 },
+		]);
+	});
+	it('should deliver a transaction\'s changes together', async function () {
+		const insert = this.db.prepare('INSERT INTO entries VALUES (?, ?)');
+		const promise = nextBatch(this.db);
+		this.db.transaction(() => {
+			for (let i = 0; i < 100; ++i) insert.run('foo', i);
+		})();
+		const changes = await promise;
+		expect(changes).to.have.lengthOf(100);
+		expect(changes.map(x => x.rowid)).to.deep.equal(Array.from({ length: 100 }, (_, i) => i + 1));
+	});
+	it('should not deliver changes that were rolled back', async function () {
+		const insert = this.db.prepare('INSERT INTO entries VALUES (?, ?)');
+		const promise = nextBatch(this.db);
+		expect(() => this.db.transaction(() => {
+			insert.run('foo', 1);
+			throw new Error('rolled back');
+		})()).to.throw('rolled back');
+		insert.run('bar', 2);
+		const changes = await promise;
+		expect(changes).to.deep.equal([{ op: 'insert', database: 'main', table: 'entries', rowid: 1 }]);
+		expect(this.db.prepare('SELECT a FROM entries').pluck().all()).to.deep.equal(['bar']);
+	});
+	it('should report rows deleted by truncating a table or by REPLACE', async function () {
+		this.db.prepare('CREATE TABLE things (id INTEGER PRIMARY KEY, name TEXT UNIQUE)').run();
+		this.db.prepare("INSERT INTO things VALUES (1, 'foo'), (2, 'bar')").run();
+		const promise = nextBatch(this.db);
+		this.db.transaction(() => {
+			this.db.prepare("INSERT OR REPLACE INTO things VALUES (3, 'foo')").run();
+			this.db.prepare('DELETE FROM things').run();
+		})();
+		expect(await promise).to.deep.equal([
+			{ op: 'delete', database: 'main', table: 'things', rowid: 1 },
+			{ op: 'insert', database: 'main', table: 'things', rowid: 3 },
+			{ op: 'delete', database: 'main', table: 'things', rowid: 2 },
+			{ op: 'delete', database: 'main', table: 'things', rowid: 3 },
+		]);
+	});
+	it('should not report changes to WITHOUT ROWID tables or internal tables', async function () {
+		this.db.exec('CREATE TABLE keyed (k TEXT PRIMARY KEY) WITHOUT ROWID; CREATE TABLE counted (id INTEGER PRIMARY KEY AUTOINCREMENT)');
+		const promise = nextBatch(this.db);
+		this.db.transaction(() => {
+			this.db.prepare("INSERT INTO keyed VALUES ('foo')").run();
+			this.db.prepare('INSERT INTO counted DEFAULT VALUES').run();
+		})();
+		expect(await promise).to.deep.equal([{ op: 'insert', database: 'main', table: 'counted', rowid: 1 }]);
+	});
+	it('should not deliver changes made by statements that failed', async function () {
+		this.db.prepare('CREATE TABLE things (id INTEGER PRIMARY KEY, name TEXT UNIQUE)').run();
+		const promise = nextBatch(this.db);
+		this.db.transaction(() => {
+			this.db.prepare("INSERT INTO things VALUES (1, 'foo')").run();
+			expect(() => this.db.prepare("INSERT INTO things VALUES (2, 'bar'), (3, 'foo')").run()).to.throw(Database.SqliteError);
+			expect(() => this.db.exec("INSERT INTO things VALUES (4, 'baz'), (5, 'foo')")).to.throw(Database.SqliteError);
+			expect(() => this.db.prepare("INSERT OR FAIL INTO things VALUES (6, 'qux'), (7, 'foo')").run()).to.throw(Database.SqliteError);
+			expect(() => this.db.transaction(() => {
+				this.db.prepare("INSERT INTO things VALUES (8, 'quux')").run();
+				throw new Error('rolled back');
+			})()).to.throw('rolled back');
+		})();
+		expect((await promise).map(x => x.rowid)).to.deep.equal([1, 6]);
+		expect(this.db.prepare('SELECT id FROM things ORDER BY id').pluck().all()).to.deep.equal([1, 6]);
+	});
+	it('should invoke the callback once per change when "batch" is false', async function () {
+		const calls = [];
+		this.db.onChange(change => calls.push(change), { batch: false });
+		this.db.prepare("INSERT INTO entries VALUES ('foo', 1), ('bar', 2)").run();
+		await wait(20);
+		expect(calls).to.deep.equal([
+			{ op: 'insert', database: 'main', table: 'entries', rowid: 1 },
+			{ op: 'insert', database: 'main', table: 'entries', rowid: 2 },
+		]);
+	});
+	it('should report the names of attached databases and tables', async function () {
+		this.db.exec(`ATTACH '${util.next()}' AS other; CREATE TABLE other.things (x)`);
+		const promise = nextBatch(this.db);
+		this.db.transaction(() => {
+			this.db.prepare('INSERT INTO other.things VALUES (1)').run();
+			this.db.prepare("INSERT INTO entries VALUES ('foo', 1)").run();
+		})();
+		expect(await promise).to.deep.equal([
+			{ op: 'insert', database: 'other', table: 'things', rowid: 1 },
+			{ op: 'insert', database: 'main', table: 'entries', rowid: 1 },
+		]);
+	});
+	it('should stop delivering changes once unsubscribed', async function () {
+		const first = [];
+		const second = [];
+		const unsubscribe = this.db.onChange(changes => first.push(...changes));
+		this.db.onChange(changes => second.push(...changes));
+		this.db.prepare("INSERT INTO entries VALUES ('foo', 1)").run();
+		await wait(20);
+		unsubscribe();
+		unsubscribe();
+		this.db.prepare("INSERT INTO entries VALUES ('bar', 2)").run();
+		await wait(20);
+		expect(first.map(x => x.rowid)).to.deep.equal([1]);
+		expect(second.map(x => x.rowid)).to.deep.equal([1, 2]);
+	});
+	it('should deliver committed changes after the database is closed', async function () {
+		const promise = nextBatch(this.db);
+		this.db.prepare("INSERT INTO entries VALUES ('foo', 1)").run();
+		this.db.close();
+		expect(await promise).to.have.lengthOf(1);
+	});
+});
@@ -0,0 +1,160 @@
+'use strict';
+const Database = require('../.');
+
+describe('Database#createSession()', function () {
+	beforeEach(function () {
+		const schema = 'CREATE TABLE entries (id INTEGER PRIMARY KEY, a TEXT); CREATE TABLE others (id INTEGER PRIMARY KEY, b TEXT)';
+		this.db = new Database(util.next());
+		this.replica = new Database(util.next());
+		this.db.exec(schema);
+		this.replica.exec(schema);
+		this.rows = db => db.prepare('SELECT * FROM entries ORDER BY id').all();
+	});
+	afterEach(function () {
+		this.db.close();
+		this.replica.close();
+	});
+
+	it('should throw an exception if invalid arguments are provided', function () {
+		expect(() => this.db.createSession(123)).to.throw(TypeError);
+		expect(() => this.db.createSession([123])).to.throw(TypeError);
+		expect(() => this.db.createSession([''])).to.throw(TypeError);
+		expect(() => this.db.createSession(null, 123)).to.throw(TypeError);
+		expect(() => this.db.createSession(null, { attached: '' })).to.throw(TypeError);
+	});
+	it('should record changes that can be applied to another database', function () {
+		const session = this.db.createSession();
+		this.db.exec("INSERT INTO entries VALUES (1, 'foo'), (2, 'bar'); UPDATE entries SET a = 'baz' WHERE id = 2");
+		const changeset = session.changeset();
+		expect(changeset).to.be.an.instanceof(Buffer);
+		expect(this.replica.applyChangeset(changeset)).to.equal(this.replica);
+		expect(this.rows(this.replica)).to.deep.equal([{ id: 1, a: 'foo' }, { id: 2, a: 'baz' }]);
+		expect(session.database).to.equal(this.db);
+	});
+	it('should only record changes to the given tables', function () {
+		const session = this.db.createSession('others');
+		this.db.exec("INSERT INTO entries VALUES (1, 'foo'); INSERT INTO others VALUES (1, 'bar')");
+		this.replica.applyChangeset(session.changeset());
+		expect(this.rows(this.replica)).to.deep.equal([]);
+		expect(this.replica.prepare('SELECT * FROM others').all()).to.deep.equal([{ id: 1, b: 'bar' }]);
+	});
+	it('should return an empty buffer if nothing changed', function () {
+		const session = this.db.createSession();
+		expect(session.changeset()).to.deep.equal(Buffer.alloc(0));
+		expect(session.patchset()).to.deep.equal(Buffer.alloc(0));
+	});
+	it('should generate patchsets', function () {
+		this.db.exec("INSERT INTO entries VALUES (1, 'foo')");
+		this.replica.exec("INSERT INTO entries VALUES (1, 'foo')");
+		const session = this.db.createSession();
+		this.db.exec("UPDATE entries SET a = 'bar'; INSERT INTO entries VALUES (2, 'baz')");
+		const patchset = session.patchset();
+		expect(patchset.length).to.be.below(session.changeset().length);
+		this.replica.applyChangeset(patchset);
+		expect(this.rows(this.replica)).to.deep.equal(this.rows(this.db));
+	});
+	it('should be unusable once closed', function () {
+		const session = this.db.createSession();
+		expect(session.close()).to.equal(session);
+		expect(() => session.changeset()).to.throw(TypeError);
+		session.close();
+		const other = this.db.createSession();
+		this.db.close();
+		expect(() => other.changeset()).to.throw(TypeError);
+	});
+});
+
+describe('Database#applyChangeset()', function () {
+	beforeEach(function () {
+		const schema = 'CREATE TABLE entries (id INTEGER PRIMARY KEY, a TEXT)';
+		this.db = new Database(util.next());
+		this.replica = new Database(util.next());
+		this.db.exec(schema);
+		this.replica.exec(schema);
+		this.rows = db => db.prepare('SELECT * FROM entries ORDER BY id').all();
+		const session = this.db.createSession();
+		this.db.exec("INSERT INTO entries VALUES (1, 'foo'), (2, 'bar')");
+		this.changeset = session.changeset();
+		this.replica.exec("INSERT INTO entries VALUES (2, 'old')");
+	});
+	afterEach(function () {
+		this.db.close();
+		this.replica.close();
+	});
+
+	it('should throw an exception if invalid arguments are provided', function () {
+		expect(() => this.replica.applyChangeset('foo')).to.throw(TypeError);
+		expect(() => this.replica.applyChangeset(this.changeset, 'omit')).to.throw(TypeError);
+		expect(() => this.replica.applyChangeset(Buffer.from('garbage'))).to.throw(Database.SqliteError);
+	});
+	it('should abort and roll back on conflicts by default', function () {
+		expect(() => this.replica.applyChangeset(this.changeset)).to.throw(Database.SqliteError).with.property('code', 'SQLITE_ABORT');
+		expect(this.rows(this.replica)).to.deep.equal([{ id: 2, a: 'old' }]);
+	});
+	it('should resolve conflicts with the given function', function () {
+		const conflicts = [];
+		this.replica.applyChangeset(this.changeset, (conflict) => {
+			conflicts.push(conflict);
+			return 'omit';
+		});
+		expect(conflicts).to.deep.equal([{ type: 'conflict', table: 'entries', op: 'insert' }]);
+		expect(this.rows(this.replica)).to.deep.equal([{ id: 1, a: 'foo' }, { id: 2, a: 'old' }]);
+		this.replica.exec('DELETE FROM entries WHERE id = 1');
+		this.replica.applyChangeset(this.changeset, () => 'replace');
+		expect(this.rows(this.replica)).to.deep.equal([{ id: 1, a: 'foo' }, { id: 2, a: 'bar' }]);
+	});
+	it('should propagate exceptions thrown by the conflict handler', function () {
+		const err = new Error('foo');
+		expect(() => this.replica.applyChangeset(this.changeset, () => { throw err; })).to.throw(err);
+		expect(() => this.replica.applyChangeset(this.changeset, () => 'skip')).to.throw(TypeError);
+		expect(this.rows(this.replica)).to.deep.equal([{ id: 2, a: 'old' }]);
+	});
+	it('should not allow the database to be used by the conflict handler', function () {
+		expect(() => this.replica.applyChangeset(this.changeset, () => {
+			this.replica.exec('DELETE FROM entries');
+		})).to.throw(TypeError);
+		expect(this.rows(this.replica)).to.deep.equal([{ id: 2, a: 'old' }]);
+	});
+});
+
+describe('Database#invertChangeset()', function () {
+	it('should produce a changeset that undoes the original', function () {
+		const db = new Database(util.next());
+		try {
+			db.exec("CREATE TABLE entries (id INTEGER PRIMARY KEY, a TEXT); INSERT INTO entries VALUES (1, 'foo')");
+			const session = db.createSession();
+			db.exec("UPDATE entries SET a = 'bar'; INSERT INTO entries VALUES (2, 'baz')");
+			db.applyChangeset(db.invertChangeset(session.changeset()));
+			expect(db.prepare('SELECT * FROM entries').all()).to.deep.equal([{ id: 1, a: 'foo' }]);
+			expect(() => db.invertChangeset('foo')).to.throw(TypeError);
+		} finally {
+			db.close();
+		}
+	});
+});
+
+describe('Database#concatChangesets()', function () {
+	it('should combine changesets into one', function () {
+		const db = new Database(util.next());
+		const replica = new Database(util.next());
+		try {
+			const schema = 'CREATE TABLE entries (id INTEGER PRIMARY KEY, a TEXT)';
+			db.exec(schema);
+			replica.exec(schema);
+			const changesets = [];
+			for (const sql of ["INSERT INTO entries VALUES (1, 'foo')", "UPDATE entries SET a = 'bar'", "INSERT INTO entries VALUES (2, 'baz')"]) {
+				const session = db.createSession();
+				db.exec(sql);
+				changesets.push(session.changeset());
+				session.close();
+			}
+			replica.applyChangeset(db.concatChangesets(changesets));
+			expect(replica.prepare('SELECT * FROM entries').all()).to.deep.equal([{ id: 1, a: 'bar' }, { id: 2, a: 'baz' }]);
+			expect(db.concatChangesets([])).to.deep.equal(Buffer.alloc(0));
+			expect(() => db.concatChangesets(['foo'])).to.throw(TypeError);
+		} finally {
+			db.close();
+			replica.close();
+		}
+	});
+});
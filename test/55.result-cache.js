@@ -0,0 +1,155 @@
+'use strict';
+const Database = require('../.');
+
+describe('Statement#cache()', function () {
+	beforeEach(function () {
+		this.db = new Database(util.next());
+		this.db.prepare('CREATE TABLE entries (a TEXT, b INTEGER)').run();
+		this.db.prepare("INSERT INTO entries VALUES ('foo', 1), ('bar', 2), ('baz', 3)").run();
+	});
+	afterEach(function () {
+		this.db.close();
+	});
+
+	it('should throw an exception when used on a statement that writes or returns no data', function () {
+		expect(() => this.db.prepare("INSERT INTO entries VALUES ('qux', 4)").cache()).to.throw(TypeError);
+		expect(() => this.db.prepare("INSERT INTO entries VALUES ('qux', 4) RETURNING *").cache()).to.throw(TypeError);
+		expect(() => this.db.prepare('DELETE FROM entries').cache()).to.throw(TypeError);
+	});
+	it('should throw an exception if the argument is not a boolean', function () {
+		const stmt = this.db.prepare('SELECT * FROM entries');
+		expect(() => stmt.cache(1)).to.throw(TypeError);
+		expect(() => stmt.cache('true')).to.throw(TypeError);
+		expect(stmt.cache()).to.equal(stmt);
+		expect(stmt.cache(false)).to.equal(stmt);
+	});
+	it('should return the same frozen results until the database changes', function () {
+		const all = this.db.prepare('SELECT * FROM entries ORDER BY rowid').cache();
+		const get = this.db.prepare('SELECT * FROM entries WHERE a = ?').cache();
+		const rows = all.all();
+		expect(rows).to.deep.equal([{ a: 'foo', b: 1 }, { a: 'bar', b: 2 }, { a: 'baz', b: 3 }]);
+		expect(all.all()).to.equal(rows);
+		expect(Object.isFrozen(rows)).to.be.true;
+		expect(Object.isFrozen(rows[0])).to.be.true;
+		const row = get.get('bar');
+		expect(row).to.deep.equal({ a: 'bar', b: 2 });
+		expect(get.get('bar')).to.equal(row);
+		expect(Object.isFrozen(row)).to.be.true;
+
+		this.db.prepare("UPDATE entries SET b = 20 WHERE a = 'bar'").run();
+		expect(all.all()).to.not.equal(rows);
+		expect(all.all()[1]).to.deep.equal({ a: 'bar', b: 20 });
+		expect(get.get('bar')).to.deep.equal({ a: 'bar', b: 20 });
+	});
+	it('should cache results separately for each set of bind parameters', function () {
+		const stmt = this.db.prepare('SELECT b FROM entries WHERE a = ?').pluck().cache();
+		expect(stmt.get('foo')).to.equal(1);
+		expect(stmt.get('bar')).to.equal(2);
+		expect(stmt.get('qux')).to.be.undefined;
+		expect(stmt.get('foo')).to.equal(1);
+		expect(stmt.get('qux')).to.be.undefined;
+		expect(stmt.all('baz')).to.deep.equal([3]);
+		const named = this.db.prepare('SELECT a FROM entries WHERE b > @min').pluck().cache();
+		expect(named.all({ min: 1 })).to.deep.equal(['bar', 'baz']);
+		expect(named.all({ min: 2 })).to.deep.equal(['baz']);
+		expect(named.all({ min: 1 })).to.deep.equal(['bar', 'baz']);
+		expect(named.all({ min: 1n })).to.deep.equal(['bar', 'baz']);
+	});
+	it('should not return results cached in a different mode', function () {
+		const stmt = this.db.prepare("SELECT * FROM entries WHERE a = 'foo'").cache();
+		expect(stmt.get()).to.deep.equal({ a: 'foo', b: 1 });
+		expect(stmt.raw().get()).to.deep.equal(['foo', 1]);
+		expect(stmt.pluck().get()).to.equal('foo');
+		expect(stmt.raw(false).safeIntegers().get()).to.deep.equal({ a: 'foo', b: 1n });
+	});
+	it('should detect changes committed by other connections', function () {
+		const stmt = this.db.prepare('SELECT count(*) FROM entries').pluck().cache();
+		expect(stmt.get()).to.equal(3);
+		const db2 = new Database(util.current());
+		try {
+			db2.prepare("INSERT INTO entries VALUES ('qux', 4)").run();
+		} finally {
+			db2.close();
+		}
+		expect(stmt.get()).to.equal(4);
+	});
+	it('should detect commits made while every read hits the cache', function () {
+		this.slow(500);
+		const stmt = this.db.prepare('SELECT count(*) FROM entries').pluck().cache();
+		const db2 = new Database(util.current());
+		try {
+			const insert = db2.prepare("INSERT INTO entries VALUES ('qux', 4)");
+			for (let count = 3; count < 6; ++count) {
+				expect(stmt.get()).to.equal(count);
+				expect(stmt.get()).to.equal(count);
+				insert.run();
+			}
+			expect(stmt.get()).to.equal(6);
+		} finally {
+			db2.close();
+		}
+		const filename = util.current();
+		const count = util.runScript(`
+			'use strict';
+			const Database = require('../.');
+			const db = new Database(${JSON.stringify(filename)});
+			db.prepare("INSERT INTO entries VALUES ('quux', 5)").run();
+			process.stdout.write(JSON.stringify(db.prepare('SELECT count(*) FROM entries').pluck().get()));
+			db.close();
+		`);
+		expect(count).to.equal(7);
+		expect(stmt.get()).to.equal(7);
+	});
+	it('should work alongside a change feed', async function () {
+		const stmt = this.db.prepare('SELECT count(*) FROM entries').pluck().cache();
+		const received = [];
+		const unsubscribe = this.db.onChange(changes => received.push(...changes));
+		try {
+			expect(stmt.get()).to.equal(3);
+			const db2 = new Database(util.current());
+			try {
+				db2.prepare("INSERT INTO entries VALUES ('qux', 4)").run();
+			} finally {
+				db2.close();
+			}
+			expect(stmt.get()).to.equal(4);
+			this.db.prepare("INSERT INTO entries VALUES ('quux', 5)").run();
+			expect(stmt.get()).to.equal(5);
+			await new Promise(resolve => setTimeout(resolve, 20));
+			expect(received.map(change => change.rowid)).to.deep.equal([5]);
+		} finally {
+			unsubscribe();
+		}
+	});
+	it('should not cache results inside of a transaction', function () {
+		const stmt = this.db.prepare('SELECT count(*) FROM entries').pluck().cache();
+		const insert = this.db.prepare("INSERT INTO entries VALUES ('qux', 4)");
+		expect(stmt.get()).to.equal(3);
+		this.db.exec('BEGIN');
+		expect(stmt.get()).to.equal(3);
+		insert.run();
+		expect(stmt.get()).to.equal(4);
+		this.db.exec('ROLLBACK');
+		expect(stmt.get()).to.equal(3);
+		this.db.exec('BEGIN');
+		insert.run();
+		expect(stmt.get()).to.equal(4);
+		this.db.exec('SAVEPOINT a');
+		insert.run();
+		expect(stmt.get()).to.equal(5);
+		this.db.exec('ROLLBACK TO a');
+		expect(stmt.get()).to.equal(4);
+		this.db.exec('COMMIT');
+		expect(stmt.get()).to.equal(4);
+	});
+	it('should stop caching when turned off', function () {
+		const stmt = this.db.prepare('SELECT * FROM entries').cache();
+		const rows = stmt.all();
+		expect(stmt.all()).to.equal(rows);
+		stmt.cache(false);
+		const uncached = stmt.all();
+		expect(uncached).to.not.equal(rows);
+		expect(Object.isFrozen(uncached)).to.be.false;
+		expect(stmt.all()).to.not.equal(uncached);
+	});
+});
@@ -0,0 +1,59 @@
+'use strict';
+const Database = require('../.');
+
+describe('Statement#compile()', function () {
+	beforeEach(function () {
+		this.db = new Database(util.next());
+		this.db.prepare('CREATE TABLE entries (a TEXT, b INTEGER)').run();
+		this.db.prepare("INSERT INTO entries VALUES ('foo', 1), ('bar', 2)").run();
+	});
+	afterEach(function () {
+		this.db.close();
+	});
+
+	it('should return a function that behaves like get() for statements that return data', function () {
+		const stmt = this.db.prepare('SELECT * FROM entries WHERE b = ?');
+		const get = stmt.compile();
+		expect(get).to.be.a('function');
+		expect(get.name).to.equal('get');
+		expect(get(1)).to.deep.equal({ a: 'foo', b: 1 });
+		expect(get(2)).to.deep.equal({ a: 'bar', b: 2 });
+		expect(get(3)).to.be.undefined;
+		expect(() => get()).to.throw(RangeError);
+	});
+	it('should return a function that behaves like run() for statements that do not return data', function () {
+		const stmt = this.db.prepare('INSERT INTO entries VALUES (?, ?)');
+		const run = stmt.compile();
+		expect(run.name).to.equal('run');
+		expect(run('baz', 3)).to.deep.equal({ changes: 1, lastInsertRowid: 3 });
+		expect(this.db.prepare('SELECT count(*) FROM entries').pluck().get()).to.equal(3);
+	});
+	it('should reflect later changes to the statement', function () {
+		const stmt = this.db.prepare('SELECT * FROM entries WHERE b = ?');
+		const get = stmt.compile();
+		stmt.pluck();
+		expect(get(1)).to.equal('foo');
+		stmt.raw();
+		expect(get(1)).to.deep.equal(['foo', 1]);
+		stmt.safeIntegers();
+		expect(get(2)).to.deep.equal(['bar', 2n]);
+	});
+	it('should use parameters that were bound to the statement', function () {
+		const get = this.db.prepare('SELECT a FROM entries WHERE b = ?').pluck().bind(2).compile();
+		expect(get()).to.equal('bar');
+		expect(() => get(2)).to.throw(TypeError);
+	});
+	it('should expose the statement, and ignore the value of "this"', function () {
+		const stmt = this.db.prepare('SELECT a FROM entries WHERE b = ?').pluck();
+		const get = stmt.compile();
+		expect(get.statement).to.equal(stmt);
+		expect(() => { get.statement = null; }).to.throw(TypeError);
+		expect(get.call({}, 1)).to.equal('foo');
+		expect(get.call(this.db.prepare('SELECT 0'), 2)).to.equal('bar');
+	});
+	it('should throw an exception after the database is closed', function () {
+		const get = this.db.prepare('SELECT * FROM entries').compile();
+		this.db.close();
+		expect(() => get()).to.throw(TypeError);
+	});
+});
@@ -0,0 +1,141 @@
+'use strict';
+const Database = require('../.');
+
+describe('Database#batchWrites()', function () {
+	beforeEach(function () {
+		this.db = new Database(util.next());
+		this.db.prepare('CREATE TABLE data (x INTEGER PRIMARY KEY)').run();
+		this.reader = new Database(util.current(), { readonly: true });
+		this.committed = () => this.reader.prepare('SELECT x FROM data ORDER BY x').pluck().all();
+	});
+	afterEach(function () {
+		this.reader.close();
+		this.db.close();
+	});
+
+	it('should throw an exception if the options are invalid', function () {
+		expect(() => this.db.batchWrites('foo')).to.throw(TypeError);
+		expect(() => this.db.batchWrites(true)).to.throw(TypeError);
+		expect(() => this.db.batchWrites({ maxWrites: 0 })).to.throw(TypeError);
+		expect(() => this.db.batchWrites({ maxWrites: 1.5 })).to.throw(TypeError);
+		expect(() => this.db.batchWrites({ maxWrites: 0x80000000 })).to.throw(RangeError);
+		expect(() => this.db.batchWrites({ maxDelay: 0 })).to.throw(TypeError);
+		expect(() => this.db.batchWrites({ maxDelay: '10' })).to.throw(TypeError);
+		expect(() => this.db.batchWrites({ onError: 'foo' })).to.throw(TypeError);
+	});
+	it('should commit writes in batches of the given size', function () {
+		expect(this.db.batchWrites({ maxWrites: 3, maxDelay: 60000 })).to.equal(this.db);
+		const stmt = this.db.prepare('INSERT INTO data VALUES (?)');
+		expect(stmt.run(1)).to.deep.equal({ changes: 1, lastInsertRowid: 1 });
+		stmt.run(2);
+		expect(this.committed()).to.deep.equal([]);
+		expect(this.db.inTransaction).to.be.false;
+		expect(this.db.prepare('SELECT x FROM data ORDER BY x').pluck().all()).to.deep.equal([1, 2]);
+		stmt.run(3);
+		expect(this.committed()).to.deep.equal([1, 2, 3]);
+		stmt.run(4);
+		expect(this.committed()).to.deep.equal([1, 2, 3]);
+		expect(this.db.flushWrites()).to.equal(this.db);
+		expect(this.committed()).to.deep.equal([1, 2, 3, 4]);
+	});
+	it('should commit pending writes periodically', async function () {
+		this.db.batchWrites({ maxDelay: 5 });
+		this.db.prepare('INSERT INTO data VALUES (?)').run(1);
+		expect(this.committed()).to.deep.equal([]);
+		await new Promise(resolve => setTimeout(resolve, 50));
+		expect(this.committed()).to.deep.equal([1]);
+	});
+	it('should only undo the writes that fail', function () {
+		this.db.batchWrites({ maxDelay: 60000 });
+		const stmt = this.db.prepare('INSERT INTO data VALUES (?)');
+		stmt.run(1);
+		expect(() => stmt.run(1)).to.throw(Database.SqliteError).with.property('code', 'SQLITE_CONSTRAINT_PRIMARYKEY');
+		stmt.run(2);
+		this.db.flushWrites();
+		expect(this.committed()).to.deep.equal([1, 2]);
+
+		stmt.run(3);
+		expect(() => this.db.prepare('INSERT OR ROLLBACK INTO data VALUES (1)').run()).to.throw(Database.SqliteError);
+		stmt.run(4);
+		this.db.flushWrites();
+		expect(this.committed()).to.deep.equal([1, 2, 4]);
+	});
+	it('should commit pending writes before other transactions', function () {
+		this.db.batchWrites({ maxDelay: 60000 });
+		const stmt = this.db.prepare('INSERT INTO data VALUES (?)');
+		stmt.run(1);
+		expect(() => this.db.transaction(() => { stmt.run(2); throw new Error('foo'); })()).to.throw('foo');
+		expect(this.committed()).to.deep.equal([1]);
+		stmt.run(3);
+		this.db.prepare('BEGIN').run();
+		expect(this.db.inTransaction).to.be.true;
+		stmt.run(4);
+		this.db.prepare('ROLLBACK').run();
+		expect(this.committed()).to.deep.equal([1, 3]);
+		stmt.run(5);
+		this.db.exec('INSERT INTO data VALUES (6)');
+		expect(this.committed()).to.deep.equal([1, 3, 5, 6]);
+		stmt.run(7);
+		this.db.pragma('journal_mode = WAL');
+		expect(this.committed()).to.deep.equal([1, 3, 5, 6, 7]);
+	});
+	it('should run statements that cannot be batched on their own', function () {
+		this.db.batchWrites({ maxDelay: 60000 });
+		const stmt = this.db.prepare('INSERT INTO data VALUES (?)');
+		this.db.prepare('VACUUM').run();
+		this.db.prepare('PRAGMA main.journal_mode = WAL').run();
+		expect(this.db.pragma('journal_mode', { simple: true })).to.equal('wal');
+		stmt.run(1);
+		this.db.prepare(' /* comment */ vacuum').run();
+		expect(this.committed()).to.deep.equal([1]);
+		stmt.run(2);
+		this.db.prepare("ATTACH ':memory:' AS other").run();
+		this.db.prepare('DETACH other').run();
+		this.db.prepare('PRAGMA foreign_keys = OFF').run();
+		expect(this.committed()).to.deep.equal([1, 2]);
+		expect(this.db.inTransaction).to.be.false;
+	});
+	it('should pass errors from periodic commits to onError, or emit them as warnings', async function () {
+		this.db.pragma('foreign_keys = ON');
+		this.db.prepare('CREATE TABLE child (x INTEGER REFERENCES data (x) DEFERRABLE INITIALLY DEFERRED)').run();
+		const errors = [];
+		this.db.batchWrites({ maxDelay: 5, onError: err => errors.push(err) });
+		this.db.prepare('INSERT INTO child VALUES (1)').run();
+		await new Promise(resolve => setTimeout(resolve, 50));
+		expect(errors).to.have.lengthOf(1);
+		expect(errors[0]).to.be.an.instanceof(Database.SqliteError);
+
+		const warning = new Promise(resolve => process.once('warning', resolve));
+		this.db.batchWrites({ maxDelay: 5 });
+		this.db.prepare('INSERT INTO child VALUES (1)').run();
+		expect(await warning).to.be.an.instanceof(Database.SqliteError);
+		expect(this.db.prepare('SELECT count(*) FROM child').pluck().get()).to.equal(0);
+	});
+	it('should commit pending writes when closed or disabled', function () {
+		this.db.batchWrites({ maxDelay: 60000 });
+		const stmt = this.db.prepare('INSERT INTO data VALUES (?)');
+		stmt.run(1);
+		this.db.batchWrites(false);
+		expect(this.committed()).to.deep.equal([1]);
+		stmt.run(2);
+		expect(this.committed()).to.deep.equal([1, 2]);
+		this.db.batchWrites({ maxDelay: 60000 });
+		stmt.run(3);
+		this.db.close();
+		expect(this.committed()).to.deep.equal([1, 2, 3]);
+		expect(() => this.db.flushWrites()).to.not.throw();
+	});
+	it('should report the batch statements to the verbose logger', function () {
+		const calls = [];
+		const db = new Database(util.current(), { verbose: sql => calls.push(sql) });
+		try {
+			db.batchWrites({ maxWrites: 2, maxDelay: 60000 });
+			const stmt = db.prepare('INSERT INTO data VALUES (?)');
+			stmt.run(1);
+			stmt.run(2);
+			expect(calls).to.deep.equal(['BEGIN', 'INSERT INTO data VALUES (1)', 'INSERT INTO data VALUES (2)', 'COMMIT']);
+		} finally {
+			db.close();
+		}
+	});
+});
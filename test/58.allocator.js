@@ -0,0 +1,44 @@
+'use strict';
+const Database = require('../.');
+
+describe('Database#allocatorStats()', function () {
+	afterEach(function () {
+		if (this.db) this.db.close();
+	});
+
+	it('should report the default allocator without counters', function () {
+		if (process.env.SQLITE_ALLOCATOR === 'pool') this.skip();
+		this.db = new Database(util.next());
+		expect(this.db.allocatorStats()).to.deep.equal({
+			allocator: 'default',
+			allocations: null,
+			frees: null,
+			poolHits: null,
+			bytesInUse: null,
+			bytesPooled: null,
+		});
+	});
+	it('should install the pool allocator when SQLITE_ALLOCATOR=pool is set', function () {
+		this.slow(500);
+		const filename = util.next();
+		const { before, after, closed } = util.runScript(`
+			'use strict';
+			const Database = require('../.');
+			const db = new Database(${JSON.stringify(filename)});
+			const before = db.allocatorStats();
+			db.exec("CREATE TABLE data (x); INSERT INTO data WITH RECURSIVE temp(x) AS (SELECT 1 UNION ALL SELECT x + 1 FROM temp LIMIT 1000) SELECT randomblob(x) FROM temp");
+			db.prepare('SELECT * FROM data').all();
+			const after = db.allocatorStats();
+			db.close();
+			process.stdout.write(JSON.stringify({ before, after, closed: db.allocatorStats() }));
+		`, { SQLITE_ALLOCATOR: 'pool' });
+		expect(before.allocator).to.equal('pool');
+		expect(before.allocations).to.be.above(0);
+		expect(before.bytesInUse).to.be.above(0);
+		expect(after.allocations).to.be.above(before.allocations + 1000);
+		expect(after.frees).to.be.above(before.frees + 1000);
+		expect(after.poolHits).to.be.above(before.poolHits + 1000);
+		expect(after.allocations - after.frees).to.be.at.least(0);
+		expect(closed.bytesInUse).to.be.below(after.bytesInUse);
+	});
+});
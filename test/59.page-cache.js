@@ -0,0 +1,50 @@
+'use strict';
+const Database = require('../.');
+
+describe('Database#pageCacheStats()', function () {
+	beforeEach(function () {
+		this.db = new Database(util.next());
+		this.db.exec("CREATE TABLE data (x); INSERT INTO data WITH RECURSIVE temp(x) AS (SELECT 1 UNION ALL SELECT x + 1 FROM temp LIMIT 500) SELECT randomblob(1000) FROM temp");
+	});
+	afterEach(function () {
+		this.db.close();
+	});
+
+	it('should throw an exception if the database is closed', function () {
+		this.db.close();
+		expect(() => this.db.pageCacheStats()).to.throw(TypeError);
+	});
+	it('should report the cache hits and misses of the connection', function () {
+		const before = this.db.pageCacheStats();
+		expect(before.bytes).to.be.above(0);
+		this.db.prepare('SELECT count(*) FROM data').pluck().get();
+		const after = this.db.pageCacheStats();
+		expect(after.hits).to.be.above(before.hits + 50);
+		expect(after.misses).to.equal(before.misses);
+		if (process.env.SQLITE_PAGE_CACHE_BUDGET) return;
+		expect(after.budget).to.be.null;
+		expect(after.totalBytes).to.be.null;
+		expect(after.evictions).to.be.null;
+	});
+	it('should share one budget between connections when SQLITE_PAGE_CACHE_BUDGET is set', function () {
+		this.slow(500);
+		const filename = util.current();
+		this.db.close();
+		const stats = util.runScript(`
+			'use strict';
+			const Database = require('../.');
+			const dbs = [1, 2, 3, 4].map(() => new Database(${JSON.stringify(filename)}));
+			for (const db of dbs) db.prepare('SELECT count(*) FROM data').pluck().get();
+			const stats = dbs.map(db => db.pageCacheStats());
+			for (const db of dbs) db.close();
+			process.stdout.write(JSON.stringify(stats));
+		`, { SQLITE_PAGE_CACHE_BUDGET: String(256 * 1024) });
+		for (const { budget, totalBytes, misses } of stats) {
+			expect(budget).to.equal(256 * 1024);
+			expect(totalBytes).to.be.at.most(256 * 1024);
+			expect(misses).to.be.above(50);
+		}
+		expect(stats[3].evictions).to.be.above(0);
+		this.db = new Database(filename);
+	});
+});
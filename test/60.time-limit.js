@@ -0,0 +1,97 @@
+'use strict';
+const { Worker } = require('worker_threads');
+const Database = require('../.');
+
+describe('time limits and interrupts', function () {
+	const FOREVER = 'WITH RECURSIVE temp(x) AS (SELECT 1 UNION ALL SELECT x + 1 FROM temp) SELECT count(*) FROM temp';
+
+	beforeEach(function () {
+		this.db = new Database(util.next());
+		this.db.prepare('CREATE TABLE entries (a INTEGER)').run();
+	});
+	afterEach(function () {
+		this.db.close();
+	});
+
+	const expectInterrupt = (fn) => {
+		expect(fn).to.throw(Database.SqliteError).with.property('code', 'SQLITE_INTERRUPT');
+	};
+
+	describe('Database#timeLimit()', function () {
+		it('should throw an exception if an invalid time limit is given', function () {
+			expect(() => this.db.timeLimit(-1)).to.throw(TypeError);
+			expect(() => this.db.timeLimit(1.5)).to.throw(TypeError);
+			expect(() => this.db.timeLimit('100')).to.throw(TypeError);
+			expect(() => this.db.timeLimit(2 ** 31)).to.throw(RangeError);
+			expect(this.db.timeLimit(100)).to.equal(this.db);
+		});
+		it('should stop statements that run for longer than the limit', function () {
+			this.slow(500);
+			this.db.timeLimit(20);
+			const stmt = this.db.prepare(FOREVER).pluck();
+			expectInterrupt(() => stmt.get());
+			expectInterrupt(() => stmt.all());
+			expectInterrupt(() => stmt.iterate().next());
+			expectInterrupt(() => this.db.exec(FOREVER));
+			expect(this.db.prepare('SELECT count(*) FROM entries').pluck().get()).to.equal(0);
+		});
+		it('should not affect statements that finish in time', function () {
+			this.db.timeLimit(10000);
+			this.db.prepare('INSERT INTO entries WITH RECURSIVE temp(x) AS (SELECT 1 UNION ALL SELECT x + 1 FROM temp LIMIT 1000) SELECT x FROM temp').run();
+			expect(this.db.prepare('SELECT sum(a) FROM entries').pluck().get()).to.equal(500500);
+		});
+		it('should be removed when given no time limit', function () {
+			this.db.timeLimit(1);
+			this.db.timeLimit();
+			const stmt = this.db.prepare('WITH RECURSIVE temp(x) AS (SELECT 1 UNION ALL SELECT x + 1 FROM temp LIMIT 300000) SELECT count(*) FROM temp').pluck();
+			expect(stmt.get()).to.equal(300000);
+		});
+	});
+	describe('Statement#timeLimit()', function () {
+		it('should throw an exception if an invalid time limit is given', function () {
+			const stmt = this.db.prepare(FOREVER);
+			expect(() => stmt.timeLimit(-1)).to.throw(RangeError);
+			expect(() => stmt.timeLimit(1.5)).to.throw(TypeError);
+			expect(() => stmt.timeLimit('100')).to.throw(TypeError);
+			expect(stmt.timeLimit(100)).to.equal(stmt);
+			expect(stmt.timeLimit(null)).to.equal(stmt);
+			expect(stmt.timeLimit()).to.equal(stmt);
+		});
+		it('should override the time limit of the database', function () {
+			this.slow(500);
+			this.db.timeLimit(1);
+			const counter = this.db.prepare('WITH RECURSIVE temp(x) AS (SELECT 1 UNION ALL SELECT x + 1 FROM temp LIMIT 300000) SELECT count(*) FROM temp').pluck();
+			expect(counter.timeLimit(0).get()).to.equal(300000);
+			this.db.timeLimit(0);
+			expectInterrupt(() => this.db.prepare(FOREVER).timeLimit(20).get());
+			this.db.timeLimit(20);
+			expectInterrupt(() => this.db.prepare(FOREVER).timeLimit(0).timeLimit(null).get());
+		});
+	});
+	describe('Database#interruptHandle()', function () {
+		it('should return the same Int32Array every time', function () {
+			const handle = this.db.interruptHandle();
+			expect(handle).to.be.an.instanceof(Int32Array);
+			expect(handle.buffer).to.be.an.instanceof(SharedArrayBuffer);
+			expect(this.db.interruptHandle()).to.equal(handle);
+		});
+		it('should ignore interrupts sent while no statement is running', function () {
+			const handle = this.db.interruptHandle();
+			Atomics.store(handle, 0, 1);
+			expect(this.db.prepare('SELECT count(*) FROM entries').pluck().get()).to.equal(0);
+		});
+		it('should allow another thread to interrupt the running statement', function () {
+			this.slow(1000);
+			this.db.timeLimit(10000);
+			const worker = new Worker(`
+				const { workerData } = require('worker_threads');
+				Atomics.wait(new Int32Array(new SharedArrayBuffer(4)), 0, 0, 50);
+				Atomics.store(workerData, 0, 1);
+			`, { eval: true, workerData: this.db.interruptHandle() });
+			const start = Date.now();
+			expectInterrupt(() => this.db.prepare(FOREVER).get());
+			expect(Date.now() - start).to.be.below(5000);
+			return new Promise(resolve => worker.on('exit', resolve));
+		});
+	});
+});